@@ -24,12 +24,13 @@
 
 #include "sbuffer.h"
 #include "source.h"
-#include "number.h"
+#include "constpool.h"
 
 
 typedef enum ExprKind {
   EXPR_NONE,
   EXPR_INT,
+  EXPR_FLOAT,
   EXPR_NAME,
   EXPR_PAREN,
   EXPR_UNOP,
@@ -42,7 +43,8 @@ const char* strExprKind(ExprKind kind);
 
 /**
  * ASTExpr<EXPR_NONE> { }
- * ASTExpr<EXPR_INT> { value }
+ * ASTExpr<EXPR_INT> { constant }
+ * ASTExpr<EXPR_FLOAT> { floatValue }
  * ASTExpr<EXPR_NAME { name }
  * ASTExpr<EXPR_PAREN> { expr }
  * ASTExpr<EXPR_UNOP> { op, rhs }
@@ -51,7 +53,8 @@ const char* strExprKind(ExprKind kind);
 typedef struct ASTExpr {
   ExprKind kind;
   union {
-    Number            value;
+    ConstIndex        constant;
+    double            floatValue;
     string            name;
     struct ASTNode*   expr;
     struct {
@@ -0,0 +1,137 @@
+#ifndef __CACHE_H__
+#define __CACHE_H__
+
+
+/**
+ * Source Cache
+ * ============
+ *
+ * A build usually compiles the same files over and over again while only few of them change. The
+ * `SourceCache` keeps loaded sources together with their derived artifacts (like the token array)
+ * in memory. An entry is identified by the file's path, its modification time and size. If these
+ * did not change since the last lookup, the file is neither read nor lexed again. If only the
+ * modification time changed, the file is read and its content hash is compared. An unchanged
+ * hash keeps the tokens, so the file does not need to be lexed again.
+ *
+ * Optionally the cache persists the token arrays to a cache directory, named by the content hash.
+ * A new process that reads an already known file can then load the tokens instead of lexing the
+ * source. Error tokens are persisted like all other tokens, their messages are rendered on
+ * demand. The persisted files use the native byte order and are only meant for the local machine.
+ * Such a process still reads every file once, as the tokens are views into the content. Only the
+ * lexing is saved.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "cache.h"
+ * #include <assert.h>
+ *
+ * int main() {
+ *   SourceCache cache = createSourceCache(".ioncache");  // or NULL for an in-memory cache
+ *
+ *   const CacheEntry* entry = cacheSource(&cache, "main.ion");  // reads and lexes the file
+ *   assert(entry->source.status == SOURCE_OK);
+ *   assert(sbufLength(entry->tokens) > 0);  // the last token is always TOKEN_EOF
+ *
+ *   entry = cacheSource(&cache, "main.ion");  // unchanged file, nothing is read or lexed
+ *   assert(cache.reads == 1);
+ *   assert(cache.lexes == 1);
+ *
+ *   deleteSourceCache(&cache);  // deletes all sources and tokens
+ * }
+ * ```
+ */
+
+
+#include "source.h"
+#include "token.h"
+#include "sbuffer.h"
+
+#include <stdint.h>
+
+
+/**
+ * `CacheEntry` stores a cached source and its derived artifacts.
+ *
+ * - **field:** `path`   - the path of the source file
+ * - **field:** `mtime`  - the modification time of the file in nanoseconds
+ * - **field:** `size`   - the size of the file
+ * - **field:** `hash`   - the hash of the file content
+ * - **field:** `source` - the loaded source
+ * - **field:** `tokens` - the tokens of the source including the final `TOKEN_EOF`
+ */
+typedef struct CacheEntry {
+  char*       path;
+  int64_t     mtime;
+  size_t      size;
+  uint64_t    hash;
+  Source      source;
+  SBUF(Token) tokens;
+} CacheEntry;
+
+
+/**
+ * `SourceCache` stores the cached entries. The entries are found by their path in a hash table,
+ * whose slots hold the index of an entry plus one. The counters can be used to check how much
+ * work was actually done.
+ *
+ * - **field:** `entries`   - the cached entries
+ * - **field:** `slots`     - the hash table of the entries, at most half full
+ * - **field:** `slotCount` - the number of slots, a power of two
+ * - **field:** `directory` - the directory to persist the tokens (or `NULL`)
+ * - **field:** `reads`     - the number of files that were read
+ * - **field:** `lexes`     - the number of sources that were lexed
+ */
+typedef struct SourceCache {
+  SBUF(CacheEntry*) entries;
+  uint32_t*         slots;
+  size_t            slotCount;
+  char*             directory;
+  int               reads;
+  int               lexes;
+} SourceCache;
+
+
+/**
+ * `createSourceCache()` creates an empty cache. If a directory is given, it is created if it does
+ * not exist already.
+ *
+ * - **param:** `directory` - the directory to persist the tokens to (or `NULL`)
+ * - **return:** the empty cache
+ */
+SourceCache createSourceCache(const char* directory);
+
+
+/**
+ * `cacheSource()` returns the cached entry for a file and reloads it if the file was modified. In
+ * case the file cannot be read, the entry's source has the status `SOURCE_ERROR` and contains no
+ * tokens. The entry stays valid until the cache is deleted, but its content is replaced when the
+ * file was modified.
+ *
+ * - **param:** `cache` - the cache
+ * - **param:** `path`  - the path of the source file
+ * - **return:** the up-to-date entry for the file
+ */
+const CacheEntry* cacheSource(SourceCache* cache, const char* path);
+
+
+/**
+ * `deleteSourceCache()` deletes all entries of the cache. Persisted files are kept.
+ *
+ * - **param:** `cache` - the cache to be deleted
+ */
+void deleteSourceCache(SourceCache* cache);
+
+
+/**
+ * `hashString()` returns a 64 bit hash of a string. The hash is fast but not cryptographic.
+ *
+ * - **param:** `s` - the string to hash
+ * - **return:** the hash of the string
+ */
+uint64_t hashString(string s);
+
+
+#endif  // __CACHE_H__
@@ -0,0 +1,88 @@
+#ifndef __CONSTPOOL_H__
+#define __CONSTPOOL_H__
+
+
+/**
+ * Constant Pool
+ * =============
+ *
+ * The constant pool interns the integer constants by their value, like `strintern()` does for the
+ * strings. Each distinct value is stored once and referenced by its 32 bit index, thus a source
+ * full of repeated masks and offsets holds each of them once, and passes like the folding or the
+ * emission of the constants can work on each distinct value once.
+ *
+ * A hash table of indices finds an interned value in constant time. Since numbers are normalized,
+ * equal values have equal representations and are compared limb by limb. The pool keeps its own
+ * copy of the limbs of a large number, thus interned numbers stay valid after `numFree()` until
+ * `constpoolFree()`. The pool is not thread-safe.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "constpool.h"
+ * #include <assert.h>
+ *
+ * int main() {
+ *   ConstIndex a = constIntern(numFromInt(0xFF));
+ *   ConstIndex b = constIntern(numFromString(stringFromArray("0xFF")));
+ *   assert(a == b);                            // the same value is interned once
+ *   assert(constIntern(numFromInt(-0xFF)) != a);
+ *   assert(constCount() == 2);
+ *
+ *   Number big = shiftLeft(numFromInt(1), 100);
+ *   ConstIndex c = constIntern(big);
+ *   numFree();                                 // the pool has its own limbs
+ *   assert(bitSize(constAt(c)) == 101);
+ *   constpoolFree();                           // releases all constants
+ * }
+ * ```
+ */
+
+
+#include "number.h"
+
+#include <stdint.h>
+
+
+/**
+ * `ConstIndex` references an interned constant.
+ */
+typedef uint32_t ConstIndex;
+
+
+/**
+ * `constIntern()` interns the number unless an equal one is already interned.
+ *
+ * - **param:** `num` - the number
+ * - **return:** the index of the interned number
+ */
+ConstIndex constIntern(Number num);
+
+
+/**
+ * `constAt()` returns an interned number.
+ *
+ * - **param:** `index` - the index returned by `constIntern()`
+ * - **return:** the interned number
+ */
+Number constAt(ConstIndex index);
+
+
+/**
+ * `constCount()` returns the number of distinct interned numbers. The indices are `0` up to this
+ * count in the order of interning.
+ *
+ * - **return:** the number of interned numbers
+ */
+uint32_t constCount();
+
+
+/**
+ * `constpoolFree()` releases all interned numbers. The indices must not be used afterwards.
+ */
+void constpoolFree();
+
+
+#endif  // __CONSTPOOL_H__
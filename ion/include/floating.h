@@ -0,0 +1,107 @@
+#ifndef __FLOATING_H__
+#define __FLOATING_H__
+
+
+/**
+ * Floating-Point Numbers
+ * ======================
+ *
+ * The lexer reads float literals like `1.5`, `6.022_140e23` or the hex float `0x1.8p-3`. Their
+ * values are converted to the nearest `double` or `float`, ties are rounded to even. The literal
+ * syntax has no sign, the unary minus is an operator.
+ *
+ * A decimal literal is reduced to its first 19 significant digits and a power of ten. Values that
+ * are exact in a double, like `12.5`, are computed by a single multiplication or division. All
+ * others are computed by the Eisel-Lemire algorithm, which multiplies the digits by a 128 bit
+ * approximation of the power of ten from a table. This is exact unless the literal had more than
+ * 19 digits and the cut-off digits matter for the rounding, which is rare. Only then the slow path
+ * converts the literal by `strtod()`. Hex floats are exact in binary, their digits are only
+ * rounded to the mantissa.
+ *
+ * `doubleToString()` prints the shortest decimal literal that converts back to the same double.
+ * The result is again a valid float literal.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "floating.h"
+ * #include <assert.h>
+ *
+ * int main() {
+ *   double d;
+ *   assert(doubleFromString(stringFromArray("0.1"), &d));
+ *   assert(d == 0.1);
+ *   assert(doubleFromString(stringFromArray("1_000.25e-2"), &d));
+ *   assert(d == 10.0025);
+ *   assert(doubleFromString(stringFromArray("0x1.8p1"), &d));
+ *   assert(d == 3.0);
+ *   assert(!doubleFromString(stringFromArray("1e400"), &d));  // out of range
+ *
+ *   float f;
+ *   assert(floatFromString(stringFromArray("0.1"), &f));
+ *   assert(f == 0.1f);
+ *
+ *   string s = doubleToString(0.3);
+ *   assert(cstrequal(s, "0.3"));
+ *   strFree(&s);
+ *   s = doubleToString(1e300);
+ *   assert(cstrequal(s, "1e300"));
+ *   strFree(&s);
+ * }
+ * ```
+ */
+
+
+#include "str.h"
+
+#include <stdbool.h>
+
+
+/**
+ * `doubleFromString()` converts a float literal to the nearest double. The characters must form a
+ * float literal as accepted by the lexer, which the lexer validates. The string needs no
+ * terminating `'\0'`. Too small values become zero or subnormal.
+ *
+ * - **param:** `s`     - the characters of the literal
+ * - **param:** `value` - the converted value
+ * - **return:** `false` if the value is too large for a double
+ */
+bool doubleFromString(string s, double* value);
+
+
+/**
+ * `floatFromString()` converts a float literal to the nearest float. The literal is rounded only
+ * once, thus the result may differ from rounding the double.
+ *
+ * - **param:** `s`     - the characters of the literal
+ * - **param:** `value` - the converted value
+ * - **return:** `false` if the value is too large for a float
+ */
+bool floatFromString(string s, float* value);
+
+
+/**
+ * `doubleToString()` returns the shortest decimal literal that converts back to the value. Values
+ * between `1e-5` and `1e17` are written with a decimal point like `0.001` or `150.0`, others with
+ * an exponent like `1.5e-7`. Negative values get a leading `-`, infinity and NaN are printed as
+ * `inf` and `nan`. The string is allocated and must be freed.
+ *
+ * - **param:** `value` - the value
+ * - **return:** the shortest literal
+ */
+string doubleToString(double value);
+
+
+/**
+ * `floatToString()` returns the shortest decimal literal that converts back to the float value by
+ * `floatFromString()`. The string is allocated and must be freed.
+ *
+ * - **param:** `value` - the value
+ * - **return:** the shortest literal
+ */
+string floatToString(float value);
+
+
+#endif  // __FLOATING_H__
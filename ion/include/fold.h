@@ -0,0 +1,59 @@
+#ifndef __FOLD_H__
+#define __FOLD_H__
+
+
+/**
+ * Constant Folding
+ * ================
+ *
+ * The constant folding evaluates the constant subexpressions of a syntax tree, such that later
+ * phases see `67` instead of `(+ (* 16 4) 3)`. Integer operands are folded by the unary operators
+ * `+ - ! ~` and the binary operators `+ - * / %` with the semantics of a fixed width `NumType`,
+ * thus the folded values are those the target would compute. The division truncates like in C.
+ *
+ * A folded expression is replaced in place, i.e. the operator's node becomes the `EXPR_INT` of
+ * the interned value and the operand nodes are deleted. A division by zero and an overflow in
+ * `OVERFLOW_TRAP` mode are not folded. Instead their node turns into an `AST_ERROR` with the
+ * message, whose faulty node is the unfolded expression. An overflow in the other modes is folded
+ * and leaves a warning in the messages of the folded node. Nodes have no locations, thus the
+ * messages have none either.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "fold.h"
+ * #include "parser.h"
+ * #include <assert.h>
+ *
+ * int main() {
+ *   Source src = sourceFromString("0x10 * 4 + 3");
+ *   ASTNode* node = parse(&src);
+ *   int diagnostics = foldConstants(node, NUM_I32, OVERFLOW_TRAP);
+ *   assert(diagnostics == 0);
+ *   assert(node->kind == AST_EXPR && node->expr.kind == EXPR_INT);
+ *   assert(compare(constAt(node->expr.constant), numFromInt(67)) == 0);
+ *   deleteNode(node);
+ *   deleteSource(&src);
+ * }
+ * ```
+ */
+
+
+#include "ast.h"
+#include "number.h"
+
+
+/**
+ * `foldConstants()` folds the constant subexpressions of the tree in place.
+ *
+ * - **param:** `node` - the root of the tree, which stays the root
+ * - **param:** `type` - the type of the integer expressions
+ * - **param:** `mode` - what to do if a result is out of range of the type
+ * - **return:** the number of errors and warnings added to the tree
+ */
+int foldConstants(ASTNode* node, NumType type, Overflow mode);
+
+
+#endif  // __FOLD_H__
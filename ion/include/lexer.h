@@ -10,7 +10,26 @@
  * the source is processed, the lexer will return only `TOKEN_EOF` tokens henceforth without
  * consuming any characters, as there are none left. The lexer has a simple interface. Simply pass
  * it a source code and use `nexToken()` to retrieve tokens. For more information on the various
- * tokens, refer to *token.h*.
+ * tokens, refer to *token.h*. The lexer only keeps track of the offset into the source, lines and
+ * columns are never counted while lexing. They are looked up in the source's line index once a
+ * token's location is requested.
+ *
+ * String and character literals cannot span lines. The lexer only validates their escape
+ * sequences, the characters of a string are decoded on demand by `stringValue()`. Most literals
+ * have no escape sequences, their decoded string is a view into the source. Only literals with
+ * escape sequences are decoded into an arena. A `TOKEN_STRING` token's value is the length of
+ * the decoded string, a `TOKEN_CHAR` token's value is the code point of its character.
+ *
+ * Comments and whitespace are trivia, they don't matter to the compilation. By default comments are
+ * returned as `TOKEN_COMMENT` tokens. A lexer created by `lexerFromSourceWith()` can drop them
+ * instead, such that the parser only sees significant tokens. Or it collects the comments and the
+ * whitespace spans as `Trivia` records aside the tokens, which tools like formatters can use.
+ *
+ * An editor highlights only the visible lines. `lexLine()` lexes a single line given the state at
+ * the line's start, which is whether the line starts inside a multi-line comment. It returns the
+ * state at the end of the line, which is the state of the next line. Thus the states can be
+ * cached per line, and scrolling only lexes the lines that become visible. `lineStates()` fills
+ * such a cache for all lines of a source at once.
  *
  *
  * Example
@@ -27,51 +46,196 @@
  *
  *   Token token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_NAME);
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 1);
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 1);
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_SYMBOL);
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 3);
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 3);
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_INT);
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 5);
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 5);
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_SYMBOL);
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 6);
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 6);
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_ERROR);
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 8);
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 8);
  *   printf("%.*s", token.chars.len, token.chars.chars);
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_EOF);
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 9);
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 9);
  *
  *   // finished, only TOKEN_EOF from now on
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_EOF);
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 9);
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 9);
+ *
+ *   // the errors were collected, they are only rendered on request
+ *   assert(sbufLength(lexer.errors) == 1);
+ *   assert(lexer.errors[0].kind == LEX_ERROR_ILLEGAL_CHAR);
+ *   Error error = errorFromLexError(&src, lexer.errors[0]);
+ *   printf("%.*s", error.message.len, error.message.chars);
+ *   deleteError(&error);
  *
  *   deleteLexer(&lexer);
  *   deleteSource(&src);
+ *
+ *   src = sourceFromString("x // c\n+ y");
+ *   lexer = lexerFromSourceWith(&src, TRIVIA_COLLECT);
+ *   assert(nextToken(&lexer).kind == TOKEN_NAME);
+ *   assert(nextToken(&lexer).kind == TOKEN_SYMBOL);  // the comment is skipped
+ *   assert(sbufLength(lexer.trivia) == 3);  // " ", "// c" and "\n"
+ *   assert(lexer.trivia[1].kind == TRIVIA_COMMENT);
+ *   assert(lexer.trivia[1].offset == 2);
+ *   assert(lexer.trivia[1].length == 4);
+ *   deleteLexer(&lexer);  // deletes the trivia as well
+ *   deleteSource(&src);
+ *
+ *   src = sourceFromString("\"a\\tb\" \"plain\" '\\n'");
+ *   lexer = lexerFromSource(&src);
+ *   Arena arena = {};
+ *   token = nextToken(&lexer);
+ *   assert(token.kind == TOKEN_STRING);
+ *   assert(token.value == 3);
+ *   assert(cstrequal(stringValue(token, &arena), "a\tb"));  // decoded into the arena
+ *   token = nextToken(&lexer);
+ *   string plain = stringValue(token, &arena);
+ *   assert(plain.chars == token.chars.chars + 1);  // no copy
+ *   token = nextToken(&lexer);
+ *   assert(token.kind == TOKEN_CHAR);
+ *   assert(token.value == '\n');
+ *   arenaFree(&arena);
+ *   deleteLexer(&lexer);
+ *   deleteSource(&src);
+ *
+ *   src = sourceFromString("x := 1;\n// c\ny");
+ *   SBUF(LineState) states = lineStates(&src);  // may be cached per line
+ *   SBUF(TokenSpan) spans = NULL;
+ *   LineState next = lexLine(&src, 2, states[1], &spans);  // lexes only the second line
+ *   assert(sbufLength(spans) == 1);
+ *   assert(spans[0].kind == TOKEN_COMMENT);
+ *   assert(next == states[2]);
+ *   sbufFree(spans);
+ *   sbufFree(states);
+ *   deleteSource(&src);
  * }
  * ```
  */
 
 
 #include "source.h"
+#include "stream.h"
 #include "token.h"
+#include "tokenarray.h"
 #include "sbuffer.h"
+#include "arena.h"
+
+
+/**
+ * `TextEdit` describes an edit of a source's content. Some characters at an offset were replaced
+ * by other characters.
+ *
+ * - **field:** `offset`   - the offset of the first edited character
+ * - **field:** `removed`  - the number of removed characters
+ * - **field:** `inserted` - the number of inserted characters
+ */
+typedef struct TextEdit {
+  size_t offset;
+  size_t removed;
+  size_t inserted;
+} TextEdit;
+
+
+/**
+ * `TokenRange` describes the tokens of a token array that were replaced by `relexSource()`.
+ *
+ * - **field:** `first`    - the index of the first replaced token
+ * - **field:** `removed`  - the number of old tokens that were removed
+ * - **field:** `inserted` - the number of new tokens that were inserted
+ */
+typedef struct TokenRange {
+  size_t first;
+  size_t removed;
+  size_t inserted;
+} TokenRange;
+
+
+/**
+ * `TriviaMode` tells the lexer what to do with comments and whitespace.
+ *
+ * - **enum:** `TRIVIA_TOKENS`  - return comments as `TOKEN_COMMENT` and skip whitespace
+ * - **enum:** `TRIVIA_DROP`    - skip comments and whitespace
+ * - **enum:** `TRIVIA_COLLECT` - skip comments and whitespace, but record them as trivia
+ */
+typedef enum TriviaMode {
+  TRIVIA_TOKENS,
+  TRIVIA_DROP,
+  TRIVIA_COLLECT,
+} TriviaMode;
+
+
+/**
+ * `TriviaKind` is the kind of a trivia record.
+ *
+ * - **enum:** `TRIVIA_WHITESPACE` - a run of whitespace characters
+ * - **enum:** `TRIVIA_COMMENT`    - a single-line or multi-line comment
+ */
+typedef enum TriviaKind {
+  TRIVIA_WHITESPACE,
+  TRIVIA_COMMENT,
+} TriviaKind;
+
+
+/**
+ * `Trivia` is a span of the source that contains no tokens. The offset is relative to the whole
+ * input, also if the source is streamed.
+ *
+ * - **field:** `kind`   - the kind of the trivia
+ * - **field:** `offset` - the offset of the first character
+ * - **field:** `length` - the number of characters
+ */
+typedef struct Trivia {
+  TriviaKind kind;
+  size_t     offset;
+  uint32_t   length;
+} Trivia;
+
+
+/**
+ * `LineState` is the state of the lexer at the start of a line.
+ *
+ * - **enum:** `LINE_CODE`    - the line starts between tokens
+ * - **enum:** `LINE_COMMENT` - the line starts inside a multi-line comment
+ */
+typedef enum LineState {
+  LINE_CODE,
+  LINE_COMMENT,
+} LineState;
+
+
+/**
+ * `TokenSpan` marks the characters of a token within a line for highlighting.
+ *
+ * - **field:** `kind`   - the `TokenKind` of the token
+ * - **field:** `offset` - the offset of the first character within the content
+ * - **field:** `length` - the number of characters within the line
+ */
+typedef struct TokenSpan {
+  TokenKind kind;
+  uint32_t  offset;
+  uint32_t  length;
+} TokenSpan;
 
 
 /**
@@ -79,18 +243,23 @@
  * meant to be used internally.
  *
  * - **field:** `source`      - the pointer to the source to read tokens from
+ * - **field:** `stream`      - the stream to refill the source from (or `NULL`)
  * - **field:** `index`       - the position of the current character
+ * - **field:** `mark`        - the position of the current token's first character
  * - **field:** `currentChar` - the current character
- * - **field:** `currentLoc`  - the location of the current token
- * - **field:** `nextLoc`     - the location of the next token used for counting lines and EOF
- * - **field:** `errorMsgs`   - a buffer to store error messages
+ * - **field:** `errors`      - the records of all errors found so far
+ * - **field:** `triviaMode`  - what to do with comments and whitespace
+ * - **field:** `trivia`      - the trivia found so far if they are collected
  */
 typedef struct Lexer {
-  const Source* source;
-  int           index;
-  char          currentChar;
-  Location      currentLoc;
-  Location      nextLoc;
+  const Source*  source;
+  SourceStream*  stream;
+  int            index;
+  int            mark;
+  char           currentChar;
+  SBUF(LexError) errors;
+  TriviaMode     triviaMode;
+  SBUF(Trivia)   trivia;
 } Lexer;
 
 
@@ -103,6 +272,47 @@ typedef struct Lexer {
 Lexer lexerFromSource(const Source* src);
 
 
+/**
+ * `lexerFromSourceWith()` creates a new lexer for a source code that handles the trivia according
+ * to the mode.
+ *
+ * - **param:** `src`  - the source to read tokens from
+ * - **param:** `mode` - what to do with comments and whitespace
+ * - **return:** the lexer for the source code
+ */
+Lexer lexerFromSourceWith(const Source* src, TriviaMode mode);
+
+
+/**
+ * `lexerFromOffset()` creates a new lexer that starts in the middle of a source code. The offset
+ * must not point into a token, otherwise the lexer returns the token's rest as a new token.
+ *
+ * - **param:** `src`    - the source to read tokens from
+ * - **param:** `offset` - the offset of the first character to read
+ * - **return:** the lexer for the source code
+ */
+Lexer lexerFromOffset(const Source* src, size_t offset);
+
+
+/**
+ * `lexerFromStream()` creates a new lexer that reads from the stream's window and refills it
+ * whenever the window is exhausted. Tokens may thus cross chunk boundaries. A token's characters
+ * are only valid until the next call to `nextToken()`, as the refill will drop them.
+ *
+ * - **param:** `stream` - the stream to read tokens from
+ * - **return:** the lexer for the stream
+ */
+Lexer lexerFromStream(SourceStream* stream);
+
+
+/**
+ * `deleteLexer()` deletes the error and trivia records. The source or stream is not deleted.
+ *
+ * - **param:** `lexer` - the lexer to be deleted
+ */
+void deleteLexer(Lexer* lexer);
+
+
 /**
  * `nextToken()` advances forward and returns the next token from the source code.
  *
@@ -112,4 +322,82 @@ Lexer lexerFromSource(const Source* src);
 Token nextToken(Lexer* lexer);
 
 
+/**
+ * `lexSource()` lexes the whole source at once and stores all tokens including the final
+ * `TOKEN_EOF` in a token array. For more information refer to *tokenarray.h*.
+ *
+ * - **param:** `src` - the source to lex
+ * - **return:** the tokens of the source
+ */
+TokenArray lexSource(const Source* src);
+
+
+/**
+ * `relexSource()` updates the tokens of a source after an edit. The source must contain the
+ * edited content, the tokens are those of the content before the edit. Lexing restarts behind the
+ * last token that cannot be affected by the edit and stops as soon as a new token starts where an
+ * old token behind the edit starts, since the lexer yields the same tokens from there on. Only the
+ * new tokens in between replace the old ones, the offsets of all following tokens are shifted.
+ * Thus the lexing work depends on the size of the edit. Storing the result still moves and shifts
+ * all tokens behind the edit, which is linear in the size of the array (see `replaceTokens()`).
+ *
+ * - **param:** `tokens` - the tokens of the content before the edit
+ * - **param:** `src`    - the source with the edited content
+ * - **param:** `edit`   - the edit
+ * - **return:** the range of replaced tokens
+ */
+TokenRange relexSource(TokenArray* tokens, const Source* src, TextEdit edit);
+
+
+/**
+ * `lexLine()` lexes a single line of a source and appends a span for each token to the buffer. A
+ * multi-line comment is split into one `TOKEN_COMMENT` span per line. A comment that is never
+ * closed is highlighted as a comment as well, the lexer would report it as `TOKEN_ERROR`. The
+ * lexer never reads past the end of the line.
+ *
+ * - **param:** `src`   - the source
+ * - **param:** `line`  - the number of the line
+ * - **param:** `state` - the state at the start of the line
+ * - **param:** `spans` - the buffer to append the spans to
+ * - **return:** the state at the end of the line
+ */
+LineState lexLine(const Source* src, size_t line, LineState state, SBUF(TokenSpan)* spans);
+
+
+/**
+ * `lineStates()` returns the state at the start of every line. The index of a line's state is
+ * the line's number minus the source's first line. The whole source is lexed once.
+ *
+ * - **param:** `src` - the source
+ * - **return:** the buffer of the states, which must be freed
+ */
+SBUF(LineState) lineStates(const Source* src);
+
+
+/**
+ * `stringValue()` returns the decoded characters of a `TOKEN_STRING` token without the quotes. If
+ * the literal has no escape sequences, the string is a view into the source and nothing is
+ * allocated. Otherwise the decoded characters are allocated in the arena and terminated by
+ * `'\0'`. In both cases the string must not be freed, it lives as long as the source or the arena.
+ *
+ * - **param:** `token` - the string token
+ * - **param:** `arena` - the arena to decode escape sequences into
+ * - **return:** the decoded string, which may contain `'\0'` bytes
+ */
+string stringValue(Token token, Arena* arena);
+
+
+/**
+ * `errorFromLexError()` renders the message of an error record. The source must contain the whole
+ * input, thus records of a streamed source cannot be rendered. Such errors should be rendered from
+ * their token by `errorFromToken()` instead. As the message is allocated, the error must be
+ * deleted.
+ *
+ * - **param:** `src`   - the source the error was found in
+ * - **param:** `error` - the error record
+ * - **return:** the error with the rendered message
+ */
+Error errorFromLexError(const Source* src, LexError error);
+
+
 #endif  // __LEXER_H__
@@ -0,0 +1,67 @@
+#ifndef __LOADER_H__
+#define __LOADER_H__
+
+
+/**
+ * Batch Loader
+ * ============
+ *
+ * Loading a large project file by file with `sourceFromFile()` makes the compiler wait for every
+ * single read. `loadSources()` reads many files concurrently on a pool of worker threads. Each
+ * `Source` is handed to a callback as soon as it was read, so the caller can already lex early
+ * files while later ones are still being read. The callback is always called on the calling
+ * thread, one source at a time, thus it does not need to be thread-safe. The order of the calls
+ * is the order in which the files finished loading, the index tells which path was loaded.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "loader.h"
+ * #include <stdio.h>
+ *
+ * static void compileSource(Source* source, size_t index, void* data) {
+ *   if (source->status == SOURCE_OK) {
+ *     // lex and parse the source
+ *   }
+ *   deleteSource(source);  // the callback owns the source
+ * }
+ *
+ * int main(int argc, const char** argv) {
+ *   loadSources(argv + 1, argc - 1, 0, compileSource, NULL);  // 0 uses one thread per core
+ * }
+ * ```
+ */
+
+
+#include "source.h"
+
+#include <stddef.h>
+
+
+/**
+ * `SourceCallback` receives a loaded source. The callee owns the source and must delete it.
+ *
+ * - **param:** `source` - the loaded source (status `SOURCE_ERROR` if the file couldn't be read)
+ * - **param:** `index`  - the index of the source's path
+ * - **param:** `data`   - the user data passed to `loadSources()`
+ */
+typedef void (*SourceCallback)(Source* source, size_t index, void* data);
+
+
+/**
+ * `loadSources()` reads all files concurrently and passes each source to the callback once it is
+ * ready. The function returns after the callback was called for every path.
+ *
+ * - **param:** `paths`    - the paths of the files to load
+ * - **param:** `count`    - the number of paths
+ * - **param:** `threads`  - the number of worker threads, `0` for one per core
+ * - **param:** `callback` - the function to call for each loaded source
+ * - **param:** `data`     - the user data passed on to the callback
+ */
+void loadSources(const char* const* paths, size_t count, int threads,
+                 SourceCallback callback, void* data);
+
+
+#endif  // __LOADER_H__
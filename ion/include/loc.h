@@ -20,7 +20,7 @@
  *
  * int main() {
  *   Token t;  // get a token from somewhere
- *   Location loc = t.start;
+ *   Location loc = tokenStart(t);
  *   printf("location: %d:%d\n", loc.line, loc.pos);
  * }
  * ```
@@ -3,49 +3,444 @@
 
 
 /**
+ * Numbers
+ * =======
  *
+ * A `Number` is an integer of arbitrary precision for the compile-time constants. Most constants
+ * are small, thus a value in the range `[-2^64, 2^64)` lives inline in the `Number` itself and
+ * needs no allocation. Adding two inline numbers costs one machine addition and an overflow check.
+ * Only larger values spill to an array of 64 bit limbs, which are allocated in an arena of this
+ * module. The limbs hold the value in two's complement, the lowest limb first. A result is always
+ * normalized, i.e. it is inline if the value fits, thus two equal values have the same
+ * representation.
+ *
+ * The limbs are never freed individually. `numFree()` releases the limbs of all numbers at once,
+ * like `strinternFree()` does for the interned strings. The arena is not thread-safe, thus all
+ * numbers beyond 64 bits must be computed on the same thread.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "number.h"
+ * #include <assert.h>
+ * #include <string.h>
+ *
+ * int main() {
+ *   Number a = numFromUInt64(UINT64_MAX);
+ *   assert(a.size == 0);                       // inline
+ *   Number b = add(a, numFromInt(1));          // 2^64
+ *   assert(b.size == 2);                       // spilled to limbs
+ *   assert(bitSize(b) == 65);
+ *   assert(compare(sub(b, numFromInt(1)), a) == 0);
+ *
+ *   Number c = mul(b, b);                      // 2^128
+ *   assert(compare(c, shiftLeft(numFromInt(1), 128)) == 0);
+ *   assert(compare(neg(c), numFromString(stringFromArray("0"))) < 0);
+ *
+ *   char chars[NUM_STRING_SIZE];
+ *   toDecString(neg(b), chars, sizeof(chars), true, NULL);  // inline, no scratch needed
+ *   assert(strcmp(chars, "-18_446_744_073_709_551_616") == 0);
+ *   toHexString(b, chars, sizeof(chars), false);
+ *   assert(strcmp(chars, "0x10000000000000000") == 0);
+ *
+ *   bool overflow;
+ *   Number d = addFixed(numFromInt(200), numFromInt(100), NUM_U8, OVERFLOW_WRAP, &overflow);
+ *   assert(compare(d, numFromInt(44)) == 0 && overflow);
+ *   numFree();                                 // releases the limbs of b and c
+ * }
+ * ```
  */
 
 
 #include "sbuffer.h"
 #include "str.h"
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 
+/**
+ * `Number` is an integer of arbitrary precision. An inline value is a 65 bit two's complement
+ * number, whose lower 64 bits are in `value` and whose sign bit is `negative`, i.e. the value is
+ * `value - 2^64` if negative. Thus `.value` is the plain value for any non-negative inline number.
+ *
+ * - **field:** `size`     - the number of limbs, `0` for an inline value
+ * - **field:** `negative` - whether the value is negative
+ * - **field:** `value`    - the lower 64 bits of an inline value
+ * - **field:** `limbs`    - the limbs of a larger value in two's complement, the lowest first
+ */
 typedef struct Number {
-  uint32_t value;
+  uint32_t      size;
+  bool          negative;
+  union {
+    uint64_t    value;
+    uint64_t*   limbs;
+  };
 } Number;
 
 
+/**
+ * `numFromInt()` creates a number from an `int`.
+ *
+ * - **param:** `value` - the value
+ * - **return:** the inline number
+ */
 Number numFromInt(int value);
 
 
+/**
+ * `numFromInt64()` creates a number from a signed 64 bit integer.
+ *
+ * - **param:** `value` - the value
+ * - **return:** the inline number
+ */
+Number numFromInt64(int64_t value);
+
+
+/**
+ * `numFromUInt64()` creates a number from an unsigned 64 bit integer.
+ *
+ * - **param:** `value` - the value
+ * - **return:** the inline number
+ */
+Number numFromUInt64(uint64_t value);
+
+
+/**
+ * `numFromString()` converts an integer literal of the lexer, i.e. decimal, `0x` hex or `0b` bin
+ * digits with `_` separators. The string needs no terminating `'\0'`. The conversion is exact for
+ * any number of digits and stops at the first character that is no digit.
+ *
+ * - **param:** `s` - the characters of the literal
+ * - **return:** the non-negative number
+ */
 Number numFromString(string s);
 
 
+/**
+ * `deleteNum()` resets a number to zero. The limbs of a large number stay allocated until
+ * `numFree()`.
+ *
+ * - **param:** `num` - the number to reset
+ */
 void deleteNum(Number* num);
 
 
+/**
+ * `numFree()` releases the limbs of all numbers. Numbers with limbs must not be used afterwards,
+ * inline numbers stay valid.
+ */
+void numFree();
+
+
+/**
+ * `bitSize()` returns the number of bits of the shortest two's complement representation of the
+ * number, excluding the sign bit. Thus a number fits into a signed integer of `n` bits if its
+ * bit size is less than `n`, and into an unsigned one if it is not negative and its bit size is
+ * at most `n`. E.g. `0` and `-1` have the size 0, `255` and `-256` have the size 8.
+ *
+ * - **param:** `num` - the number
+ * - **return:** the number of bits without the sign
+ */
 int bitSize(Number num);
 
 
+/**
+ * `compare()` compares two numbers.
+ *
+ * - **param:** `a` - the left number
+ * - **param:** `b` - the right number
+ * - **return:** a negative value if `a < b`, `0` if `a == b` and a positive value if `a > b`
+ */
+int compare(Number a, Number b);
+
+
+/**
+ * `add()` returns the exact sum `a + b`.
+ *
+ * - **param:** `a` - the left operand
+ * - **param:** `b` - the right operand
+ * - **return:** the sum
+ */
 Number add(Number a, Number b);
 
 
+/**
+ * `sub()` returns the exact difference `a - b`.
+ *
+ * - **param:** `a` - the left operand
+ * - **param:** `b` - the right operand
+ * - **return:** the difference
+ */
 Number sub(Number a, Number b);
 
 
+/**
+ * `neg()` returns the negated number `-a`.
+ *
+ * - **param:** `a` - the operand
+ * - **return:** the negated number
+ */
 Number neg(Number a);
 
 
-string toDecString(Number num);
+/**
+ * `mul()` returns the exact product `a * b`.
+ *
+ * - **param:** `a` - the left operand
+ * - **param:** `b` - the right operand
+ * - **return:** the product
+ */
+Number mul(Number a, Number b);
 
 
-string toHexString(Number num);
+/**
+ * `shiftLeft()` returns `a * 2^bits`.
+ *
+ * - **param:** `a`    - the operand
+ * - **param:** `bits` - the number of bits to shift
+ * - **return:** the shifted number
+ */
+Number shiftLeft(Number a, unsigned int bits);
 
 
-string toBinString(Number num);
+/**
+ * `shiftRight()` shifts arithmetically, i.e. it returns `a / 2^bits` rounded towards negative
+ * infinity. Thus negative numbers stay negative and end as `-1`.
+ *
+ * - **param:** `a`    - the operand
+ * - **param:** `bits` - the number of bits to shift
+ * - **return:** the shifted number
+ */
+Number shiftRight(Number a, unsigned int bits);
+
+
+/**
+ * `divide()` returns the quotient `a / b` truncated towards zero, like the division of C.
+ *
+ * - **param:** `a` - the dividend
+ * - **param:** `b` - the divisor, must not be `0`
+ * - **return:** the quotient
+ */
+Number divide(Number a, Number b);
+
+
+/**
+ * `modulo()` returns the remainder of `divide()`, which has the sign of the dividend like `%` of C,
+ * i.e. `a == b * divide(a, b) + modulo(a, b)`.
+ *
+ * - **param:** `a` - the dividend
+ * - **param:** `b` - the divisor, must not be `0`
+ * - **return:** the remainder
+ */
+Number modulo(Number a, Number b);
+
+
+/**
+ * `NumType` is an integer type of the target with a fixed width. Numbers are always exact, a type
+ * only restricts the results of the `...Fixed()` operations to the range of the type, i.e.
+ * `[-2^(bits-1), 2^(bits-1))` if signed and `[0, 2^bits)` if unsigned. Types of up to 64 bits
+ * compute by native instructions, wider ones by the exact operations.
+ *
+ * - **field:** `bits`     - the width, at least `1`
+ * - **field:** `isSigned` - whether the type is signed
+ */
+typedef struct NumType {
+  uint32_t  bits;
+  bool      isSigned;
+} NumType;
+
+#define NUM_I8  ((NumType){ .bits=8,  .isSigned=true  })
+#define NUM_I16 ((NumType){ .bits=16, .isSigned=true  })
+#define NUM_I32 ((NumType){ .bits=32, .isSigned=true  })
+#define NUM_I64 ((NumType){ .bits=64, .isSigned=true  })
+#define NUM_U8  ((NumType){ .bits=8,  .isSigned=false })
+#define NUM_U16 ((NumType){ .bits=16, .isSigned=false })
+#define NUM_U32 ((NumType){ .bits=32, .isSigned=false })
+#define NUM_U64 ((NumType){ .bits=64, .isSigned=false })
+
+
+/**
+ * `Overflow` tells what a fixed width operation does with a result out of range.
+ *
+ * - **enum:** `OVERFLOW_WRAP`     - keeps the lower bits, like the target's registers do
+ * - **enum:** `OVERFLOW_SATURATE` - clamps to the minimum or the maximum of the type
+ * - **enum:** `OVERFLOW_TRAP`     - keeps the exact result for the caller to report
+ */
+typedef enum Overflow {
+  OVERFLOW_WRAP,
+  OVERFLOW_SATURATE,
+  OVERFLOW_TRAP,
+} Overflow;
+
+
+/**
+ * `fitsType()` checks whether the number is in the range of the type.
+ *
+ * - **param:** `num`  - the number
+ * - **param:** `type` - the type
+ * - **return:** `true` if the type can represent the number
+ */
+bool fitsType(Number num, NumType type);
+
+
+/**
+ * `minOfType()` returns the smallest number of the type.
+ *
+ * - **param:** `type` - the type
+ * - **return:** `-2^(bits-1)` if signed, otherwise `0`
+ */
+Number minOfType(NumType type);
+
+
+/**
+ * `maxOfType()` returns the largest number of the type.
+ *
+ * - **param:** `type` - the type
+ * - **return:** `2^(bits-1) - 1` if signed, otherwise `2^bits - 1`
+ */
+Number maxOfType(NumType type);
+
+
+/**
+ * `toFixed()` converts a number to the type. The flag `overflow` is set if the number is out of
+ * range, regardless of the mode. With `OVERFLOW_WRAP` the result is the number modulo `2^bits`
+ * in the range of the type, e.g. `300` wraps to `44` as `NUM_U8` and `200` to `-56` as `NUM_I8`.
+ *
+ * - **param:** `num`      - the number
+ * - **param:** `type`     - the type
+ * - **param:** `mode`     - what to do if the number is out of range
+ * - **param:** `overflow` - is set to whether the number is out of range, may be `NULL`
+ * - **return:** the converted number, or the exact one with `OVERFLOW_TRAP`
+ */
+Number toFixed(Number num, NumType type, Overflow mode, bool* overflow);
+
+
+/**
+ * `addFixed()` returns the sum `a + b` converted to the type like `toFixed()` does. The operands
+ * should be in the range of the type, which they are as results of other fixed width operations.
+ *
+ * - **param:** `a`        - the left operand
+ * - **param:** `b`        - the right operand
+ * - **param:** `type`     - the type
+ * - **param:** `mode`     - what to do if the sum is out of range
+ * - **param:** `overflow` - is set to whether the sum is out of range, may be `NULL`
+ * - **return:** the sum
+ */
+Number addFixed(Number a, Number b, NumType type, Overflow mode, bool* overflow);
+
+
+/**
+ * `subFixed()` returns the difference `a - b` converted to the type.
+ *
+ * - **param:** `a`        - the left operand
+ * - **param:** `b`        - the right operand
+ * - **param:** `type`     - the type
+ * - **param:** `mode`     - what to do if the difference is out of range
+ * - **param:** `overflow` - is set to whether the difference is out of range, may be `NULL`
+ * - **return:** the difference
+ */
+Number subFixed(Number a, Number b, NumType type, Overflow mode, bool* overflow);
+
+
+/**
+ * `negFixed()` returns the negated number `-a` converted to the type. E.g. the negated minimum of
+ * a signed type overflows, any number but `0` of an unsigned type too.
+ *
+ * - **param:** `a`        - the operand
+ * - **param:** `type`     - the type
+ * - **param:** `mode`     - what to do if the result is out of range
+ * - **param:** `overflow` - is set to whether the result is out of range, may be `NULL`
+ * - **return:** the negated number
+ */
+Number negFixed(Number a, NumType type, Overflow mode, bool* overflow);
+
+
+/**
+ * `mulFixed()` returns the product `a * b` converted to the type.
+ *
+ * - **param:** `a`        - the left operand
+ * - **param:** `b`        - the right operand
+ * - **param:** `type`     - the type
+ * - **param:** `mode`     - what to do if the product is out of range
+ * - **param:** `overflow` - is set to whether the product is out of range, may be `NULL`
+ * - **return:** the product
+ */
+Number mulFixed(Number a, Number b, NumType type, Overflow mode, bool* overflow);
+
+
+/**
+ * `shiftLeftFixed()` returns `a * 2^bits` converted to the type. Shifting by the width or more
+ * wraps to `0`.
+ *
+ * - **param:** `a`        - the operand
+ * - **param:** `bits`     - the number of bits to shift
+ * - **param:** `type`     - the type
+ * - **param:** `mode`     - what to do if the result is out of range
+ * - **param:** `overflow` - is set to whether the result is out of range, may be `NULL`
+ * - **return:** the shifted number
+ */
+Number shiftLeftFixed(Number a, unsigned int bits, NumType type, Overflow mode, bool* overflow);
+
+
+/**
+ * `NUM_STRING_SIZE` is the buffer size that fits any inline number in any format, including the
+ * sign, the prefix, the `_` separators and the terminating `'\0'`.
+ */
+#define NUM_STRING_SIZE 80
+
+
+/**
+ * `NUM_DEC_SCRATCH()` is the number of limbs `toDecString()` needs as scratch for the number.
+ */
+#define NUM_DEC_SCRATCH(num) (3 * (((num).size == 0) ? 2 : (size_t) (num).size))
+
+
+/**
+ * `toDecString()` writes the number as decimal literal into the buffer, e.g. `-1234` or grouped
+ * `-1_234`. Like `snprintf()` it returns the length of the literal without the `'\0'`, thus a
+ * call with the size `0` determines the needed size. The literal is only written if it fits
+ * together with the `'\0'`. The digits are found by dividing the number, which needs scratch
+ * limbs. No memory is allocated, the scratch of an inline number is on the stack.
+ *
+ * - **param:** `num`     - the number
+ * - **param:** `chars`   - the buffer
+ * - **param:** `size`    - the size of the buffer
+ * - **param:** `grouped` - whether to separate groups of three digits by `_`
+ * - **param:** `scratch` - `NUM_DEC_SCRATCH(num)` limbs of scratch, may be `NULL` if the number is
+ *                          inline
+ * - **return:** the length of the literal
+ */
+size_t toDecString(Number num, char* chars, size_t size, bool grouped, uint64_t* scratch);
+
+
+/**
+ * `toHexString()` writes the number as hex literal with upper case digits, e.g. `0xFF` or grouped
+ * `0x1_FFFF`. A negative number gets a leading `-`, the digits are those of its magnitude. Like
+ * `toBinString()` it needs no scratch and never allocates memory.
+ *
+ * - **param:** `num`     - the number
+ * - **param:** `chars`   - the buffer
+ * - **param:** `size`    - the size of the buffer
+ * - **param:** `grouped` - whether to separate groups of four digits by `_`
+ * - **return:** the length of the literal
+ */
+size_t toHexString(Number num, char* chars, size_t size, bool grouped);
+
+
+/**
+ * `toBinString()` writes the number as bin literal, e.g. `0b101` or grouped `0b1_00000000`.
+ *
+ * - **param:** `num`     - the number
+ * - **param:** `chars`   - the buffer
+ * - **param:** `size`    - the size of the buffer
+ * - **param:** `grouped` - whether to separate groups of eight digits, i.e. bytes, by `_`
+ * - **return:** the length of the literal
+ */
+size_t toBinString(Number num, char* chars, size_t size, bool grouped);
 
 
 #endif  // __NUMBER_H__
@@ -0,0 +1,58 @@
+#ifndef __PARLEXER_H__
+#define __PARLEXER_H__
+
+
+/**
+ * Parallel Lexer
+ * ==============
+ *
+ * Lexing a large generated source with `lexSource()` keeps a single core busy. `lexParallel()`
+ * splits the source into chunks and lexes them concurrently on a pool of worker threads. The
+ * tokens of the chunks are stitched together in order, the resulting `TokenArray` is identical to
+ * the one of `lexSource()`, including the error records.
+ *
+ * Chunks always start right after a newline. Only multi-line comments span lines, thus a chunk
+ * starts either between two tokens or inside a comment. As this is unknown until the previous
+ * chunk was lexed, every chunk is lexed twice speculatively: once from its start and once from
+ * the end of the first comment closing `"*" "/"`. Once all chunks are done, the calling thread
+ * walks the chunks in order and picks the variant that starts where the previous chunk's last
+ * token ended. If neither fits, the chunk is lexed again on the calling thread. Chunks have at
+ * least 64 KiB, smaller sources are lexed by `lexSource()` right away.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "parlexer.h"
+ * #include <assert.h>
+ *
+ * int main(int argc, const char** argv) {
+ *   Source src = sourceFromFile(argv[1]);
+ *   TokenArray tokens = lexParallel(&src, 0);  // 0 uses one thread per core
+ *   TokenArray expected = lexSource(&src);
+ *   assert(tokenCount(&tokens) == tokenCount(&expected));
+ *   deleteTokenArray(&expected);
+ *   deleteTokenArray(&tokens);
+ *   deleteSource(&src);
+ * }
+ * ```
+ */
+
+
+#include "source.h"
+#include "tokenarray.h"
+
+
+/**
+ * `lexParallel()` lexes the whole source on several threads and stores all tokens including the
+ * final `TOKEN_EOF` in a token array.
+ *
+ * - **param:** `src`     - the source to lex
+ * - **param:** `threads` - the number of worker threads, `0` for one per core
+ * - **return:** the tokens of the source
+ */
+TokenArray lexParallel(const Source* src, int threads);
+
+
+#endif  // __PARLEXER_H__
@@ -23,10 +23,32 @@
 
 
 #include "source.h"
+#include "tokenarray.h"
 #include "ast.h"
 
 
 ASTNode* parse(const Source* src);
 
 
+/**
+ * `parseTokens()` parses already lexed tokens. The result is the same as with `parse()` on the
+ * tokens' source, but the tokens can be reused for other passes.
+ *
+ * - **param:** `tokens` - the tokens to parse
+ * - **return:** the root of the syntax tree
+ */
+ASTNode* parseTokens(const TokenArray* tokens);
+
+
+/**
+ * `parsePipelined()` lexes the source on a separate thread, which passes the tokens through a
+ * `TokenQueue` to the parser. Thus lexing and parsing overlap on two cores. The result is the
+ * same as with `parse()`.
+ *
+ * - **param:** `src` - the source to parse
+ * - **return:** the root of the syntax tree
+ */
+ASTNode* parsePipelined(const Source* src);
+
+
 #endif  // __PARSER_H__
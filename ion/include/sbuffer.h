@@ -153,6 +153,35 @@ typedef struct BufHeader {
 #define sbufPush(b, ...) ( sbufFit(b, 1), (b)[__sbufHeader(b)->length++] = (__VA_ARGS__) )
 
 
+/**
+ * The `sbufPop()` macro expands to a statement that removes the last element of the buffer. The
+ * buffer must not be empty. The capacity is kept.
+ *
+ * - **param:** `b` - the pointer to a buffer
+ */
+#define sbufPop(b) ( __sbufHeader(b)->length-- )
+
+
+/**
+ * The `sbufClear()` macro expands to a statement that removes all elements of the buffer. The
+ * capacity is kept, thus the buffer can be refilled without reallocation.
+ *
+ * - **param:** `b` - the pointer to a buffer
+ */
+#define sbufClear(b) ( (b) ? (__sbufHeader(b)->length = 0) : 0 )
+
+
+/**
+ * The `sbufSetLength()` macro expands to a statement that sets the length of the buffer, e.g.
+ * after its elements were written in place behind the old length. The length must not exceed the
+ * capacity, the elements up to the new length must be initialized by the caller.
+ *
+ * - **param:** `b` - the pointer to a buffer
+ * - **param:** `n` - the new length of the buffer
+ */
+#define sbufSetLength(b, n) ( (b) ? (__sbufHeader(b)->length = (n)) : 0 )
+
+
 /**
  * The `sbufEnd()` macro expands to the address of the memory past the end of the buffer. This can
  * be used for a C++ iteration.
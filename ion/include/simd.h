@@ -0,0 +1,91 @@
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+
+/**
+ * SIMD Blocks
+ * ===========
+ *
+ * The scanning loops of the compiler (validating a source, skipping whitespace or comments) look
+ * at every byte of a source. `SimdBlock` lets them test a whole block of bytes at once. A block
+ * has 32 bytes with AVX2 and 16 bytes with SSE2. The comparisons return a block with all bits of a
+ * matching byte set, `simdMask()` then packs one bit per byte into an integer, the first byte of
+ * the block being the lowest bit. Thus `__builtin_ctz()` finds the first match and
+ * `__builtin_popcount()` counts the matches. `SIMD_ALL` is the mask of a block where all bytes
+ * match.
+ *
+ * If neither instruction set is enabled at compile time, `SIMD_WIDTH` is not defined and every
+ * user must fall back to a scalar loop. The build keeps the baseline of the target, i.e. SSE2 on
+ * x86-64, such that the binaries run on any such CPU. `make OPT_SIMD=-mavx2` builds the AVX2
+ * blocks for machines known to have them. The comparison `simdGreater()` is signed, thus bytes of
+ * non-ASCII characters compare less than all ASCII characters.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "simd.h"
+ *
+ * // returns the index of the first newline or the length
+ * size_t findNewline(const char* chars, size_t length) {
+ *   size_t i = 0;
+ * #ifdef SIMD_WIDTH
+ *   for (; i + SIMD_WIDTH <= length; i += SIMD_WIDTH) {
+ *     uint32_t newlines = simdMask(simdEqual(simdLoad(chars + i), simdSet('\n')));
+ *     if (newlines != 0) {
+ *       return i + __builtin_ctz(newlines);
+ *     }
+ *   }
+ * #endif
+ *   for (; i < length && chars[i] != '\n'; i++) {
+ *   }
+ *   return i;
+ * }
+ * ```
+ */
+
+
+#include <stdint.h>
+
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define SIMD_WIDTH 32
+#define SIMD_ALL   0xFFFFFFFFu
+
+typedef __m256i SimdBlock;
+
+#define simdLoad(p)       _mm256_loadu_si256((const __m256i*) (p))
+#define simdStore(p, a)   _mm256_storeu_si256((__m256i*) (p), a)
+#define simdSet(c)        _mm256_set1_epi8(c)
+#define simdEqual(a, b)   _mm256_cmpeq_epi8(a, b)
+#define simdGreater(a, b) _mm256_cmpgt_epi8(a, b)
+#define simdAnd(a, b)     _mm256_and_si256(a, b)
+#define simdOr(a, b)      _mm256_or_si256(a, b)
+#define simdMask(a)       ((uint32_t) _mm256_movemask_epi8(a))
+
+#elif defined(__SSE2__)
+
+#include <emmintrin.h>
+
+#define SIMD_WIDTH 16
+#define SIMD_ALL   0xFFFFu
+
+typedef __m128i SimdBlock;
+
+#define simdLoad(p)       _mm_loadu_si128((const __m128i*) (p))
+#define simdStore(p, a)   _mm_storeu_si128((__m128i*) (p), a)
+#define simdSet(c)        _mm_set1_epi8(c)
+#define simdEqual(a, b)   _mm_cmpeq_epi8(a, b)
+#define simdGreater(a, b) _mm_cmpgt_epi8(a, b)
+#define simdAnd(a, b)     _mm_and_si128(a, b)
+#define simdOr(a, b)      _mm_or_si128(a, b)
+#define simdMask(a)       ((uint32_t) _mm_movemask_epi8(a))
+
+#endif
+
+
+#endif  // __SIMD_H__
@@ -13,6 +13,13 @@
  * source string or file. A `Source` must be released to free the memory, in which case the name
  * and content will be replaced with an empty string.
  *
+ * When a `Source` is created, its content is checked to be valid UTF-8 without NUL characters
+ * and an index of the line starts is built in the same pass. Pure ASCII parts are processed 16
+ * bytes at a time, such that malformed input is rejected before the lexer ever sees it. The
+ * lexer takes a NUL character as the end of the content, thus a file with one is rejected as
+ * well. Optionally CRLF line endings are
+ * normalized to LF. Thus the lexer can assume well-formed input.
+ *
  *
  * Example
  * -------
@@ -46,12 +53,25 @@
  *   assert(cstrequal(src.content, "ERROR: could not open the file"));
  *   deleteSource(&src);
  *
+ *   src = sourceFromString("caf\xC3\xA9 \xFF");  // invalid UTF-8 is rejected
+ *   assert(src.status == SOURCE_ERROR);
+ *   assert(cstrequal(src.content, "ERROR: invalid UTF-8 at 1:6"));
+ *   deleteSource(&src);
+ *
+ *   src = sourceFromStringWith("a\r\nb", SOURCE_NORMALIZE_CRLF);  // normalize line endings
+ *   assert(cstrequal(src.content, "a\nb"));
+ *   deleteSource(&src);
+ *
  *   // access distinct lines
  *   src = sourceFromString("line one\nline two");
  *   assert(cstrequal(getLine(&src, 0), ""));
  *   assert(cstrequal(getLine(&src, 1), "line one\n"));
  *   assert(cstrequal(getLine(&src, 2), "line two"));
  *   assert(cstrequal(getLine(&src, 3), ""));
+ *
+ *   Location loc = getLocation(&src, 12);  // the 'e' in "line two"
+ *   assert(loc.line == 2);
+ *   assert(loc.pos == 4);
  *   deleteSource(&src);
  * }
  * ```
@@ -59,6 +79,7 @@
 
 
 #include "str.h"
+#include "loc.h"
 #include "sbuffer.h"
 
 
@@ -77,18 +98,35 @@ typedef enum SourceStatus {
 } SourceStatus;
 
 
+/**
+ * `SourceOptions` are flags to control how the content of a `Source` is prepared.
+ *
+ * - **enum:** `SOURCE_DEFAULT`        - validate the content and build the line index
+ * - **enum:** `SOURCE_NORMALIZE_CRLF` - additionally replace each CRLF by a single LF
+ */
+typedef enum SourceOptions {
+  SOURCE_DEFAULT        = 0,
+  SOURCE_NORMALIZE_CRLF = 1 << 0,
+} SourceOptions;
+
+
 /**
  * `Source` contains the source code from a file or C string. If errors did occur the content
  * contains an error message.
  *
- * - **field:** `fileName` - the file name of the source
- * - **field:** `content`  - the content of the source
- * - **field:** `status*   - the status indicating errors
+ * - **field:** `fileName`  - the file name of the source
+ * - **field:** `content`   - the content of the source
+ * - **field:** `status*    - the status indicating errors
+ * - **field:** `firstLine` - the line number of the first line in `content` (1 unless the source
+ *                            is a window into a stream, see *stream.h*)
+ * - **field:** `lines`     - the offsets of the line starts within `content` (or `NULL`)
  */
 typedef struct Source {
-  string       fileName;
-  string       content;
-  SourceStatus status;
+  string             fileName;
+  string             content;
+  SourceStatus       status;
+  unsigned int       firstLine;
+  SBUF(unsigned int) lines;
 } Source;
 
 
@@ -101,6 +139,17 @@ typedef struct Source {
 Source sourceFromString(const char* src);
 
 
+/**
+ * `sourceFromStringWith()` creates a `Source` as a copy of a C string and prepares the content
+ * according to the options.
+ *
+ * - **param:** `src`     - a C string containing some source code
+ * - **param:** `options` - the flags how to prepare the content
+ * - **return:** the copied source
+ */
+Source sourceFromStringWith(const char* src, SourceOptions options);
+
+
 /**
  * `sourceFromFile()` reads a file and returns its contents. In case of errors the `status` is set
  * to `SOURCE_ERROR` and `content` will contain an error message.
@@ -111,6 +160,31 @@ Source sourceFromString(const char* src);
 Source sourceFromFile(const char* name);
 
 
+/**
+ * `sourceFromFileWith()` reads a file and prepares its content according to the options. In case
+ * of errors the `status` is set to `SOURCE_ERROR` and `content` will contain an error message.
+ *
+ * - **param:** `name`    - the file name
+ * - **param:** `options` - the flags how to prepare the content
+ * - **return:** the content of the source file
+ */
+Source sourceFromFileWith(const char* name, SourceOptions options);
+
+
+/**
+ * `validContent()` checks characters like the content of a new `Source`, i.e. they must be valid
+ * UTF-8 without NUL characters. It is meant for content that is read piece by piece, like the
+ * chunks of a stream, whose last character may be cut by the end of the piece.
+ *
+ * - **param:** `chars`  - the characters to check
+ * - **param:** `length` - the number of characters
+ * - **param:** `cut`    - set to `true` if the last character is incomplete but valid so far (or
+ *                         `NULL` if the characters are complete)
+ * - **return:** the number of characters before the first invalid or incomplete one
+ */
+size_t validContent(const char* chars, size_t length, bool* cut);
+
+
 /**
  * `deleteSource()` deletes the contents of a `Source` and replaces the content with an empty
  * string. `status` is set to `SOURCE_NONE` to indicate that it should not be used anymore.
@@ -121,10 +195,11 @@ void deleteSource(Source* source);
 
 
 /**
- * `getLine()` returns a line of text given by some index. Line counting starts at 1. If the index
- * is zero or greater than the number of lines in the text, an empty string is returned. If the
- * ends with an end-of-line character(s), those characters are included. The returned string is not
- * null-terminated.
+ * `getLine()` returns a line of text given by some index. Line counting starts at 1 (or rather at
+ * `firstLine`). If the index is before the first or after the last line in the text, an empty
+ * string is returned. If the line ends with an end-of-line character(s), those characters are
+ * included. The returned string is not null-terminated. If the source has a line index, the line is
+ * found without scanning the content.
  *
  * - **param:** `source` - a pointer to the source text
  * - **param:** `line`   - the line's index
@@ -133,4 +208,16 @@ void deleteSource(Source* source);
 string getLine(const Source* source, size_t line);
 
 
+/**
+ * `getLocation()` returns the location of the character at some offset within the content. With
+ * a line index the line is found by a binary search, otherwise the content is scanned. An offset at
+ * the end of the content gives the location right after the last character.
+ *
+ * - **param:** `source` - a pointer to the source text
+ * - **param:** `offset` - the offset of the character within the content
+ * - **return:** the location of the character
+ */
+Location getLocation(const Source* source, size_t offset);
+
+
 #endif  // __SOURCE_H__
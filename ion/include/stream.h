@@ -0,0 +1,141 @@
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+
+/**
+ * Source Streams
+ * ==============
+ *
+ * A `SourceStream` reads a source code in fixed-size chunks instead of loading the whole file at
+ * once. This allows to compile input from `stdin`, pipes or FIFOs that cannot be seeked, as well
+ * as files larger than a `string` can hold. The stream exposes a `Source` called `window` that
+ * contains the part of the input that was read but not yet consumed. Whenever the window is
+ * exhausted, `streamRefill()` drops the consumed characters and appends the next chunk. Thus the
+ * memory usage is bounded by the chunk size and the longest line of the input, but not by the
+ * size of the input itself.
+ *
+ * The window always starts at the beginning of a line, so diagnostics can still print the line of
+ * an error. `window.firstLine` keeps track of the line number of the first line in the window.
+ * Strings pointing into the window (e.g. a token's characters) become invalid on the next refill.
+ *
+ * Every chunk is checked like the content of a `Source`, i.e. it must be valid UTF-8 without NUL
+ * characters. A character cut by the end of a chunk is held back until the next chunk completes
+ * it. If the input is rejected, the window ends before the faulty character and no more chunks
+ * are read, such that a lexer sees the end of the input there. The window's `status` is then set
+ * to `SOURCE_ERROR` and `message` tells the reason and location, thus a caller must check the
+ * status once the input is exhausted.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "stream.h"
+ * #include "lexer.h"
+ * #include <stdio.h>
+ *
+ * int main() {
+ *   SourceStream stream = streamFromHandle(stdin, "<stdin>", STREAM_CHUNK_SIZE);
+ *   Lexer lexer = lexerFromStream(&stream);  // refills the stream on demand
+ *
+ *   for (Token token = nextToken(&lexer); token.kind != TOKEN_EOF; token = nextToken(&lexer)) {
+ *     printf("%.*s\n", token.chars.len, token.chars.chars);  // valid until the next token
+ *   }
+ *
+ *   deleteStream(&stream);  // does not close stdin
+ * }
+ * ```
+ */
+
+
+#include "source.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+
+/**
+ * `STREAM_CHUNK_SIZE` is the default number of bytes read per refill.
+ */
+#define STREAM_CHUNK_SIZE (64*1024)
+
+
+/**
+ * `SourceStream` reads a source code chunk by chunk. The stored data is meant to be used
+ * internally, except for `window`.
+ *
+ * - **field:** `window`    - the source containing the unconsumed part of the input
+ * - **field:** `file`      - the file to read from
+ * - **field:** `ownsFile`  - `true` if the file must be closed on deletion
+ * - **field:** `buffer`    - the memory holding the window's content
+ * - **field:** `capacity`  - the size of the buffer
+ * - **field:** `chunkSize` - the number of bytes to read per refill
+ * - **field:** `offset`    - the offset of the window within the whole input
+ * - **field:** `eof`       - `true` once the whole input was read
+ * - **field:** `tail`      - the bytes of a character cut by the end of the last chunk
+ * - **field:** `tailSize`  - the number of bytes in `tail`
+ * - **field:** `message`   - the error message if the input was rejected or could not be read
+ */
+typedef struct SourceStream {
+  Source window;
+  FILE*  file;
+  bool   ownsFile;
+  char*  buffer;
+  size_t capacity;
+  size_t chunkSize;
+  size_t offset;
+  bool   eof;
+  char   tail[3];
+  size_t tailSize;
+  string message;
+} SourceStream;
+
+
+/**
+ * `streamFromFile()` opens a file for streaming. In case of errors the window's `status` is set
+ * to `SOURCE_ERROR` and its `content` will contain an error message.
+ *
+ * - **param:** `name`      - the file name
+ * - **param:** `chunkSize` - the number of bytes to read per refill
+ * - **return:** the stream for the file
+ */
+SourceStream streamFromFile(const char* name, size_t chunkSize);
+
+
+/**
+ * `streamFromHandle()` streams an already opened file like `stdin` or a pipe. The handle will not
+ * be closed by `deleteStream()`.
+ *
+ * - **param:** `file`      - the file handle to read from
+ * - **param:** `name`      - the name used in diagnostics
+ * - **param:** `chunkSize` - the number of bytes to read per refill
+ * - **return:** the stream for the handle
+ */
+SourceStream streamFromHandle(FILE* file, const char* name, size_t chunkSize);
+
+
+/**
+ * `streamRefill()` drops all characters of the window before `keep` (or rather before the start
+ * of the line containing `keep`) and reads the next chunk. The number of dropped characters is
+ * returned, such that indices into the window can be adjusted. If the input is exhausted or
+ * rejected the window stays as it is and `eof` is set. Unless `eof` is set, the window grows by at
+ * least one character.
+ *
+ * - **param:** `stream` - the stream to refill
+ * - **param:** `keep`   - the index of the first window character that is still in use
+ * - **return:** the number of characters dropped from the front of the window
+ */
+size_t streamRefill(SourceStream* stream, size_t keep);
+
+
+/**
+ * `deleteStream()` releases the buffer and closes the file if it was opened by the stream. The
+ * window's `status` is set to `SOURCE_NONE`.
+ *
+ * - **param:** `stream` - the stream to be deleted
+ */
+void deleteStream(SourceStream* stream);
+
+
+#endif  // __STREAM_H__
@@ -7,11 +7,14 @@
  * ======
  *
  * Source code is divided into a stream of `Token`s by the lexer. `Tokens` with similar properties
- * belong to the same `TokenKind` such as numbers and identiers. For each token the locations of
- * their first and last character within the source. Each token contains a string with the token
- * characters, which is a window into the source code. If the lexer detects some grammar violation
- * it will return a `TOKEN_ERROR` token describing the error. The token owns the error. Since the
- * error has allocated memory for the message, it must be freed!
+ * belong to the same `TokenKind` such as numbers and identiers. Each token contains a string with
+ * the token characters, which is a window into the source code. The locations of the token's first
+ * and last character are not stored, but computed on demand by `tokenStart()` and `tokenEnd()`
+ * from the position of the characters within the source, as only diagnostics need them. If the
+ * lexer detects some grammar violation it will return a `TOKEN_ERROR` token, which tells the kind
+ * of the error and the character it points to. The message is only rendered if some consumer
+ * calls `errorFromToken()`, thus lexing garbage input never allocates. The rendered error must be
+ * freed!
  *
  *
  * Example
@@ -31,52 +34,57 @@
  *   assert(token.kind != TOKEN_NONE);  // TOKEN_NONE is an invalid token
  *   assert(token.kind == TOKEN_NAME);
  *   // tokens have a start and end location within the source
- *   // start and end is the occurance of the first and the last character of the token
- *   assert(token.start.line == 1);
- *   assert(token.start.pos == 1);
- *   assert(token.end.line == 1);
- *   assert(token.end.pos == 1);
+ *   // start and end is the occurance of the first and the last character of the token, they are
+ *   // computed on demand
+ *   assert(tokenStart(token).line == 1);
+ *   assert(tokenStart(token).pos == 1);
+ *   assert(tokenEnd(token).line == 1);
+ *   assert(tokenEnd(token).pos == 1);
  *   assert(cstrequal(token.source->fileName, "<cstring>"));
  *   assert(cstrequal(token.chars, "x"));  // get token characters
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_SYMBOL);
- *   assert(token.start.pos == 3);
- *   assert(token.end.pos == 3);
+ *   assert(token.symbol == SYMBOL_PLUS);  // no need to compare the characters
+ *   assert(tokenStart(token).pos == 3);
+ *   assert(tokenEnd(token).pos == 3);
  *   assert(cstrequal(token.chars, "+"));
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_INT);
- *   assert(token.start.pos == 5);
- *   assert(token.end.pos == 6);
+ *   assert(tokenStart(token).pos == 5);
+ *   assert(tokenEnd(token).pos == 6);
  *   assert(cstrequal(token.chars, "42"));
+ *   assert(token.value == 42);
  *   printf("%.*s", token.chars.len, token.chars.chars);
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_SYMBOL);
- *   assert(token.start.pos == 7);
- *   assert(token.end.pos == 7);
+ *   assert(tokenStart(token).pos == 7);
+ *   assert(tokenEnd(token).pos == 7);
  *   assert(cstrequal(token.chars, ";"));
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_ERROR);
- *   assert(token.start.pos == 9);
- *   assert(token.end.pos == 10);
- *   printf("%.*s", token.error->message.len, token.error->message.chars);
- *   deleteError(token.error);  // must be freed
+ *   assert(tokenStart(token).pos == 9);
+ *   assert(tokenEnd(token).pos == 10);
+ *   assert(token.error == LEX_ERROR_INT_FORMAT);
+ *   Error error = errorFromToken(token);  // renders the message
+ *   printf("%.*s", error.message.len, error.message.chars);
+ *   deleteError(&error);  // must be freed
  *
  *   // comments are tokens as well (note that \n is not part of the comment)
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_COMMENT);
- *   assert(token.start.pos == 12);
- *   assert(token.end.pos == 19);
+ *   assert(tokenStart(token).pos == 12);
+ *   assert(tokenEnd(token).pos == 19);
  *   assert(cstrequal(token.chars, "// error"));
  *
  *   token = nextToken(&lexer);
  *   assert(token.kind == TOKEN_EOF);
- *   assert(token.start.line == 2);
- *   assert(token.start.pos == 1);
- *   assert(token.end.pos == 1);
+ *   assert(tokenStart(token).line == 2);
+ *   assert(tokenStart(token).pos == 1);
+ *   assert(tokenEnd(token).pos == 1);
  *   assert(cstrequal(token.chars, ""));
  *
  *   deleteSource(&src);
@@ -91,6 +99,7 @@
 #include "error.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 
 /**
@@ -101,9 +110,12 @@
  * - **enum:** `TOKEN_ERROR`   - error token due to violation of the lexical grammar
  * - **enum:** `TOKEN_COMMENT` - single-line or multi-line comment token
  * - **enum:** `TOKEN_INT`     - integer literal token
+ * - **enum:** `TOKEN_FLOAT`   - floating-point literal token like 1.5, 2e-3 or 0x1.8p3
+ * - **enum:** `TOKEN_STRING`  - string literal token like "abc\n"
+ * - **enum:** `TOKEN_CHAR`    - character literal token like 'a' or '\n'
  * - **enum:** `TOKEN_NAME`    - identifier token
  * - **enum:** `TOKEN_KEYWORD` - keyword token like "if", "else", etc.
- * - **enum:** `TOKEN_SYMBOL`  - special characters like "+", "++", "<=", "(", "->", etc.
+ * - **enum:** `TOKEN_SYMBOL`  - operators and separators like "+", "<=", "(", "->", etc.
  */
 typedef enum TokenKind {
   TOKEN_NONE,
@@ -111,6 +123,9 @@ typedef enum TokenKind {
   TOKEN_EOF,
   TOKEN_COMMENT,
   TOKEN_INT,
+  TOKEN_FLOAT,
+  TOKEN_STRING,
+  TOKEN_CHAR,
   TOKEN_NAME,
   TOKEN_KEYWORD,
   TOKEN_SYMBOL,
@@ -126,6 +141,170 @@ typedef enum TokenKind {
 const char* strTokenKind(TokenKind kind);
 
 
+/**
+ * `Keyword` identifies the keyword of a `TOKEN_KEYWORD` token, such that the parser never needs to
+ * compare the keyword's characters. All other tokens have `KEYWORD_NONE`.
+ */
+typedef enum Keyword {
+  KEYWORD_NONE,
+  KEYWORD_IF,
+  KEYWORD_ELSE,
+  KEYWORD_DO,
+  KEYWORD_WHILE,
+  KEYWORD_FOR,
+  KEYWORD_SWITCH,
+  KEYWORD_CASE,
+  KEYWORD_BREAK,
+  KEYWORD_CONTINUE,
+  KEYWORD_RETURN,
+  KEYWORD_TRUE,
+  KEYWORD_FALSE,
+  KEYWORD_VAR,
+  KEYWORD_CONST,
+  KEYWORD_FUNC,
+  KEYWORD_STRUCT,
+  KEYWORD_BLANK,
+} Keyword;
+
+
+/**
+ * `strKeyword()` returns the `Keyword` as a string.
+ *
+ * - **param:** `keyword` - the keyword
+ * - **return:** the string representation of the keyword
+ */
+const char* strKeyword(Keyword keyword);
+
+
+/**
+ * `Symbol` identifies the operator or separator of a `TOKEN_SYMBOL` token, such that the parser
+ * can dispatch on a symbol without comparing its characters. All other tokens have `SYMBOL_NONE`.
+ */
+typedef enum Symbol {
+  SYMBOL_NONE,
+  SYMBOL_LPAREN,
+  SYMBOL_RPAREN,
+  SYMBOL_LBRACKET,
+  SYMBOL_RBRACKET,
+  SYMBOL_LBRACE,
+  SYMBOL_RBRACE,
+  SYMBOL_COMMA,
+  SYMBOL_SEMICOLON,
+  SYMBOL_COLON,
+  SYMBOL_DOT,
+  SYMBOL_NOT,
+  SYMBOL_NOT_EQUAL,
+  SYMBOL_ASSIGN,
+  SYMBOL_EQUAL,
+  SYMBOL_LESS,
+  SYMBOL_LESS_EQUAL,
+  SYMBOL_GREATER,
+  SYMBOL_GREATER_EQUAL,
+  SYMBOL_AND,
+  SYMBOL_LOGICAL_AND,
+  SYMBOL_OR,
+  SYMBOL_LOGICAL_OR,
+  SYMBOL_PLUS,
+  SYMBOL_MINUS,
+  SYMBOL_ARROW,
+  SYMBOL_STAR,
+  SYMBOL_SLASH,
+  SYMBOL_PERCENT,
+  SYMBOL_CARET,
+  SYMBOL_TILDE,
+} Symbol;
+
+
+/**
+ * `strSymbol()` returns the `Symbol` as a string.
+ *
+ * - **param:** `symbol` - the symbol
+ * - **return:** the string representation of the symbol
+ */
+const char* strSymbol(Symbol symbol);
+
+
+/**
+ * `symbolChars()` returns the characters of a symbol like `"+"` or `"->"`. The string is static and
+ * thus has a unique address for every symbol.
+ *
+ * - **param:** `symbol` - the symbol
+ * - **return:** the characters of the symbol (empty for `SYMBOL_NONE`)
+ */
+const char* symbolChars(Symbol symbol);
+
+
+/**
+ * `LexErrorKind` identifies the grammar violation of a `TOKEN_ERROR` token.
+ *
+ * - **enum:** `LEX_ERROR_NONE`             - no error
+ * - **enum:** `LEX_ERROR_ILLEGAL_CHAR`     - a character that cannot start any token
+ * - **enum:** `LEX_ERROR_UNCLOSED_COMMENT` - a multi-line comment without closing characters
+ * - **enum:** `LEX_ERROR_INT_FORMAT`       - an integer followed by letters
+ * - **enum:** `LEX_ERROR_HEX_DIGITS`       - a hex integer without digits
+ * - **enum:** `LEX_ERROR_HEX_FORMAT`       - a hex integer followed by letters
+ * - **enum:** `LEX_ERROR_BIN_DIGITS`       - a bin integer without digits
+ * - **enum:** `LEX_ERROR_BIN_FORMAT`       - a bin integer followed by letters or digits
+ * - **enum:** `LEX_ERROR_INT_OVERFLOW`     - an integer that does not fit into 64 bits
+ * - **enum:** `LEX_ERROR_FLOAT_FORMAT`     - a float followed by letters
+ * - **enum:** `LEX_ERROR_HEX_EXPONENT`     - a hex float without binary exponent
+ * - **enum:** `LEX_ERROR_FLOAT_OVERFLOW`   - a float that does not fit into a double
+ * - **enum:** `LEX_ERROR_UNCLOSED_STRING`  - a string literal without closing quote in its line
+ * - **enum:** `LEX_ERROR_UNCLOSED_CHAR`    - a character literal without closing quote in its line
+ * - **enum:** `LEX_ERROR_INVALID_ESCAPE`   - an unknown escape sequence or a hex escape without two
+ *                                            digits
+ * - **enum:** `LEX_ERROR_CHAR_LENGTH`      - a character literal without exactly one character
+ * - **enum:** `LEX_ERROR_SOURCE_SIZE`      - a source too large for a token array
+ */
+typedef enum LexErrorKind {
+  LEX_ERROR_NONE,
+  LEX_ERROR_ILLEGAL_CHAR,
+  LEX_ERROR_UNCLOSED_COMMENT,
+  LEX_ERROR_INT_FORMAT,
+  LEX_ERROR_HEX_DIGITS,
+  LEX_ERROR_HEX_FORMAT,
+  LEX_ERROR_BIN_DIGITS,
+  LEX_ERROR_BIN_FORMAT,
+  LEX_ERROR_INT_OVERFLOW,
+  LEX_ERROR_FLOAT_FORMAT,
+  LEX_ERROR_HEX_EXPONENT,
+  LEX_ERROR_FLOAT_OVERFLOW,
+  LEX_ERROR_UNCLOSED_STRING,
+  LEX_ERROR_UNCLOSED_CHAR,
+  LEX_ERROR_INVALID_ESCAPE,
+  LEX_ERROR_CHAR_LENGTH,
+  LEX_ERROR_SOURCE_SIZE,
+} LexErrorKind;
+
+
+/**
+ * `strLexErrorKind()` returns the `LexErrorKind` as a string.
+ *
+ * - **param:** `kind` - the error kind
+ * - **return:** the string representation of the error kind
+ */
+const char* strLexErrorKind(LexErrorKind kind);
+
+
+/**
+ * `LexError` is the compact record of a lexical error. The lexer collects a record for every
+ * `TOKEN_ERROR` token, such that all errors can be reported after lexing. No message is rendered
+ * until `errorFromLexError()` in *lexer.h* is called. The offsets are relative to the whole input,
+ * also if the source is streamed.
+ *
+ * - **field:** `kind`   - the kind of the error
+ * - **field:** `offset` - the offset of the error token's first character
+ * - **field:** `length` - the number of characters of the error token
+ * - **field:** `caret`  - the offset of the erroneous character within the token's characters
+ */
+typedef struct LexError {
+  LexErrorKind kind;
+  size_t       offset;
+  uint32_t     length;
+  uint32_t     caret;
+} LexError;
+
+
 /**
  * `Token` is the smallest entity in a source file. Each token is defined by some regular
  * expression in some grammar. `Token` stores all the information that is necessary to distinguish
@@ -133,21 +312,64 @@ const char* strTokenKind(TokenKind kind);
  * string must not be freed. Undefined behavior will occur if a token is used once the underlying
  * source was freed, since the string will point to some invalid memory.
  *
- * - **field:** `kind`   - the `TokenKind` of the token
- * - **field:** `source` - the pointer to the source the token was read from
- * - **field:** `start`  - the location of the token's first character within the source
- * - **field:** `end`    - the location of the token's last character within the source
- * - **field:** `chars`  - the string containing the token characters
- * - **field:** `error`  - the error with more information if token kind is `TOKEN_ERROR`
+ * - **field:** `kind`       - the `TokenKind` of the token
+ * - **field:** `keyword`    - the `Keyword` if token kind is `TOKEN_KEYWORD`
+ * - **field:** `symbol`     - the `Symbol` if token kind is `TOKEN_SYMBOL`
+ * - **field:** `error`      - the `LexErrorKind` if token kind is `TOKEN_ERROR`
+ * - **field:** `value`      - the value if token kind is `TOKEN_INT`, the code point if token kind
+ *                             is `TOKEN_CHAR`, the number of bytes of the decoded string if token
+ *                             kind is `TOKEN_STRING`
+ * - **field:** `floatValue` - the value if token kind is `TOKEN_FLOAT`
+ * - **field:** `caret`      - the offset of the erroneous character within the characters if token
+ *                             kind is `TOKEN_ERROR`
+ * - **field:** `source`     - the pointer to the source the token was read from
+ * - **field:** `chars`      - the string containing the token characters
  */
 typedef struct Token {
-  TokenKind     kind;
-  const Source* source;
-  Location      start;
-  Location      end;
-  string        chars;
-  Error*        error;
+  TokenKind      kind;
+  union {
+    Keyword      keyword;
+    Symbol       symbol;
+    LexErrorKind error;
+  };
+  union {
+    uint64_t     value;
+    double       floatValue;
+    uint32_t     caret;
+  };
+  const Source*  source;
+  string         chars;
 } Token;
 
 
+/**
+ * `tokenStart()` returns the location of the token's first character within the source. The
+ * location is derived from the source's line index.
+ *
+ * - **param:** `token` - the token
+ * - **return:** the location of the first character
+ */
+Location tokenStart(Token token);
+
+
+/**
+ * `tokenEnd()` returns the location of the token's last character within the source. An empty
+ * token like `TOKEN_EOF` ends where it starts.
+ *
+ * - **param:** `token` - the token
+ * - **return:** the location of the last character
+ */
+Location tokenEnd(Token token);
+
+
+/**
+ * `errorFromToken()` renders the error of a `TOKEN_ERROR` token. The location of the error is the
+ * caret. As the message is allocated, the error must be deleted.
+ *
+ * - **param:** `token` - the error token
+ * - **return:** the error with the rendered message
+ */
+Error errorFromToken(Token token);
+
+
 #endif  // __TOKEN_H__
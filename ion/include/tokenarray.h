@@ -0,0 +1,195 @@
+#ifndef __TOKENARRAY_H__
+#define __TOKENARRAY_H__
+
+
+/**
+ * Token Arrays
+ * ============
+ *
+ * The lexer usually produces one `Token` at a time on demand. A `Token` is rather large as it
+ * holds a source pointer, a string and a value. `lexSource()` in lexer.h lexes a whole source in
+ * one tight loop instead and stores the tokens in a `TokenArray`. The array is a structure of
+ * arrays, a token is given by its index into each of them. Only the kind,
+ * the keyword or symbol, the offset and the length of the characters are stored, that's 10 bytes
+ * per token. Thus even the tokens of large sources fit into the cache, and several passes over the
+ * tokens (skimming, parsing, highlighting) don't need to lex the source again.
+ *
+ * `tokenAt()` or a `TokenIterator` restore a full `Token` view including the locations, which are
+ * derived from the source's line index. The values of literal tokens and the carets of
+ * `TOKEN_ERROR` tokens are stored aside, as most tokens have neither. The error records of the
+ * lexer are kept as well, such that all errors can be reported without looking at every token.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "tokenarray.h"
+ * #include "lexer.h"
+ * #include <assert.h>
+ * #include <stdio.h>
+ *
+ * int main() {
+ *   Source src = sourceFromString("x + 42");
+ *   TokenArray tokens = lexSource(&src);  // lexes all tokens at once
+ *   assert(tokenCount(&tokens) == 4);  // the last token is always TOKEN_EOF
+ *   assert(tokens.kinds[2] == TOKEN_INT);
+ *   assert(tokens.offsets[2] == 4);
+ *   assert(tokens.lengths[2] == 2);
+ *   assert(tokens.values[0].index == 2);  // only integers have a value
+ *   assert(tokens.values[0].value == 42);
+ *
+ *   TokenIterator it = iteratorFromTokens(&tokens);
+ *   for (Token token = iteratorNext(&it); token.kind != TOKEN_EOF; token = iteratorNext(&it)) {
+ *     printf("%.*s\n", token.chars.len, token.chars.chars);  // same tokens as from the lexer
+ *   }
+ *
+ *   deleteTokenArray(&tokens);  // deletes all arrays
+ *   deleteSource(&src);
+ * }
+ * ```
+ */
+
+
+#include "source.h"
+#include "token.h"
+#include "error.h"
+#include "sbuffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * **INTERNAL!** `TokenValue` assigns a value to the token at some index, which is the value of a
+ * literal token or the caret of a `TOKEN_ERROR` token.
+ *
+ * - **field:** `index` - the index of the token
+ * - **field:** `value` - the value of the token
+ */
+typedef struct TokenValue {
+  uint32_t index;
+  uint64_t value;
+} TokenValue;
+
+
+/**
+ * `TOKEN_ARRAY_MAX_CONTENT` is the size of the largest content whose tokens fit into a token
+ * array. The offsets and lengths are stored in 32 bits to keep the array compact, and the lexer
+ * indexes the content by `int`. The tokens of a larger source are a single `TOKEN_ERROR` of kind
+ * `LEX_ERROR_SOURCE_SIZE` followed by the `TOKEN_EOF`, both at offset `0`. A streamed source has
+ * no such limit, as its lexer only indexes the window.
+ */
+#define TOKEN_ARRAY_MAX_CONTENT ((size_t) INT32_MAX)
+
+
+/**
+ * `TokenArray` stores all tokens of a source as a structure of arrays.
+ *
+ * - **field:** `source`   - the source the tokens were read from
+ * - **field:** `kinds`    - the `TokenKind` of every token
+ * - **field:** `subkinds` - the `Keyword`, `Symbol` or `LexErrorKind` of every token
+ * - **field:** `offsets`  - the offset of every token's first character within the content
+ * - **field:** `lengths`  - the number of characters of every token
+ * - **field:** `values`   - the values and carets of the tokens that have one, in order
+ * - **field:** `errors`   - the records of all errors in order of the tokens
+ */
+typedef struct TokenArray {
+  const Source*    source;
+  SBUF(uint8_t)    kinds;
+  SBUF(uint8_t)    subkinds;
+  SBUF(uint32_t)   offsets;
+  SBUF(uint32_t)   lengths;
+  SBUF(TokenValue) values;
+  SBUF(LexError)   errors;
+} TokenArray;
+
+
+/**
+ * `TokenIterator` iterates over a token array.
+ *
+ * - **field:** `tokens` - the iterated tokens
+ * - **field:** `index`  - the index of the next token
+ * - **field:** `value`  - the position of the next token's value in `values`, i.e. of the first
+ *                         value at or after `index`
+ */
+typedef struct TokenIterator {
+  const TokenArray* tokens;
+  size_t            index;
+  size_t            value;
+} TokenIterator;
+
+
+/**
+ * `tokenCount()` returns the number of tokens including the final `TOKEN_EOF`.
+ *
+ * - **param:** `tokens` - the token array
+ * - **return:** the number of tokens
+ */
+size_t tokenCount(const TokenArray* tokens);
+
+
+/**
+ * `tokenAt()` returns a full view of the token at some index.
+ *
+ * - **param:** `tokens` - the token array
+ * - **param:** `index`  - the index of the token
+ * - **return:** the token at the index
+ */
+Token tokenAt(const TokenArray* tokens, size_t index);
+
+
+/**
+ * `appendToken()` stores a token at the end of the array. The token must have been read from the
+ * array's source. Its error record is not stored, the lexer collects these.
+ *
+ * - **param:** `tokens` - the token array
+ * - **param:** `token`  - the token to append
+ */
+void appendToken(TokenArray* tokens, Token token);
+
+
+/**
+ * `replaceTokens()` replaces a range of tokens by the tokens of another array, which must have
+ * been read from the same source. The offsets of the following tokens and their error records are
+ * shifted, the array takes the replacement's source. The replacement is not deleted. All tokens
+ * behind the range are moved, thus a replacement takes linear time in the size of the array.
+ *
+ * - **param:** `tokens`      - the token array
+ * - **param:** `first`       - the index of the first replaced token
+ * - **param:** `end`         - the index after the last replaced token
+ * - **param:** `replacement` - the new tokens with the error records
+ * - **param:** `shift`       - the change of the following tokens' offsets
+ */
+void replaceTokens(TokenArray* tokens, size_t first, size_t end,
+                   const TokenArray* replacement, int64_t shift);
+
+
+/**
+ * `deleteTokenArray()` deletes all arrays.
+ *
+ * - **param:** `tokens` - the token array to be deleted
+ */
+void deleteTokenArray(TokenArray* tokens);
+
+
+/**
+ * `iteratorFromTokens()` creates an iterator at the first token.
+ *
+ * - **param:** `tokens` - the tokens to iterate over
+ * - **return:** the iterator
+ */
+TokenIterator iteratorFromTokens(const TokenArray* tokens);
+
+
+/**
+ * `iteratorNext()` returns the next token. Just like the lexer it keeps returning the final
+ * `TOKEN_EOF` once the end was reached.
+ *
+ * - **param:** `it` - the iterator
+ * - **return:** the next token
+ */
+Token iteratorNext(TokenIterator* it);
+
+
+#endif  // __TOKENARRAY_H__
@@ -0,0 +1,164 @@
+#ifndef __TOKENQUEUE_H__
+#define __TOKENQUEUE_H__
+
+
+/**
+ * Token Queue
+ * ===========
+ *
+ * A `TokenQueue` passes the tokens of a source from one thread to another, such that a lexer
+ * thread can run ahead of the parser. It is a bounded ring for a single producer and a single
+ * consumer, no locks are needed. The ring stores compact tokens of 24 bytes, the consumer gets
+ * back full `Token` views.
+ *
+ * The producer publishes its tail index and the consumer publishes its head index. Each index sits
+ * on its own cache line together with the owner's private copy of the other index, thus the
+ * threads don't invalidate each other's lines with every token. Both indices are only published
+ * once per batch of tokens, and the other side's index is only read again when the private copy
+ * says the ring is full or empty. A waiting thread yields its core.
+ *
+ * The final `TOKEN_EOF` always publishes the batch and stays in the ring, thus the consumer keeps
+ * receiving it. If the consumer stops early, it closes the queue and the producer's pushes fail.
+ *
+ *
+ * Example
+ * -------
+ *
+ * ```c {.line-numbers}
+ * #include "tokenqueue.h"
+ * #include "lexer.h"
+ * #include <pthread.h>
+ *
+ * static void* lexAll(void* arg) {
+ *   TokenQueue* queue = (TokenQueue*) arg;
+ *   Lexer lexer = lexerFromSource(queue->source);
+ *   Token token;
+ *   do {
+ *     token = nextToken(&lexer);
+ *   } while (queuePush(queue, token) && token.kind != TOKEN_EOF);  // fails if closed
+ *   deleteLexer(&lexer);
+ *   return NULL;
+ * }
+ *
+ * int main() {
+ *   Source src = sourceFromString("x + 1");
+ *   TokenQueue queue = createTokenQueue(&src);
+ *   pthread_t producer;
+ *   pthread_create(&producer, NULL, lexAll, &queue);
+ *   for (Token token = queuePop(&queue); token.kind != TOKEN_EOF; token = queuePop(&queue)) {
+ *     // parse the token
+ *   }
+ *   closeTokenQueue(&queue);
+ *   pthread_join(producer, NULL);
+ *   deleteTokenQueue(&queue);
+ *   deleteSource(&src);
+ * }
+ * ```
+ */
+
+
+#include "source.h"
+#include "token.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define TOKEN_QUEUE_SIZE  4096
+#define TOKEN_QUEUE_BATCH 64
+
+
+/**
+ * **INTERNAL!** `QueuedToken` is the compact form of a token within the ring.
+ *
+ * - **field:** `value`   - the value of a literal token or the caret of a `TOKEN_ERROR`
+ * - **field:** `offset`  - the offset of the token's first character
+ * - **field:** `length`  - the number of characters
+ * - **field:** `kind`    - the `TokenKind`
+ * - **field:** `subkind` - the `Keyword`, `Symbol` or `LexErrorKind`
+ */
+typedef struct QueuedToken {
+  uint64_t value;
+  uint32_t offset;
+  uint32_t length;
+  uint8_t  kind;
+  uint8_t  subkind;
+} QueuedToken;
+
+
+/**
+ * `TokenQueue` is a ring of tokens between a producer and a consumer thread. Only the source is
+ * meant to be read, the other fields are internal.
+ *
+ * - **field:** `source`    - the source of the tokens
+ * - **field:** `slots`     - the ring of `TOKEN_QUEUE_SIZE` tokens
+ * - **field:** `tail`      - the published index after the last pushed token
+ * - **field:** `pushed`    - the producer's index after the last pushed token
+ * - **field:** `knownHead` - the producer's copy of `head`
+ * - **field:** `head`      - the published index of the next token to pop
+ * - **field:** `popped`    - the consumer's index of the next token to pop
+ * - **field:** `knownTail` - the consumer's copy of `tail`
+ * - **field:** `closed`    - whether the consumer stopped popping
+ */
+typedef struct TokenQueue {
+  const Source*        source;
+  QueuedToken*         slots;
+  _Alignas(64) size_t  tail;
+  size_t               pushed;
+  size_t               knownHead;
+  _Alignas(64) size_t  head;
+  size_t               popped;
+  size_t               knownTail;
+  bool                 closed;
+} TokenQueue;
+
+
+/**
+ * `createTokenQueue()` creates an empty queue for the tokens of a source.
+ *
+ * - **param:** `src` - the source of the tokens
+ * - **return:** the empty queue
+ */
+TokenQueue createTokenQueue(const Source* src);
+
+
+/**
+ * `deleteTokenQueue()` deletes the ring. Both threads must be done with the queue.
+ *
+ * - **param:** `queue` - the queue to be deleted
+ */
+void deleteTokenQueue(TokenQueue* queue);
+
+
+/**
+ * `queuePush()` appends a token, which must be read from the queue's source. It waits while the
+ * ring is full. Only the producer thread may call it.
+ *
+ * - **param:** `queue` - the queue
+ * - **param:** `token` - the token to append
+ * - **return:** `false` if the queue was closed and the token was dropped
+ */
+bool queuePush(TokenQueue* queue, Token token);
+
+
+/**
+ * `queuePop()` returns the next token. It waits while the ring is empty. Once the `TOKEN_EOF` was
+ * reached, it is returned again and again. Only the consumer thread may call it.
+ *
+ * - **param:** `queue` - the queue
+ * - **return:** the next token
+ */
+Token queuePop(TokenQueue* queue);
+
+
+/**
+ * `closeTokenQueue()` tells the producer that no more tokens are popped. Only the consumer thread
+ * may call it.
+ *
+ * - **param:** `queue` - the queue
+ */
+void closeTokenQueue(TokenQueue* queue);
+
+
+#endif  // __TOKENQUEUE_H__
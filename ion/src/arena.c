@@ -69,8 +69,9 @@ void arenaFree(Arena *arena) {
 #include <unistd.h>
 void arena_grow(Arena* arena, size_t min_size) {
     size_t size = ALIGN_UP(MAX(ARENA_BLOCK_SIZE, min_size), ARENA_ALIGNMENT);
-    arena->ptr = malloc(1024);
+    arena->ptr = malloc(size);
     arena->end = arena->ptr + size;
+    arena->totalSpace += size;
     sbufPush(arena->blocks, arena->ptr);
 }
 void* arenaAlloc(Arena *arena, size_t size) {
@@ -79,6 +80,7 @@ void* arenaAlloc(Arena *arena, size_t size) {
         assert(size <= (size_t)(arena->end - arena->ptr));
     }
     void *ptr = arena->ptr;
+    arena->usedSpace += size;
     arena->ptr = ALIGN_UP_PTR(arena->ptr + size, ARENA_ALIGNMENT);
     assert(arena->ptr <= arena->end);
     assert(ptr == ALIGN_DOWN_PTR(ptr, ARENA_ALIGNMENT));
@@ -17,6 +17,7 @@ const char* strExprKind(ExprKind kind) {
   switch (kind) {
     CASE(EXPR_NONE);
     CASE(EXPR_INT);
+    CASE(EXPR_FLOAT);
     CASE(EXPR_NAME);
     CASE(EXPR_PAREN);
     CASE(EXPR_UNOP);
@@ -43,6 +44,7 @@ void deleteNode(ASTNode* node) {
       switch (node->expr.kind) {
         case EXPR_NONE:
         case EXPR_INT:
+        case EXPR_FLOAT:
         case EXPR_NAME:
           break;
         case EXPR_PAREN:
@@ -1,76 +1,151 @@
 #include "astprinter.h"
 
+#include "floating.h"
+#include "sbuffer.h"
+
+#include <stdlib.h>
 #include <string.h>
 
 
-string printASTExpr(const ASTNode* node) {
+static void appendChars(SBUF(char)* out, const char* chars, size_t length) {
+  if (length > 0) {
+    sbufFit(*out, length);
+    memcpy(sbufEnd(*out), chars, length);
+    sbufSetLength(*out, sbufLength(*out) + length);
+  }
+}
+
+
+static void appendString(SBUF(char)* out, string s) {
+  appendChars(out, s.chars, s.len);
+}
+
+
+static void appendText(SBUF(char)* out, const char* text) {
+  appendChars(out, text, strlen(text));
+}
+
+
+/**
+ * The digits are written to the stack and copied, only a large number is written again right into
+ * the buffer. Its scratch is allocated here, as the number module never allocates for a string.
+ */
+static void appendNumber(SBUF(char)* out, Number num) {
+  char buffer[NUM_STRING_SIZE];
+  uint64_t* scratch = NULL;
+  if (num.size > 0) {
+    scratch = (uint64_t*) malloc(NUM_DEC_SCRATCH(num) * sizeof(uint64_t));
+  }
+  size_t length = toDecString(num, buffer, sizeof(buffer), false, scratch);
+  if (length < sizeof(buffer)) {
+    appendChars(out, buffer, length);
+  } else {
+    sbufFit(*out, length + 1);
+    toDecString(num, sbufEnd(*out), length + 1, false, scratch);
+    sbufSetLength(*out, sbufLength(*out) + length);
+  }
+  free(scratch);
+}
+
+
+static void appendAST(SBUF(char)* out, const ASTNode* node);
+
+
+static void appendExpr(SBUF(char)* out, const ASTNode* node) {
   switch (node->expr.kind) {
     case EXPR_NONE:
-      return stringFromArray("(none)");
+      appendText(out, "(none)");
+      break;
 
     case EXPR_INT:
-      return toDecString(node->expr.value);
+      appendNumber(out, constAt(node->expr.constant));
+      break;
+
+    case EXPR_FLOAT:
+    {
+      string value = doubleToString(node->expr.floatValue);
+      appendString(out, value);
+      strFree(&value);
+    } break;
 
     case EXPR_NAME:
-      return stringFromPrint("%.*s", node->expr.name.len, node->expr.name.chars);
+      appendString(out, node->expr.name);
+      break;
 
     case EXPR_UNOP:
-    {
-      string op = node->expr.op;
-      string expr = printAST(node->expr.rhs);
-      string msg = stringFromPrint("(%.*s %.*s)", op.len, op.chars, expr.len, expr.chars);
-      strFree(&expr);
-      return msg;
-    }
+      appendText(out, "(");
+      appendString(out, node->expr.op);
+      appendText(out, " ");
+      appendAST(out, node->expr.rhs);
+      appendText(out, ")");
+      break;
 
     case EXPR_BINOP:
-    {
-      string lhs = printAST(node->expr.lhs);
-      string op = node->expr.op;
-      string rhs = printAST(node->expr.rhs);
-      string msg = stringFromPrint("(%.*s %.*s %.*s)",
-                                   op.len, op.chars, lhs.len, lhs.chars, rhs.len, rhs.chars);
-      strFree(&lhs);
-      strFree(&rhs);
-      return msg;
-    }
+      appendText(out, "(");
+      appendString(out, node->expr.op);
+      appendText(out, " ");
+      appendAST(out, node->expr.lhs);
+      appendText(out, " ");
+      appendAST(out, node->expr.rhs);
+      appendText(out, ")");
+      break;
 
     case EXPR_PAREN:
-    {
-      string expr = printAST(node->expr.expr);
-      string msg = stringFromPrint("(%.*s)", expr.len, expr.chars);
-      strFree(&expr);
-      return msg;
-    }
+      appendText(out, "(");
+      appendAST(out, node->expr.expr);
+      appendText(out, ")");
+      break;
 
     default:
-      return stringFromArray("todo");
+      appendText(out, "todo");
+      break;
   }
 }
 
 
-string printAST(const ASTNode* node) {
+/**
+ * An error shows the first line of its first message.
+ */
+static void appendAST(SBUF(char)* out, const ASTNode* node) {
   switch (node->kind) {
     case AST_NONE:
-      return stringFromArray("(none)");
+      appendText(out, "(none)");
+      break;
 
     case AST_ERROR:
     {
-      // get first line of the error message, therefore simply replace the first '\n' with '\0'
-      char* pos = (char*) strchr(node->messages[0].chars, '\n');
-      char old = *pos;
-      *pos = '\0';
-      string fault = printAST(node->faultyNode);
-      string msg = stringFromPrint("(error \"%s\" in %.*s)",
-                                   node->messages[0].chars, fault.len, fault.chars);
-      *pos = old;
-      return msg;
-    }
+      const char* message = node->messages[0].chars;
+      const char* newline = strchr(message, '\n');
+      appendText(out, "(error \"");
+      appendChars(out, message, newline ? (size_t) (newline - message) : strlen(message));
+      appendText(out, "\" in ");
+      appendAST(out, node->faultyNode);
+      appendText(out, ")");
+    } break;
 
     case AST_EXPR:
-      return printASTExpr(node);
+      appendExpr(out, node);
+      break;
 
     default:
-      return stringFromArray("todo");
+      appendText(out, "todo");
+      break;
+  }
+}
+
+
+/**
+ * The whole tree is appended to one buffer, thus only the result is allocated on its own.
+ */
+string printAST(const ASTNode* node) {
+  SBUF(char) out = NULL;
+  appendAST(&out, node);
+  size_t length = sbufLength(out);
+  char* chars = (char*) malloc(length + 1);
+  if (length > 0) {
+    memcpy(chars, out, length);
   }
+  chars[length] = '\0';
+  sbufFree(out);
+  return (string){ .len=length, .owned=true, .chars=chars };
 }
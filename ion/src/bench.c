@@ -0,0 +1,405 @@
+#include "ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sbuffer.h"
+#include "source.h"
+#include "strintern.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/**
+ * Front-End Benchmark
+ * ===================
+ *
+ * The benchmark generates synthetic corpora of different shapes and measures how fast the lexer
+ * and the parser process them. The corpora are built by a seeded random generator, thus every run
+ * measures the very same input. Each corpus is a single valid expression, because the parser
+ * handles nothing else yet. The results are printed as JSON to compare them across revisions:
+ *
+ * ```
+ * make bench > bench.json
+ * bin/bench 4096             # corpora of 4 MiB each
+ * ```
+ *
+ * The parser recurses once per operator, thus the benchmark runs on a thread with a large stack.
+ * Allocations are counted by wrapping `malloc()` and friends with the linker's `--wrap` option.
+ */
+
+
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown"
+#endif
+
+#define DEFAULT_CORPUS_KIB 1024
+#define BENCH_STACK_SIZE   ((size_t) 1 << 30)
+#define MIN_REPETITIONS    5
+#define MIN_SECONDS        0.5
+#define LINE_WIDTH         80
+#define VOCABULARY_SIZE    512
+
+
+/****************************************** ALLOCATIONS ******************************************/
+
+
+static size_t g_allocations = 0;
+
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __real_aligned_alloc(size_t alignment, size_t size);
+
+
+void* __wrap_malloc(size_t size) {
+  g_allocations++;
+  return __real_malloc(size);
+}
+
+
+void* __wrap_calloc(size_t count, size_t size) {
+  g_allocations++;
+  return __real_calloc(count, size);
+}
+
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  g_allocations++;
+  return __real_realloc(ptr, size);
+}
+
+
+void* __wrap_aligned_alloc(size_t alignment, size_t size) {
+  g_allocations++;
+  return __real_aligned_alloc(alignment, size);
+}
+
+
+/******************************************** CORPORA ********************************************/
+
+
+/**
+ * **INTERNAL!** A `Generator` appends random terms to a corpus until it reaches its size. It
+ * breaks the lines after about `LINE_WIDTH` characters. Like real code, the corpus reuses a limited
+ * vocabulary of names.
+ *
+ * - **field:** `chars`     - the generated characters
+ * - **field:** `names`     - the vocabulary of names
+ * - **field:** `size`      - the target size in bytes
+ * - **field:** `lineStart` - the index where the current line starts
+ * - **field:** `state`     - the state of the xorshift random generator
+ */
+typedef struct Generator {
+  SBUF(char) chars;
+  SBUF(char) names[VOCABULARY_SIZE];
+  size_t     size;
+  size_t     lineStart;
+  uint64_t   state;
+} Generator;
+
+
+static uint64_t randomBits(Generator* gen) {
+  gen->state ^= gen->state << 13;
+  gen->state ^= gen->state >> 7;
+  gen->state ^= gen->state << 17;
+  return gen->state;
+}
+
+
+static int randomInt(Generator* gen, int low, int high) {
+  return low + (int) (randomBits(gen) % (uint64_t) (high - low + 1));
+}
+
+
+static void append(Generator* gen, const char* chars) {
+  for (const char* c = chars; *c != '\0'; c++) {
+    sbufPush(gen->chars, *c);
+  }
+}
+
+
+static void appendName(Generator* gen, SBUF(char)* chars, int length) {
+  static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+  sbufPush(*chars, letters[randomInt(gen, 0, 51)]);
+  for (int i = 1; i < length; i++) {
+    sbufPush(*chars, letters[randomInt(gen, 0, 52)]);
+  }
+  sbufPush(*chars, '0' + randomInt(gen, 0, 9));  // no name ends in a digit like a keyword
+}
+
+
+static void appendWord(Generator* gen) {
+  const char* name = gen->names[randomInt(gen, 0, VOCABULARY_SIZE - 1)];
+  append(gen, name);
+}
+
+
+static void appendOperator(Generator* gen, bool spaced) {
+  static const char* ops[] = { "+", "-", "*", "/", "%" };
+  const char* op = ops[randomInt(gen, 0, 4)];
+  if (sbufLength(gen->chars) - gen->lineStart >= LINE_WIDTH) {
+    sbufPush(gen->chars, '\n');
+    gen->lineStart = sbufLength(gen->chars);
+    append(gen, op);
+    append(gen, " ");
+  } else if (spaced) {
+    append(gen, " ");
+    append(gen, op);
+    append(gen, " ");
+  } else {
+    append(gen, op);
+  }
+}
+
+
+static void identifierTerm(Generator* gen) {
+  appendWord(gen);
+}
+
+
+static void literalTerm(Generator* gen) {
+  char chars[64];
+  switch (randomInt(gen, 0, 4)) {
+    case 0:
+      snprintf(chars, sizeof(chars), "%d", randomInt(gen, 0, 1000000));
+      break;
+    case 1:
+      snprintf(chars, sizeof(chars), "%llu", (unsigned long long) randomBits(gen));
+      break;
+    case 2:
+      snprintf(chars, sizeof(chars), "0x%04X_%04X", randomInt(gen, 0, 0xFFFF),
+               randomInt(gen, 0, 0xFFFF));
+      break;
+    case 3:
+      snprintf(chars, sizeof(chars), "0b%d%d%d%d_%d%d%d%d", randomInt(gen, 0, 1),
+               randomInt(gen, 0, 1), randomInt(gen, 0, 1), randomInt(gen, 0, 1),
+               randomInt(gen, 0, 1), randomInt(gen, 0, 1), randomInt(gen, 0, 1),
+               randomInt(gen, 0, 1));
+      break;
+    default:
+      snprintf(chars, sizeof(chars), "%d.%de%d", randomInt(gen, 0, 999), randomInt(gen, 0, 99999),
+               randomInt(gen, -30, 30));
+      break;
+  }
+  append(gen, chars);
+}
+
+
+static void commentTerm(Generator* gen) {
+  static const char* words[] = { "the", "value", "is", "computed", "from", "a", "cached", "table" };
+  bool line = randomInt(gen, 0, 1);
+  appendWord(gen);
+  append(gen, line ? "  // " : " /* ");
+  for (int i = randomInt(gen, 3, 10); i > 0; i--) {
+    append(gen, words[randomInt(gen, 0, 7)]);
+    append(gen, " ");
+  }
+  append(gen, line ? "\n" : "*/");
+  if (line) {
+    gen->lineStart = sbufLength(gen->chars);
+  }
+}
+
+
+/**
+ * The parser handles no parentheses yet, thus the nesting consists of chained unary operators.
+ */
+static void nestingTerm(Generator* gen) {
+  for (int i = randomInt(gen, 16, 64); i > 0; i--) {
+    append(gen, (i % 2 == 0) ? "-" : "~");
+  }
+  appendName(gen, &gen->chars, 1);
+}
+
+
+static void operatorTerm(Generator* gen) {
+  appendName(gen, &gen->chars, 1);
+}
+
+
+/**
+ * **INTERNAL!** A `Corpus` is a named shape of input.
+ *
+ * - **field:** `name`   - the name in the results
+ * - **field:** `term`   - appends a single operand
+ * - **field:** `spaced` - whether the operators are surrounded by spaces
+ */
+typedef struct Corpus {
+  const char* name;
+  void        (*term)(Generator*);
+  bool        spaced;
+} Corpus;
+
+
+static const Corpus corpora[] = {
+  { "identifiers", identifierTerm, true  },
+  { "literals",    literalTerm,    true  },
+  { "comments",    commentTerm,    true  },
+  { "nesting",     nestingTerm,    true  },
+  { "operators",   operatorTerm,   false },
+};
+
+
+static Source generateCorpus(const Corpus* corpus, size_t size) {
+  Generator gen = { .chars=NULL, .names={}, .size=size, .lineStart=0,
+                    .state=0x9E3779B97F4A7C15ull
+                  };
+  for (int i = 0; i < VOCABULARY_SIZE; i++) {
+    appendName(&gen, &gen.names[i], randomInt(&gen, 1, 15));
+    sbufPush(gen.names[i], '\0');
+  }
+  sbufFit(gen.chars, size + 256);
+  corpus->term(&gen);
+  while (sbufLength(gen.chars) < gen.size) {
+    appendOperator(&gen, corpus->spaced);
+    corpus->term(&gen);
+  }
+  sbufPush(gen.chars, '\n');
+  sbufPush(gen.chars, '\0');
+
+  Source src = sourceFromString(gen.chars);
+  sbufFree(gen.chars);
+  for (int i = 0; i < VOCABULARY_SIZE; i++) {
+    sbufFree(gen.names[i]);
+  }
+  return src;
+}
+
+
+/******************************************* MEASURING *******************************************/
+
+
+/**
+ * **INTERNAL!** A `Measurement` is the result of a pass over a corpus.
+ *
+ * - **field:** `seconds`     - the time of the fastest run
+ * - **field:** `tokens`      - the number of tokens including the `TOKEN_EOF`
+ * - **field:** `allocations` - the number of allocations of a single run
+ * - **field:** `complete`    - whether the pass reached the end without errors
+ */
+typedef struct Measurement {
+  double seconds;
+  size_t tokens;
+  size_t allocations;
+  bool   complete;
+} Measurement;
+
+
+static double now() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+
+static Measurement lexOnce(const Source* src) {
+  Measurement m = { .seconds=0.0, .tokens=0, .allocations=g_allocations, .complete=true };
+  double start = now();
+  Lexer lexer = lexerFromSourceWith(src, TRIVIA_DROP);
+  Token token;
+  do {
+    token = nextToken(&lexer);
+    m.tokens++;
+    m.complete &= (token.kind != TOKEN_ERROR);
+  } while (token.kind != TOKEN_EOF);
+  deleteLexer(&lexer);
+  m.seconds = now() - start;
+  m.allocations = g_allocations - m.allocations;
+  return m;
+}
+
+
+static Measurement parseOnce(const Source* src) {
+  Measurement m = { .seconds=0.0, .tokens=0, .allocations=g_allocations, .complete=true };
+  double start = now();
+  ASTNode* node = parse(src);
+  m.seconds = now() - start;
+  m.allocations = g_allocations - m.allocations;
+  m.complete = (node->kind == AST_EXPR);
+  deleteNode(node);
+  return m;
+}
+
+
+/**
+ * Runs a pass until it took at least `MIN_SECONDS` and `MIN_REPETITIONS`. The first run only warms
+ * up the caches and the string interning.
+ */
+static Measurement measure(Measurement (*pass)(const Source*), const Source* src) {
+  Measurement best = pass(src);
+  best = pass(src);
+  double total = best.seconds;
+  for (int i = 1; i < MIN_REPETITIONS || total < MIN_SECONDS; i++) {
+    Measurement m = pass(src);
+    total += m.seconds;
+    if (m.seconds < best.seconds) {
+      best.seconds = m.seconds;
+    }
+  }
+  return best;
+}
+
+
+static void printResult(const char* corpus, const char* pass, size_t bytes, size_t tokens,
+                        Measurement m, bool last) {
+  printf("    { \"corpus\": \"%s\", \"pass\": \"%s\", \"bytes\": %zu, \"tokens\": %zu, "
+         "\"complete\": %s,\n", corpus, pass, bytes, tokens, m.complete ? "true" : "false");
+  printf("      \"seconds\": %.6f, \"mbPerSecond\": %.2f, \"tokensPerSecond\": %.0f, "
+         "\"nsPerToken\": %.2f, \"allocsPerToken\": %.4f }%s\n",
+         m.seconds, bytes / m.seconds / 1e6, tokens / m.seconds, m.seconds * 1e9 / tokens,
+         (double) m.allocations / tokens, last ? "" : ",");
+}
+
+
+static void* runBenchmarks(void* arg) {
+  size_t size = *(size_t*) arg;
+  size_t count = sizeof(corpora) / sizeof(corpora[0]);
+
+  printf("{\n");
+  printf("  \"revision\": \"%s\",\n", BENCH_REVISION);
+  printf("  \"compiler\": \"%s\",\n", __VERSION__);
+  printf("  \"corpusBytes\": %zu,\n", size);
+  printf("  \"results\": [\n");
+  for (size_t i = 0; i < count; i++) {
+    Source src = generateCorpus(&corpora[i], size);
+    size_t bytes = src.content.len;
+
+    Measurement lexed = measure(lexOnce, &src);
+    printResult(corpora[i].name, "lex", bytes, lexed.tokens, lexed, false);
+    Measurement parsed = measure(parseOnce, &src);
+    printResult(corpora[i].name, "parse", bytes, lexed.tokens, parsed, i + 1 == count);
+    fflush(stdout);
+
+    deleteSource(&src);
+    strinternFree();
+  }
+  printf("  ]\n");
+  printf("}\n");
+  return NULL;
+}
+
+
+int main(int argc, char** argv) {
+  size_t kib = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_CORPUS_KIB;
+  if (kib == 0) {
+    fprintf(stderr, "usage: %s [corpus size in KiB]\n", argv[0]);
+    return 1;
+  }
+  size_t size = kib * 1024;
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, BENCH_STACK_SIZE);
+  pthread_t thread;
+  if (pthread_create(&thread, &attr, runBenchmarks, &size) != 0) {
+    fprintf(stderr, "cannot create the benchmark thread\n");
+    return 1;
+  }
+  pthread_join(thread, NULL);
+  pthread_attr_destroy(&attr);
+  return 0;
+}
@@ -0,0 +1,304 @@
+#include "cache.h"
+
+#include "lexer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+#define TOKEN_FILE_MAGIC "IONTOK8"
+#define MIN_SLOTS 64
+
+
+/**
+ * **INTERNAL!** `PersistedHeader` precedes the token records in a persisted file. The hash and
+ * size are checked to detect collisions and outdated files.
+ */
+typedef struct PersistedHeader {
+  char     magic[8];
+  uint64_t hash;
+  uint64_t size;
+  uint64_t count;
+} PersistedHeader;
+
+
+/**
+ * **INTERNAL!** `PersistedToken` is a token without pointers, its characters are given by the
+ * offset and length within the source. The subkind is the token's keyword, symbol or error kind,
+ * the value is a literal's value or an error's caret.
+ */
+typedef struct PersistedToken {
+  uint64_t value;
+  uint32_t kind;
+  uint32_t subkind;
+  uint32_t offset;
+  uint32_t length;
+} PersistedToken;
+
+
+SourceCache createSourceCache(const char* directory) {
+  if (directory != NULL) {
+    mkdir(directory, 0755);  // fails harmlessly if the directory exists
+  }
+  return (SourceCache){ .entries=NULL, .slots=NULL, .slotCount=0,
+                        .directory=(directory ? strdup(directory) : NULL), .reads=0, .lexes=0
+                      };
+}
+
+
+/**
+ * Mixes in eight bytes at a time, which is much faster than a byte-wise hash like FNV for large
+ * files. The remaining bytes are zero-padded to a last word.
+ */
+uint64_t hashString(string s) {
+  const uint64_t prime = 0x9e3779b97f4a7c15ull;
+  uint64_t hash = 0xcbf29ce484222325ull ^ s.len;
+  size_t i = 0;
+  for (; i + 8 <= s.len; i += 8) {
+    uint64_t word;
+    memcpy(&word, s.chars + i, 8);
+    hash = (hash ^ word) * prime;
+    hash ^= hash >> 29;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, s.chars + i, s.len - i);
+  hash = (hash ^ tail) * prime;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+
+static string tokenFileName(const SourceCache* cache, uint64_t hash) {
+  return stringFromPrint("%s/%016llx.tok", cache->directory, (unsigned long long) hash);
+}
+
+
+/**
+ * A record is never trusted, it might be truncated, corrupted or written by another version. The
+ * bounds are compared in 64 bits, so that an offset near `UINT32_MAX` cannot wrap around.
+ */
+static bool validRecord(PersistedToken record, size_t size) {
+  if ((uint64_t) record.offset + record.length > size) {
+    return false;
+  }
+  switch (record.kind) {
+    case TOKEN_SYMBOL:
+      return record.subkind <= SYMBOL_TILDE;
+    case TOKEN_ERROR:
+      return record.subkind <= LEX_ERROR_SOURCE_SIZE;
+    default:
+      return record.kind <= TOKEN_SYMBOL && record.subkind <= KEYWORD_BLANK;
+  }
+}
+
+
+/**
+ * Any invalid record discards all tokens read so far, thus the file counts as a cache miss.
+ */
+static bool loadTokens(const SourceCache* cache, CacheEntry* entry) {
+  string fileName = tokenFileName(cache, entry->hash);
+  FILE* file = fopen(fileName.chars, "rb");
+  strFree(&fileName);
+  if (file == NULL) {
+    return false;
+  }
+
+  PersistedHeader header;
+  bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+            memcmp(header.magic, TOKEN_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+            header.hash == entry->hash && header.size == entry->source.content.len;
+  for (uint64_t i = 0; ok && i < header.count; i++) {
+    PersistedToken record;
+    ok = fread(&record, sizeof(record), 1, file) == 1 &&
+         validRecord(record, entry->source.content.len);
+    if (ok) {
+      const char* chars = entry->source.content.chars + record.offset;
+      Token token = { .kind=record.kind, .source=&entry->source,
+                      .chars=stringFromRange(chars, chars + record.length)
+                    };
+      if (record.kind == TOKEN_SYMBOL) {
+        token.symbol = record.subkind;
+      } else if (record.kind == TOKEN_INT || record.kind == TOKEN_FLOAT ||
+                 record.kind == TOKEN_STRING || record.kind == TOKEN_CHAR) {
+        token.value = record.value;
+      } else if (record.kind == TOKEN_ERROR) {
+        token.error = record.subkind;
+        token.caret = record.value;
+      } else {
+        token.keyword = record.subkind;
+      }
+      sbufPush(entry->tokens, token);
+    }
+  }
+  fclose(file);
+
+  if (!ok) {
+    sbufFree(entry->tokens);
+  }
+  return ok;
+}
+
+
+/**
+ * A source whose offsets do not fit into the 32-bit record fields is not persisted at all.
+ */
+static void storeTokens(const SourceCache* cache, const CacheEntry* entry) {
+  if (entry->source.content.len > UINT32_MAX) {
+    return;
+  }
+  string fileName = tokenFileName(cache, entry->hash);
+  FILE* file = fopen(fileName.chars, "wb");
+  if (file == NULL) {
+    strFree(&fileName);
+    return;
+  }
+
+  PersistedHeader header = { .magic=TOKEN_FILE_MAGIC, .hash=entry->hash,
+                             .size=entry->source.content.len, .count=sbufLength(entry->tokens) };
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  for (const Token* it = entry->tokens; ok && it != sbufEnd(entry->tokens); it++) {
+    uint32_t subkind = (it->kind == TOKEN_SYMBOL) ? it->symbol
+                     : (it->kind == TOKEN_ERROR)  ? it->error
+                     : it->keyword;
+    uint64_t value = (it->kind == TOKEN_ERROR) ? it->caret : it->value;
+    PersistedToken record = { .value=value, .kind=it->kind, .subkind=subkind,
+                              .offset=it->chars.chars - entry->source.content.chars,
+                              .length=it->chars.len };
+    ok = fwrite(&record, sizeof(record), 1, file) == 1;
+  }
+  fclose(file);
+
+  if (!ok) {
+    remove(fileName.chars);  // never leave a truncated file behind
+  }
+  strFree(&fileName);
+}
+
+
+/**
+ * Lexes the whole source. Error tokens are persisted as well, since their messages are rendered
+ * from the tokens on demand.
+ */
+static void lexTokens(SourceCache* cache, CacheEntry* entry) {
+  ++cache->lexes;
+  Lexer lexer = lexerFromSource(&entry->source);
+  Token token;
+  do {
+    token = nextToken(&lexer);
+    sbufPush(entry->tokens, token);
+  } while (token.kind != TOKEN_EOF);
+  deleteLexer(&lexer);
+
+  if (cache->directory != NULL) {
+    storeTokens(cache, entry);
+  }
+}
+
+
+static size_t findSlot(const SourceCache* cache, const uint32_t* slots, size_t count,
+                       const char* path) {
+  size_t mask = count - 1;
+  size_t slot = hashString(stringFromArray(path)) & mask;
+  while (slots[slot] != 0 && strcmp(cache->entries[slots[slot]-1]->path, path) != 0) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+
+static void growSlots(SourceCache* cache) {
+  size_t count = (cache->slotCount == 0) ? MIN_SLOTS : 2 * cache->slotCount;
+  uint32_t* slots = (uint32_t*) calloc(count, sizeof(uint32_t));
+  for (uint32_t i = 0; i < sbufLength(cache->entries); i++) {
+    slots[findSlot(cache, slots, count, cache->entries[i]->path)] = i + 1;
+  }
+  free(cache->slots);
+  cache->slots = slots;
+  cache->slotCount = count;
+}
+
+
+/**
+ * Returns the entry of the path, a new one is added if the path is unknown.
+ */
+static CacheEntry* entryFor(SourceCache* cache, const char* path) {
+  if (2 * (sbufLength(cache->entries) + 1) > cache->slotCount) {
+    growSlots(cache);
+  }
+  size_t slot = findSlot(cache, cache->slots, cache->slotCount, path);
+  if (cache->slots[slot] == 0) {
+    CacheEntry* entry = (CacheEntry*) calloc(1, sizeof(CacheEntry));
+    entry->path = strdup(path);
+    entry->mtime = -1;
+    sbufPush(cache->entries, entry);
+    cache->slots[slot] = sbufLength(cache->entries);
+  }
+  return cache->entries[cache->slots[slot]-1];
+}
+
+
+/**
+ * The cheap checks of modification time and size come first. Only if they fail, the file is read
+ * and its hash decides whether the tokens can be reused. Otherwise the tokens are loaded from the
+ * cache directory or lexed from scratch.
+ */
+const CacheEntry* cacheSource(SourceCache* cache, const char* path) {
+  CacheEntry* entry = entryFor(cache, path);
+
+  struct stat info;
+  if (stat(path, &info) != 0) {
+    sbufFree(entry->tokens);
+    deleteSource(&entry->source);
+    entry->source = sourceFromFile(path);  // generates the error message
+    entry->mtime = -1;
+    entry->size = 0;
+    entry->hash = 0;
+    return entry;
+  }
+
+  int64_t mtime = (int64_t) info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+  if (entry->mtime == mtime && entry->size == (size_t) info.st_size) {
+    return entry;
+  }
+
+  ++cache->reads;
+  Source source = sourceFromFile(path);
+  uint64_t hash = hashString(source.content);
+  entry->mtime = mtime;
+  entry->size = info.st_size;
+  if (source.status == SOURCE_OK && entry->source.status == SOURCE_OK && entry->tokens != NULL &&
+      entry->hash == hash && strequal(entry->source.content, source.content)) {
+    deleteSource(&source);  // only touched, the old source and tokens are still valid
+    return entry;
+  }
+
+  sbufFree(entry->tokens);
+  deleteSource(&entry->source);
+  entry->source = source;
+  entry->hash = hash;
+  if (source.status == SOURCE_OK &&
+      (cache->directory == NULL || !loadTokens(cache, entry))) {
+    lexTokens(cache, entry);
+  }
+  return entry;
+}
+
+
+void deleteSourceCache(SourceCache* cache) {
+  for (CacheEntry** it = cache->entries; it != sbufEnd(cache->entries); it++) {
+    sbufFree((*it)->tokens);
+    deleteSource(&(*it)->source);
+    free((*it)->path);
+    free(*it);
+  }
+  sbufFree(cache->entries);
+  free(cache->slots);
+  cache->slots = NULL;
+  cache->slotCount = 0;
+  free(cache->directory);
+  cache->directory = NULL;
+  cache->reads = 0;
+  cache->lexes = 0;
+}
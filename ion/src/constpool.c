@@ -0,0 +1,115 @@
+#include "constpool.h"
+
+#include "arena.h"
+#include "sbuffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+#define MIN_SLOTS 64
+
+
+/**
+ * **INTERNAL!** A slot holds the index of a constant plus one, thus `0` marks an empty slot. The
+ * table is at most half full.
+ */
+static SBUF(Number) constants = NULL;
+static uint32_t*    slots     = NULL;
+static size_t       slotCount = 0;
+static Arena        allocator = {};
+
+
+static uint64_t mix(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+
+static uint64_t hashNum(Number num) {
+  if (num.size == 0) {
+    return mix(num.value ^ (num.negative ? 0x9e3779b97f4a7c15ull : 0));
+  }
+  uint64_t hash = num.size;
+  for (uint32_t i = 0; i < num.size; i++) {
+    hash = mix(hash ^ num.limbs[i]);
+  }
+  return hash;
+}
+
+
+/**
+ * Normalized numbers are equal if their representations are.
+ */
+static bool equalNum(Number a, Number b) {
+  if (a.size != b.size || a.negative != b.negative) {
+    return false;
+  }
+  if (a.size == 0) {
+    return a.value == b.value;
+  }
+  return memcmp(a.limbs, b.limbs, a.size * sizeof(uint64_t)) == 0;
+}
+
+
+static size_t findSlot(const uint32_t* table, size_t count, Number num) {
+  size_t mask = count - 1;
+  size_t slot = hashNum(num) & mask;
+  while (table[slot] != 0 && !equalNum(constants[table[slot]-1], num)) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+
+static void growSlots() {
+  size_t count = (slotCount == 0) ? MIN_SLOTS : 2 * slotCount;
+  uint32_t* table = (uint32_t*) calloc(count, sizeof(uint32_t));
+  for (uint32_t i = 0; i < sbufLength(constants); i++) {
+    table[findSlot(table, count, constants[i])] = i + 1;
+  }
+  free(slots);
+  slots = table;
+  slotCount = count;
+}
+
+
+ConstIndex constIntern(Number num) {
+  if (2 * (sbufLength(constants) + 1) > slotCount) {
+    growSlots();
+  }
+  size_t slot = findSlot(slots, slotCount, num);
+  if (slots[slot] == 0) {
+    if (num.size > 0) {
+      uint64_t* limbs = (uint64_t*) arenaAlloc(&allocator, num.size * sizeof(uint64_t));
+      memcpy(limbs, num.limbs, num.size * sizeof(uint64_t));
+      num.limbs = limbs;
+    }
+    sbufPush(constants, num);
+    slots[slot] = sbufLength(constants);
+  }
+  return slots[slot] - 1;
+}
+
+
+Number constAt(ConstIndex index) {
+  return constants[index];
+}
+
+
+uint32_t constCount() {
+  return sbufLength(constants);
+}
+
+
+void constpoolFree() {
+  sbufFree(constants);
+  free(slots);
+  slots = NULL;
+  slotCount = 0;
+  arenaFree(&allocator);
+}
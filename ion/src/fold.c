@@ -0,0 +1,253 @@
+#include "fold.h"
+
+#include "sbuffer.h"
+
+#include <stdlib.h>
+
+
+#define RED "\e[31m"
+#define YEL "\e[33m"
+#define RST "\e[39m"
+
+
+/**
+ * **INTERNAL!** The folder carries the semantics of the integers through the tree.
+ */
+typedef struct Folder {
+  NumType  type;
+  Overflow mode;
+  int      diagnostics;
+} Folder;
+
+
+static bool isInt(const ASTNode* node) {
+  return node->kind == AST_EXPR && node->expr.kind == EXPR_INT;
+}
+
+
+static bool isOp(string op, char c) {
+  return op.len == 1 && op.chars[0] == c;
+}
+
+
+/**
+ * The messages of the deleted operand go up to the node, e.g. warnings of folded operands.
+ */
+static void deleteOperand(ASTNode* node, ASTNode* operand) {
+  for (size_t i = 0; i < sbufLength(operand->messages); i++) {
+    sbufPush(node->messages, operand->messages[i]);
+  }
+  sbufFree(operand->messages);
+  deleteNode(operand);
+}
+
+
+/**
+ * Turns the node into the folded value and deletes its operands.
+ */
+static void replaceByInt(ASTNode* node, ConstIndex constant) {
+  switch (node->expr.kind) {
+    case EXPR_PAREN:
+      deleteOperand(node, node->expr.expr);
+      break;
+    case EXPR_UNOP:
+      strFree(&node->expr.op);
+      deleteOperand(node, node->expr.rhs);
+      break;
+    case EXPR_BINOP:
+      strFree(&node->expr.op);
+      deleteOperand(node, node->expr.lhs);
+      deleteOperand(node, node->expr.rhs);
+      break;
+    default:
+      break;
+  }
+  node->expr.kind = EXPR_INT;
+  node->expr.constant = constant;
+}
+
+
+/**
+ * Moves the unfolded expression into a new faulty node, thus the node stays the root of its
+ * subtree and turns into the error.
+ */
+static void reportError(Folder* folder, ASTNode* node, string message) {
+  ASTNode* faulty = (ASTNode*) malloc(sizeof(ASTNode));
+  *faulty = *node;
+  faulty->messages = NULL;
+  node->kind = AST_ERROR;
+  node->faultyNode = faulty;
+  sbufPush(node->messages, message);
+  folder->diagnostics++;
+}
+
+
+static string overflowMessage(const Folder* folder, Number value) {
+  uint64_t* scratch = NULL;  // only a trapped result can be too large to be inline
+  if (value.size > 0) {
+    scratch = (uint64_t*) malloc(NUM_DEC_SCRATCH(value) * sizeof(uint64_t));
+  }
+  size_t length = toDecString(value, NULL, 0, false, scratch);
+  char* digits = (char*) malloc(length + 1);
+  toDecString(value, digits, length + 1, false, scratch);
+  free(scratch);
+  char sign = folder->type.isSigned ? 'i' : 'u';
+  unsigned int bits = folder->type.bits;
+  string message;
+  switch (folder->mode) {
+    case OVERFLOW_WRAP:
+      message = stringFromPrint(YEL "Warning:" RST " overflow of %c%u, wrapped to %s\n",
+                                sign, bits, digits);
+      break;
+    case OVERFLOW_SATURATE:
+      message = stringFromPrint(YEL "Warning:" RST " overflow of %c%u, saturated to %s\n",
+                                sign, bits, digits);
+      break;
+    case OVERFLOW_TRAP:
+      message = stringFromPrint(RED "Error:" RST " overflow, %s does not fit into %c%u\n",
+                                digits, sign, bits);
+      break;
+  }
+  free(digits);
+  return message;
+}
+
+
+/**
+ * A trapped overflow keeps the expression, any other result is folded.
+ */
+static void foldResult(Folder* folder, ASTNode* node, Number value, bool overflow) {
+  if (overflow && folder->mode == OVERFLOW_TRAP) {
+    reportError(folder, node, overflowMessage(folder, value));
+    return;
+  }
+  replaceByInt(node, constIntern(value));
+  if (overflow) {
+    sbufPush(node->messages, overflowMessage(folder, value));
+    folder->diagnostics++;
+  }
+}
+
+
+/**
+ * A literal takes the type like any folded value, thus `300` and `300 + 0` agree.
+ */
+static void foldLiteral(Folder* folder, ASTNode* node) {
+  bool overflow = false;
+  Number value = toFixed(constAt(node->expr.constant), folder->type, folder->mode, &overflow);
+  if (overflow) {
+    foldResult(folder, node, value, overflow);
+  }
+}
+
+
+/**
+ * The bitwise complement never overflows, it flips all bits of the type. Any other result is
+ * checked against the type like a binary one.
+ */
+static void foldUnop(Folder* folder, ASTNode* node) {
+  Number a = constAt(node->expr.rhs->expr.constant);
+  string op = node->expr.op;
+  bool overflow = false;
+  Number value;
+  if (isOp(op, '+')) {
+    value = toFixed(a, folder->type, folder->mode, &overflow);
+  } else if (isOp(op, '-')) {
+    value = negFixed(a, folder->type, folder->mode, &overflow);
+  } else if (isOp(op, '~')) {
+    value = toFixed(sub(numFromInt(-1), a), folder->type, OVERFLOW_WRAP, NULL);
+  } else if (isOp(op, '!')) {
+    value = toFixed(numFromInt(compare(a, numFromInt(0)) == 0), folder->type, folder->mode,
+                    &overflow);
+  } else {
+    return;
+  }
+  foldResult(folder, node, value, overflow);
+}
+
+
+/**
+ * Only the quotient `MIN / -1` of a signed type overflows, a remainder always fits.
+ */
+static void foldBinop(Folder* folder, ASTNode* node) {
+  Number a = constAt(node->expr.lhs->expr.constant);
+  Number b = constAt(node->expr.rhs->expr.constant);
+  string op = node->expr.op;
+  NumType type = folder->type;
+  Overflow mode = folder->mode;
+  bool overflow = false;
+  Number value;
+  if (isOp(op, '+')) {
+    value = addFixed(a, b, type, mode, &overflow);
+  } else if (isOp(op, '-')) {
+    value = subFixed(a, b, type, mode, &overflow);
+  } else if (isOp(op, '*')) {
+    value = mulFixed(a, b, type, mode, &overflow);
+  } else if (isOp(op, '/') || isOp(op, '%')) {
+    if (compare(b, numFromInt(0)) == 0) {
+      reportError(folder, node, stringFromPrint(RED "Error:" RST " division by zero\n"));
+      return;
+    }
+    value = isOp(op, '/') ? divide(a, b) : modulo(a, b);
+    value = toFixed(value, type, mode, &overflow);
+  } else {
+    return;
+  }
+  foldResult(folder, node, value, overflow);
+}
+
+
+/**
+ * Folds the operands first, such that a whole constant subtree collapses bottom up.
+ */
+static void foldNode(Folder* folder, ASTNode* node) {
+  switch (node->kind) {
+    case AST_NONE:
+      return;
+
+    case AST_ERROR:
+      foldNode(folder, node->faultyNode);
+      return;
+
+    case AST_EXPR:
+      break;
+  }
+
+  switch (node->expr.kind) {
+    case EXPR_INT:
+      foldLiteral(folder, node);
+      break;
+
+    case EXPR_PAREN:
+      foldNode(folder, node->expr.expr);
+      if (isInt(node->expr.expr)) {
+        replaceByInt(node, node->expr.expr->expr.constant);
+      }
+      break;
+
+    case EXPR_UNOP:
+      foldNode(folder, node->expr.rhs);
+      if (isInt(node->expr.rhs)) {
+        foldUnop(folder, node);
+      }
+      break;
+
+    case EXPR_BINOP:
+      foldNode(folder, node->expr.lhs);
+      foldNode(folder, node->expr.rhs);
+      if (isInt(node->expr.lhs) && isInt(node->expr.rhs)) {
+        foldBinop(folder, node);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+int foldConstants(ASTNode* node, NumType type, Overflow mode) {
+  Folder folder = { .type=type, .mode=mode, .diagnostics=0 };
+  foldNode(&folder, node);
+  return folder.diagnostics;
+}
@@ -30,6 +30,8 @@ static void printErrors(const ASTNode* node) {
           break;
         case EXPR_INT:
           break;
+        case EXPR_FLOAT:
+          break;
         case EXPR_UNOP:
           printErrors(node->expr.rhs);
           break;
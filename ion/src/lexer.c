@@ -2,10 +2,13 @@
 
 #include "str.h"
 #include "error.h"
+#include "simd.h"
+#include "floating.h"
 
-#include <ctype.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 
 #define RED "\e[31m"
@@ -15,52 +18,233 @@
 
 
 Lexer lexerFromSource(const Source* src) {
-  return (Lexer){ .source=src, .index=0, .currentChar='\0',
-                  .currentLoc=loc(0, 0), .nextLoc=loc(1, 1)
+  return lexerFromSourceWith(src, TRIVIA_TOKENS);
+}
+
+
+Lexer lexerFromSourceWith(const Source* src, TriviaMode mode) {
+  return (Lexer){ .source=src, .stream=NULL, .index=0, .mark=0, .currentChar='\0', .errors=NULL,
+                  .triviaMode=mode, .trivia=NULL
                 };
 }
 
 
-static bool isKeyword(string s) {
-  return cstrequal(s, "if") ||
-         cstrequal(s, "else") ||
-         cstrequal(s, "do") ||
-         cstrequal(s, "while") ||
-         cstrequal(s, "for") ||
-         cstrequal(s, "switch") ||
-         cstrequal(s, "case") ||
-         cstrequal(s, "break") ||
-         cstrequal(s, "continue") ||
-         cstrequal(s, "return") ||
-         cstrequal(s, "true") ||
-         cstrequal(s, "false") ||
-         cstrequal(s, "var") ||
-         cstrequal(s, "const") ||
-         cstrequal(s, "func") ||
-         cstrequal(s, "struct") ||
-         cstrequal(s, "_");
+Lexer lexerFromOffset(const Source* src, size_t offset) {
+  Lexer lexer = lexerFromSource(src);
+  lexer.index = offset;
+  lexer.mark = offset;
+  return lexer;
 }
 
 
-static char nextChar(Lexer* lexer) {
-  lexer->currentChar = lexer->source->content.chars[lexer->index];
-  if (lexer->index < lexer->source->content.len) {
-    lexer->index++;
+Lexer lexerFromStream(SourceStream* stream) {
+  Lexer lexer = lexerFromSource(&stream->window);
+  lexer.stream = stream;
+  return lexer;
+}
+
+
+void deleteLexer(Lexer* lexer) {
+  sbufFree(lexer->errors);
+  sbufFree(lexer->trivia);
+}
+
+
+/**
+ * **INTERNAL!** `KEYWORD_HASH()` is a perfect hash of the keywords. It only needs the length and
+ * the first and last character of a name. The factors were chosen such that no two keywords
+ * collide, the table below is filled at compile time. As a string literal is no constant
+ * expression, an entry is given the first and last character explicitly. If a keyword is added and
+ * collides, the designated initializers override each other and the test of the keywords fails.
+ */
+#define KEYWORD_HASH(first, last, length) \
+        (((unsigned char) (first) + 10 * (unsigned char) (last) + 2 * (length)) & 31)
+
+#define KEYWORD_ENTRY(first, last, s, kw) \
+        [KEYWORD_HASH(first, last, sizeof(s) - 1)] = { s, sizeof(s) - 1, kw }
+
+
+/**
+ * **INTERNAL!** `KeywordEntry` is a slot of the keyword table. Empty slots have the length `0`.
+ */
+typedef struct KeywordEntry {
+  const char* chars;
+  int         length;
+  Keyword     keyword;
+} KeywordEntry;
+
+
+static const KeywordEntry keywordTable[32] = {
+  KEYWORD_ENTRY('i', 'f', "if",       KEYWORD_IF),
+  KEYWORD_ENTRY('e', 'e', "else",     KEYWORD_ELSE),
+  KEYWORD_ENTRY('d', 'o', "do",       KEYWORD_DO),
+  KEYWORD_ENTRY('w', 'e', "while",    KEYWORD_WHILE),
+  KEYWORD_ENTRY('f', 'r', "for",      KEYWORD_FOR),
+  KEYWORD_ENTRY('s', 'h', "switch",   KEYWORD_SWITCH),
+  KEYWORD_ENTRY('c', 'e', "case",     KEYWORD_CASE),
+  KEYWORD_ENTRY('b', 'k', "break",    KEYWORD_BREAK),
+  KEYWORD_ENTRY('c', 'e', "continue", KEYWORD_CONTINUE),
+  KEYWORD_ENTRY('r', 'n', "return",   KEYWORD_RETURN),
+  KEYWORD_ENTRY('t', 'e', "true",     KEYWORD_TRUE),
+  KEYWORD_ENTRY('f', 'e', "false",    KEYWORD_FALSE),
+  KEYWORD_ENTRY('v', 'r', "var",      KEYWORD_VAR),
+  KEYWORD_ENTRY('c', 't', "const",    KEYWORD_CONST),
+  KEYWORD_ENTRY('f', 'c', "func",     KEYWORD_FUNC),
+  KEYWORD_ENTRY('s', 't', "struct",   KEYWORD_STRUCT),
+  KEYWORD_ENTRY('_', '_', "_",        KEYWORD_BLANK),
+};
+
+
+/**
+ * One table probe and one comparison tell whether a name is a keyword.
+ */
+static Keyword findKeyword(const char* chars, int length) {
+  const KeywordEntry* entry = &keywordTable[KEYWORD_HASH(chars[0], chars[length-1], length)];
+  if (entry->length == length && memcmp(entry->chars, chars, length) == 0) {
+    return entry->keyword;
   }
+  return KEYWORD_NONE;
+}
+
+
+/**
+ * **INTERNAL!** The flags of `charClass` classify every byte, such that each scanning loop needs a
+ * single table lookup per character instead of a chain of comparisons or a call into ctype.
+ */
+enum CharClass {
+  CHAR_IDENT      = 1 << 0,  // a-z A-Z _ 0-9
+  CHAR_ALPHA      = 1 << 1,  // a-z A-Z
+  CHAR_DIGIT      = 1 << 2,  // 0-9
+  CHAR_HEX        = 1 << 3,  // 0-9 a-f A-F
+  CHAR_BIN        = 1 << 4,  // 0-1
+  CHAR_UNDERSCORE = 1 << 5,  // _
+  CHAR_SPACE      = 1 << 6,  // ' ' \t \r \n
+};
+
+
+static const uint8_t charClass[256] = {
+  [' ']  = CHAR_SPACE,  ['\t'] = CHAR_SPACE,  ['\r'] = CHAR_SPACE,  ['\n'] = CHAR_SPACE,
+  ['0' ... '1'] = CHAR_IDENT | CHAR_DIGIT | CHAR_HEX | CHAR_BIN,
+  ['2' ... '9'] = CHAR_IDENT | CHAR_DIGIT | CHAR_HEX,
+  ['a' ... 'f'] = CHAR_IDENT | CHAR_ALPHA | CHAR_HEX,
+  ['A' ... 'F'] = CHAR_IDENT | CHAR_ALPHA | CHAR_HEX,
+  ['g' ... 'z'] = CHAR_IDENT | CHAR_ALPHA,
+  ['G' ... 'Z'] = CHAR_IDENT | CHAR_ALPHA,
+  ['_']  = CHAR_IDENT | CHAR_UNDERSCORE,
+};
+
+
+/**
+ * **INTERNAL!** `TokenStart` tells by the first character how a token has to be scanned. The
+ * dense values let the compiler turn the dispatch in `nextToken()` into a jump table.
+ */
+typedef enum TokenStart {
+  START_ILLEGAL = 0,
+  START_EOF,
+  START_NAME,
+  START_ZERO,
+  START_DIGIT,
+  START_SYMBOL,
+  START_SLASH,
+  START_STRING,
+  START_CHAR,
+} TokenStart;
+
+
+static const uint8_t startTable[256] = {
+  ['\0'] = START_EOF,
+  ['a' ... 'z'] = START_NAME,  ['A' ... 'Z'] = START_NAME,  ['_'] = START_NAME,
+  ['0'] = START_ZERO,  ['1' ... '9'] = START_DIGIT,
+  ['('] = START_SYMBOL,  [')'] = START_SYMBOL,  ['['] = START_SYMBOL,  [']'] = START_SYMBOL,
+  ['{'] = START_SYMBOL,  ['}'] = START_SYMBOL,  [','] = START_SYMBOL,  [';'] = START_SYMBOL,
+  [':'] = START_SYMBOL,  ['.'] = START_SYMBOL,  ['!'] = START_SYMBOL,  ['='] = START_SYMBOL,
+  ['<'] = START_SYMBOL,  ['>'] = START_SYMBOL,  ['&'] = START_SYMBOL,  ['|'] = START_SYMBOL,
+  ['+'] = START_SYMBOL,  ['-'] = START_SYMBOL,  ['*'] = START_SYMBOL,  ['%'] = START_SYMBOL,
+  ['^'] = START_SYMBOL,  ['~'] = START_SYMBOL,
+  ['/'] = START_SLASH,
+  ['"'] = START_STRING,  ['\''] = START_CHAR,
+};
+
+
+/**
+ * **INTERNAL!** `escapeTable` maps the character after a backslash to the escaped byte. The high
+ * bit marks the valid escapes, as `'\0'` escapes to zero. The hex escape `\x` is decoded apart.
+ */
+#define ESCAPE(c) (0x100 | (unsigned char) (c))
+
+static const uint16_t escapeTable[256] = {
+  ['n'] = ESCAPE('\n'),  ['t'] = ESCAPE('\t'),  ['r'] = ESCAPE('\r'),  ['0'] = ESCAPE('\0'),
+  ['\\'] = ESCAPE('\\'),  ['\''] = ESCAPE('\''),  ['"'] = ESCAPE('"'),
+};
+
+
+/**
+ * **INTERNAL!** `SymbolEntry` is an entry of the maximal munch table of the symbols. All symbols
+ * have at most two characters, so for every first character the table stores the symbol made of
+ * this character, the character that extends it (or `'\0'`) and the extended symbol.
+ */
+typedef struct SymbolEntry {
+  Symbol single;
+  char   extension;
+  Symbol extended;
+} SymbolEntry;
+
+
+static const SymbolEntry symbolTable[256] = {
+  ['('] = { SYMBOL_LPAREN },     [')'] = { SYMBOL_RPAREN },
+  ['['] = { SYMBOL_LBRACKET },   [']'] = { SYMBOL_RBRACKET },
+  ['{'] = { SYMBOL_LBRACE },     ['}'] = { SYMBOL_RBRACE },
+  [','] = { SYMBOL_COMMA },      [';'] = { SYMBOL_SEMICOLON },
+  [':'] = { SYMBOL_COLON },      ['.'] = { SYMBOL_DOT },
+  ['+'] = { SYMBOL_PLUS },       ['*'] = { SYMBOL_STAR },
+  ['/'] = { SYMBOL_SLASH },      ['%'] = { SYMBOL_PERCENT },
+  ['^'] = { SYMBOL_CARET },      ['~'] = { SYMBOL_TILDE },
+  ['!'] = { SYMBOL_NOT,     '=', SYMBOL_NOT_EQUAL },
+  ['='] = { SYMBOL_ASSIGN,  '=', SYMBOL_EQUAL },
+  ['<'] = { SYMBOL_LESS,    '=', SYMBOL_LESS_EQUAL },
+  ['>'] = { SYMBOL_GREATER, '=', SYMBOL_GREATER_EQUAL },
+  ['&'] = { SYMBOL_AND,     '&', SYMBOL_LOGICAL_AND },
+  ['|'] = { SYMBOL_OR,      '|', SYMBOL_LOGICAL_OR },
+  ['-'] = { SYMBOL_MINUS,   '>', SYMBOL_ARROW },
+};
 
-  lexer->currentLoc = lexer->nextLoc;
-  if (lexer->currentChar == '\n') {
-    lexer->nextLoc.line++;
-    lexer->nextLoc.pos = 1;
-  } else if (lexer->currentChar != '\0') {
-    lexer->nextLoc.pos++;
+
+/**
+ * Reads the next chunk if the lexer reached the end of the stream's window. Everything before the
+ * current token's first character is dropped, so the indices must be shifted.
+ */
+static void refill(Lexer* lexer) {
+  if (lexer->index >= lexer->source->content.len && lexer->stream != NULL) {
+    size_t dropped = streamRefill(lexer->stream, lexer->mark);
+    lexer->index -= dropped;
+    lexer->mark -= dropped;
   }
+}
+
+
+/**
+ * **INTERNAL!** `MAX_LOOKAHEAD` is the number of characters the lexer may read past the end of a
+ * token to decide where the token ends.
+ */
+#define MAX_LOOKAHEAD 3
+
 
+/**
+ * The content is not required to be terminated by `'\0'`, a lexer may also read a single line.
+ */
+static char nextChar(Lexer* lexer) {
+  refill(lexer);
+  if (lexer->index < lexer->source->content.len) {
+    lexer->currentChar = lexer->source->content.chars[lexer->index++];
+  } else {
+    lexer->currentChar = '\0';
+  }
   return lexer->currentChar;
 }
 
 
 static char peekChar(Lexer* lexer) {
+  refill(lexer);
   if (lexer->index < lexer->source->content.len) {
     return lexer->source->content.chars[lexer->index];
   } else {
@@ -69,49 +253,492 @@ static char peekChar(Lexer* lexer) {
 }
 
 
-Token nextToken(Lexer* lexer) {
-  Token token = (Token){ .kind=TOKEN_NONE, .source=lexer->source,
-                         .start=loc(0, 0), .end=loc(0, 0), .chars=stringFromArray("") };
-  for (char c = peekChar(lexer);
-       c == ' ' || c == '\t' || c == '\r' || c == '\n';
-       c = peekChar(lexer)) {
+/**
+ * The scan functions below return the end of a run of characters starting at `index`. They only
+ * look at the given characters, thus the caller has to refill the stream's window if the run
+ * reaches the end. Each kernel tests a whole SIMD block at once and handles the rest byte by byte.
+ */
+static int scanClass(const char* chars, int index, int length, uint8_t mask) {
+  while (index < length && (charClass[(unsigned char) chars[index]] & mask)) {
+    index++;
+  }
+  return index;
+}
+
+
+static int scanIdentifier(const char* chars, int index, int length) {
+#ifdef SIMD_WIDTH
+  for (; index + SIMD_WIDTH <= length; index += SIMD_WIDTH) {
+    SimdBlock block = simdLoad(chars + index);
+    SimdBlock folded = simdOr(block, simdSet(0x20));  // maps upper case to lower case letters
+    SimdBlock letters = simdAnd(simdGreater(folded, simdSet('a' - 1)),
+                                simdGreater(simdSet('z' + 1), folded));
+    SimdBlock digits = simdAnd(simdGreater(block, simdSet('0' - 1)),
+                               simdGreater(simdSet('9' + 1), block));
+    uint32_t ident = simdMask(simdOr(simdOr(letters, digits), simdEqual(block, simdSet('_'))));
+    if (ident != SIMD_ALL) {
+      return index + __builtin_ctz(~ident);
+    }
+  }
+#endif
+  return scanClass(chars, index, length, CHAR_IDENT);
+}
+
+
+static int scanLine(const char* chars, int index, int length) {
+#ifdef SIMD_WIDTH
+  for (; index + SIMD_WIDTH <= length; index += SIMD_WIDTH) {
+    uint32_t newlines = simdMask(simdEqual(simdLoad(chars + index), simdSet('\n')));
+    if (newlines != 0) {
+      return index + __builtin_ctz(newlines);
+    }
+  }
+#endif
+  while (index < length && chars[index] != '\n') {
+    index++;
+  }
+  return index;
+}
+
+
+static int scanWhitespace(const char* chars, int index, int length) {
+#ifdef SIMD_WIDTH
+  for (; index + SIMD_WIDTH <= length; index += SIMD_WIDTH) {
+    SimdBlock block = simdLoad(chars + index);
+    SimdBlock blanks = simdOr(simdEqual(block, simdSet(' ')), simdEqual(block, simdSet('\t')));
+    SimdBlock breaks = simdOr(simdEqual(block, simdSet('\r')), simdEqual(block, simdSet('\n')));
+    uint32_t others = ~simdMask(simdOr(blanks, breaks)) & SIMD_ALL;
+    if (others != 0) {
+      return index + __builtin_ctz(others);
+    }
+  }
+#endif
+  return scanClass(chars, index, length, CHAR_SPACE);
+}
+
+
+/**
+ * Stops at the first `'*'` followed by a `'/'` or at `end`. The character at `end` is read to test
+ * for the `'/'`, but not consumed.
+ */
+static int scanBlockComment(const char* chars, int index, int end) {
+#ifdef SIMD_WIDTH
+  for (; index + SIMD_WIDTH <= end; index += SIMD_WIDTH) {
+    uint32_t closing = simdMask(simdAnd(simdEqual(simdLoad(chars + index), simdSet('*')),
+                                        simdEqual(simdLoad(chars + index + 1), simdSet('/'))));
+    if (closing != 0) {
+      return index + __builtin_ctz(closing);
+    }
+  }
+#endif
+  while (index < end && !(chars[index] == '*' && chars[index+1] == '/')) {
+    index++;
+  }
+  return index;
+}
+
+
+/**
+ * Stops at the closing quote, a backslash or a newline, as literals cannot span lines.
+ */
+static int scanQuoted(const char* chars, int index, int length, char quote) {
+#ifdef SIMD_WIDTH
+  for (; index + SIMD_WIDTH <= length; index += SIMD_WIDTH) {
+    SimdBlock block = simdLoad(chars + index);
+    SimdBlock quotes = simdOr(simdEqual(block, simdSet(quote)), simdEqual(block, simdSet('\\')));
+    uint32_t stops = simdMask(simdOr(quotes, simdEqual(block, simdSet('\n'))));
+    if (stops != 0) {
+      return index + __builtin_ctz(stops);
+    }
+  }
+#endif
+  while (index < length && chars[index] != quote && chars[index] != '\\' && chars[index] != '\n') {
+    index++;
+  }
+  return index;
+}
+
+
+/**
+ * Consumes the characters up to `end`. Returns `true` if the run reached the end of the stream's
+ * window and the next chunk was read, thus the run must be continued.
+ */
+static bool consumeRun(Lexer* lexer, int end) {
+  if (end > lexer->index) {
+    lexer->currentChar = lexer->source->content.chars[end-1];
+    lexer->index = end;
+  }
+
+  if (end < lexer->source->content.len || lexer->stream == NULL) {
+    return false;
+  }
+  refill(lexer);
+  return lexer->index < lexer->source->content.len;
+}
+
+
+/**
+ * Returns the offset of an index relative to the whole input.
+ */
+static size_t inputOffset(const Lexer* lexer, int index) {
+  return (lexer->stream != NULL) ? lexer->stream->offset + index : index;
+}
+
+
+/**
+ * Consumes all characters whose class matches the mask.
+ */
+static void skipWhile(Lexer* lexer, uint8_t mask) {
+  int end;
+  do {
+    const char* chars = lexer->source->content.chars;
+    int length = lexer->source->content.len;
+    end = (mask == CHAR_IDENT) ? scanIdentifier(chars, lexer->index, length)
+                               : scanClass(chars, lexer->index, length, mask);
+  } while (consumeRun(lexer, end));
+}
+
+
+/**
+ * Consumes all characters up to the end of the line, the newline is not consumed.
+ */
+static void skipLine(Lexer* lexer) {
+  int end;
+  do {
+    end = scanLine(lexer->source->content.chars, lexer->index, lexer->source->content.len);
+  } while (consumeRun(lexer, end));
+}
+
+
+/**
+ * Consumes all whitespace characters. Consumed whitespace is not part of a token, thus the mark is
+ * moved along and a refill can drop it. The current character is not updated, since the next call
+ * of `nextChar()` overwrites it anyway.
+ */
+static void skipWhitespace(Lexer* lexer) {
+  while (true) {
+    lexer->index = scanWhitespace(lexer->source->content.chars, lexer->index,
+                                  lexer->source->content.len);
+    lexer->mark = lexer->index;
+
+    if (lexer->index < lexer->source->content.len || lexer->stream == NULL) {
+      return;
+    }
+    refill(lexer);
+    if (lexer->index >= lexer->source->content.len) {
+      return;
+    }
+  }
+}
+
+
+/**
+ * Consumes a multi-line comment after its opening characters including the closing ones. The kernel
+ * never consumes the last character of the window, which is read by `nextChar()` instead. So a
+ * `'*'` at the end of a chunk is still matched with a `'/'` in the next chunk. Returns `false` if
+ * the comment is unclosed.
+ */
+static bool skipBlockComment(Lexer* lexer) {
+  while (peekChar(lexer) != '\0') {  // refills the window if necessary
+    lexer->index = scanBlockComment(lexer->source->content.chars, lexer->index,
+                                    lexer->source->content.len - 1);
+    if (nextChar(lexer) == '*' && peekChar(lexer) == '/') {
+      nextChar(lexer);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+static uint8_t hexDigit(char c) {
+  return (c & 0x0F) + 9 * ((unsigned char) c >> 6);  // letters have bit 6 set
+}
+
+
+/**
+ * Consumes an escape sequence after its backslash and stores the escaped byte. Returns `false` if
+ * the sequence is invalid, the erroneous character is then the next one and not consumed.
+ */
+static bool lexEscape(Lexer* lexer, uint64_t* value) {
+  char c = peekChar(lexer);
+  if (c != 'x') {
+    uint16_t escaped = escapeTable[(unsigned char) c];
+    if (escaped == 0) {
+      return false;
+    }
+    nextChar(lexer);
+    *value = escaped & 0xFF;
+    return true;
+  }
+
+  nextChar(lexer);
+  uint64_t v = 0;
+  for (int i = 0; i < 2; i++) {
+    c = peekChar(lexer);
+    if (!(charClass[(unsigned char) c] & CHAR_HEX)) {
+      return false;
+    }
+    v = (v << 4) | hexDigit(nextChar(lexer));
+  }
+  *value = v;
+  return true;
+}
+
+
+/**
+ * Consumes the characters of a literal up to and including the closing quote. The runs between
+ * escape sequences are skipped by the kernel. Each escape sequence is validated and the number of
+ * characters it saves when decoded is added to `saved`. The first invalid escape sequence turns
+ * the token into an error. Returns `false` if the line or the input ends before the closing quote.
+ */
+static bool skipQuoted(Lexer* lexer, char quote, Token* token, size_t* saved) {
+  while (true) {
+    int end;
+    do {
+      end = scanQuoted(lexer->source->content.chars, lexer->index, lexer->source->content.len,
+                       quote);
+    } while (consumeRun(lexer, end));
+
+    char c = peekChar(lexer);
+    if (c == quote) {
+      nextChar(lexer);
+      return true;
+    } else if (c != '\\') {
+      return false;
+    }
+
+    nextChar(lexer);
+    *saved += (peekChar(lexer) == 'x') ? 3 : 1;
+    uint64_t value;
+    if (!lexEscape(lexer, &value) && token->kind != TOKEN_ERROR) {
+      token->kind = TOKEN_ERROR;
+      token->caret = lexer->index - lexer->mark;
+      token->error = LEX_ERROR_INVALID_ESCAPE;
+    }
+  }
+}
+
+
+/**
+ * Consumes a UTF-8 encoded character and returns its code point. Sources are valid UTF-8, thus
+ * the first byte tells the number of continuation bytes.
+ */
+static uint64_t lexCodePoint(Lexer* lexer) {
+  unsigned char c = nextChar(lexer);
+  if (c < 0x80) {
+    return c;
+  }
+  int more = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : 1;
+  uint64_t v = c & (0x3F >> more);
+  for (; more > 0 && ((unsigned char) peekChar(lexer) & 0xC0) == 0x80; more--) {
+    v = (v << 6) | (nextChar(lexer) & 0x3F);
+  }
+  return v;
+}
+
+
+/**
+ * The value functions below compute the value of an integer literal's digits between `chars` and
+ * `end`, which were already validated by the scanner and may only contain digits and underscores.
+ * Eight characters are loaded into a word at once. If none of them is an underscore, all eight
+ * digits are combined by a few multiplications and shifts (SWAR), otherwise the word is processed
+ * digit by digit. The words are loaded in little endian order, the first digit being the lowest
+ * byte. Return `false` if the value exceeds 64 bits.
+ */
+#define BYTES(b) (0x0101010101010101ull * (uint8_t) (b))
+
+
+static uint64_t loadWord(const char* chars) {
+  uint64_t word;
+  memcpy(&word, chars, sizeof(word));
+  return word;
+}
+
+
+static bool hasUnderscore(uint64_t word) {
+  uint64_t x = word ^ BYTES('_');  // underscores become zero bytes
+  return ((x - BYTES(0x01)) & ~x & BYTES(0x80)) != 0;
+}
+
+
+static bool decimalValue(const char* chars, const char* end, uint64_t* value) {
+  uint64_t v = 0;
+  while (chars < end) {
+    if (end - chars >= 8 && !hasUnderscore(loadWord(chars))) {
+      uint64_t word = loadWord(chars) - BYTES('0');
+      word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FF;  // pairs of digits
+      word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFF;  // groups of four digits
+      word = (word * 10000 + (word >> 32)) & 0x00000000FFFFFFFF;
+      if (__builtin_mul_overflow(v, 100000000, &v) || __builtin_add_overflow(v, word, &v)) {
+        return false;
+      }
+      chars += 8;
+    } else if (*chars++ != '_') {
+      if (__builtin_mul_overflow(v, 10, &v) || __builtin_add_overflow(v, chars[-1] - '0', &v)) {
+        return false;
+      }
+    }
+  }
+  *value = v;
+  return true;
+}
+
+
+static bool hexValue(const char* chars, const char* end, uint64_t* value) {
+  uint64_t v = 0;
+  while (chars < end) {
+    if (end - chars >= 8 && !hasUnderscore(loadWord(chars))) {
+      uint64_t word = loadWord(chars);
+      word = (word & BYTES(0x0F)) + 9 * ((word >> 6) & BYTES(0x01));  // letters have bit 6 set
+      word = __builtin_bswap64(word);  // the first digit becomes the highest byte
+      word = (word | (word >> 4)) & 0x00FF00FF00FF00FF;
+      word = (word | (word >> 8)) & 0x0000FFFF0000FFFF;
+      word = (word | (word >> 16)) & 0x00000000FFFFFFFF;
+      if (v >> 32 != 0) {
+        return false;
+      }
+      v = (v << 32) | word;
+      chars += 8;
+    } else if (*chars++ != '_') {
+      if (v >> 60 != 0) {
+        return false;
+      }
+      v = (v << 4) | ((chars[-1] & 0x0F) + 9 * (chars[-1] >> 6));
+    }
+  }
+  *value = v;
+  return true;
+}
+
+
+static bool binaryValue(const char* chars, const char* end, uint64_t* value) {
+  uint64_t v = 0;
+  while (chars < end) {
+    if (end - chars >= 8 && !hasUnderscore(loadWord(chars))) {
+      uint64_t word = loadWord(chars) & BYTES(0x01);
+      word = (word * 0x8040201008040201) >> 56;  // gathers the bits in the highest byte
+      if (v >> 56 != 0) {
+        return false;
+      }
+      v = (v << 8) | word;
+      chars += 8;
+    } else if (*chars++ != '_') {
+      if (v >> 63 != 0) {
+        return false;
+      }
+      v = (v << 1) | (chars[-1] - '0');
+    }
+  }
+  *value = v;
+  return true;
+}
+
+
+/**
+ * Consumes a `'.'` and the digits of a fraction. The `'.'` is only part of a number if a digit
+ * follows, otherwise it is put back. A refill never drops it, as it is part of the current token.
+ */
+static bool lexFraction(Lexer* lexer, uint8_t digits) {
+  if (peekChar(lexer) != '.') {
+    return false;
+  }
+  nextChar(lexer);
+  if (!(charClass[(unsigned char) peekChar(lexer)] & digits)) {
+    lexer->index--;
+    return false;
+  }
+  skipWhile(lexer, digits | CHAR_UNDERSCORE);
+  return true;
+}
+
+
+/**
+ * Consumes an exponent like `e-12` or `p3`. The marker and the sign are only part of a number if
+ * a decimal digit follows, otherwise they are put back.
+ */
+static bool lexExponent(Lexer* lexer, char marker) {
+  if ((peekChar(lexer) | 0x20) != marker) {
+    return false;
+  }
+  nextChar(lexer);
+  int consumed = 1;
+  if (peekChar(lexer) == '+' || peekChar(lexer) == '-') {
     nextChar(lexer);
+    consumed++;
+  }
+  if (!(charClass[(unsigned char) peekChar(lexer)] & CHAR_DIGIT)) {
+    lexer->index -= consumed;
+    return false;
   }
+  skipWhile(lexer, CHAR_DIGIT | CHAR_UNDERSCORE);
+  return true;
+}
+
+
+/**
+ * Computes the value of the current float token. Returns `false` if it is too large for a double.
+ */
+static bool floatValue(const Lexer* lexer, double* value) {
+  const char* chars = lexer->source->content.chars;
+  return doubleFromString(stringFromRange(&chars[lexer->mark], &chars[lexer->index]), value);
+}
+
 
-  const char* start = &lexer->source->content.chars[lexer->index];
+/**
+ * Computes the value of the current integer token, whose digits start `prefix` characters after
+ * the mark. The characters are taken after all peeks, since a refill may move the window.
+ */
+static bool tokenValue(const Lexer* lexer, int prefix,
+                       bool (*function)(const char*, const char*, uint64_t*), uint64_t* value) {
+  const char* chars = lexer->source->content.chars;
+  return function(&chars[lexer->mark + prefix], &chars[lexer->index], value);
+}
+
+
+/**
+ * Lexes the next token including comments. The whitespace in front of the token is recorded if
+ * the trivia are collected. A refill while skipping the whitespace moves the indices, thus the
+ * span's start is taken relative to the whole input.
+ */
+static Token lexToken(Lexer* lexer) {
+  Token token = (Token){ .kind=TOKEN_NONE, .keyword=KEYWORD_NONE, .source=lexer->source,
+                         .chars=stringFromArray("") };
+  lexer->mark = lexer->index;
+  if (lexer->triviaMode == TRIVIA_COLLECT) {
+    size_t start = inputOffset(lexer, lexer->index);
+    skipWhitespace(lexer);
+    size_t end = inputOffset(lexer, lexer->index);
+    if (end > start) {
+      sbufPush(lexer->trivia, (Trivia){ .kind=TRIVIA_WHITESPACE, .offset=start,
+                                        .length=end - start });
+    }
+  } else {
+    skipWhitespace(lexer);
+  }
+
+  lexer->mark = lexer->index;
   char c = nextChar(lexer);
-  token.start = lexer->currentLoc;
-  Location errorLoc = loc(0, 0);
-  string errorMsg = stringFromArray("");
 
-  switch (c) {
-    case '\0':
+  switch ((TokenStart) startTable[(unsigned char) c]) {
+    case START_EOF:
     {
       token.kind = TOKEN_EOF;
     } break;
 
-    case 'a':  case 'b':  case 'c':  case 'd':  case 'e':  case 'f':  case 'g':
-    case 'h':  case 'i':  case 'j':  case 'k':  case 'l':  case 'm':  case 'n':
-    case 'o':  case 'p':  case 'q':  case 'r':  case 's':  case 't':  case 'u':
-    case 'v':  case 'w':  case 'x':  case 'y':  case 'z':
-    case 'A':  case 'B':  case 'C':  case 'D':  case 'E':  case 'F':  case 'G':
-    case 'H':  case 'I':  case 'J':  case 'K':  case 'L':  case 'M':  case 'N':
-    case 'O':  case 'P':  case 'Q':  case 'R':  case 'S':  case 'T':  case 'U':
-    case 'V':  case 'W':  case 'X':  case 'Y':  case 'Z':
-    case '_':
+    case START_NAME:
     {
       token.kind = TOKEN_NAME;
-      for (char c = peekChar(lexer); isalnum(c) || c == '_'; c = peekChar(lexer)) {
-        nextChar(lexer);
-      }
-      string name = stringFromRange(start, &lexer->source->content.chars[lexer->index]);
-      if (isKeyword(name)) {
+      skipWhile(lexer, CHAR_IDENT);
+      token.keyword = findKeyword(&lexer->source->content.chars[lexer->mark],
+                                  lexer->index - lexer->mark);
+      if (token.keyword != KEYWORD_NONE) {
         token.kind = TOKEN_KEYWORD;
       }
     } break;
 
-    // integer 0, hex and bin integers
-    case '0':
+    // integer 0, hex and bin integers, hex floats
+    case START_ZERO:
     {
       token.kind = TOKEN_INT;
       if (peekChar(lexer) == 'x' || peekChar(lexer) == 'X') {
@@ -119,23 +746,42 @@ Token nextToken(Lexer* lexer) {
         nextChar(lexer);
         bool hasDigit = false;
         for (char c = peekChar(lexer);
-             isdigit(c) || c == '_' || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+             charClass[(unsigned char) c] & (CHAR_HEX | CHAR_UNDERSCORE);
              c = peekChar(lexer)) {
           token.kind = TOKEN_INT;
           hasDigit |= (nextChar(lexer) != '_');
         }
         if (!hasDigit) {
           token.kind = TOKEN_ERROR;
-          errorLoc = lexer->currentLoc;
-          errorMsg = stringFromArray("hex integer must have at least one digit");
-        } else if (isalpha(peekChar(lexer))) {
+          token.caret = lexer->index - 1 - lexer->mark;
+          token.error = LEX_ERROR_HEX_DIGITS;
+          break;
+        }
+
+        int dot = lexer->index - lexer->mark;
+        bool fraction = lexFraction(lexer, CHAR_HEX);
+        bool exponent = lexExponent(lexer, 'p');
+        if (charClass[(unsigned char) peekChar(lexer)] & CHAR_ALPHA) {
           nextChar(lexer);
           token.kind = TOKEN_ERROR;
-          errorLoc = lexer->currentLoc;
-          errorMsg = stringFromArray("invalid hex integer format");
-          for (char c = peekChar(lexer); isalnum(c) || c == '_'; c = peekChar(lexer)) {
-            nextChar(lexer);
+          token.caret = lexer->index - 1 - lexer->mark;
+          token.error = (fraction || exponent) ? LEX_ERROR_FLOAT_FORMAT : LEX_ERROR_HEX_FORMAT;
+          skipWhile(lexer, CHAR_IDENT);
+        } else if (fraction && !exponent) {
+          token.kind = TOKEN_ERROR;
+          token.caret = dot;
+          token.error = LEX_ERROR_HEX_EXPONENT;
+        } else if (exponent) {
+          token.kind = TOKEN_FLOAT;
+          if (!floatValue(lexer, &token.floatValue)) {
+            token.kind = TOKEN_ERROR;
+            token.caret = 0;
+            token.error = LEX_ERROR_FLOAT_OVERFLOW;
           }
+        } else if (!tokenValue(lexer, 2, hexValue, &token.value)) {
+          token.kind = TOKEN_ERROR;
+          token.caret = 0;
+          token.error = LEX_ERROR_INT_OVERFLOW;
         }
         break;
       }
@@ -143,134 +789,408 @@ Token nextToken(Lexer* lexer) {
         token.kind = TOKEN_ERROR;  // assume error if loop is not entered (thus no digits)
         nextChar(lexer);
         bool hasDigit = false;
-        for (char c = peekChar(lexer); c == '0' || c == '1' || c == '_'; c = peekChar(lexer)) {
+        for (char c = peekChar(lexer);
+             charClass[(unsigned char) c] & (CHAR_BIN | CHAR_UNDERSCORE);
+             c = peekChar(lexer)) {
           token.kind = TOKEN_INT;
           hasDigit |= (nextChar(lexer) != '_');
         }
         if (!hasDigit) {
           token.kind = TOKEN_ERROR;
-          errorLoc = lexer->currentLoc;
-          errorMsg = stringFromArray("bin integer must have at least one digit");
-        } else if (isalnum(peekChar(lexer))) {
+          token.caret = lexer->index - 1 - lexer->mark;
+          token.error = LEX_ERROR_BIN_DIGITS;
+        } else if (charClass[(unsigned char) peekChar(lexer)] & (CHAR_ALPHA | CHAR_DIGIT)) {
           nextChar(lexer);
           token.kind = TOKEN_ERROR;
-          errorLoc = lexer->currentLoc;
-          errorMsg = stringFromArray("invalid bin integer format");
-          for (char c = peekChar(lexer); isalnum(c) || c == '_'; c = peekChar(lexer)) {
-            nextChar(lexer);
-          }
+          token.caret = lexer->index - 1 - lexer->mark;
+          token.error = LEX_ERROR_BIN_FORMAT;
+          skipWhile(lexer, CHAR_IDENT);
+        } else if (!tokenValue(lexer, 2, binaryValue, &token.value)) {
+          token.kind = TOKEN_ERROR;
+          token.caret = 0;
+          token.error = LEX_ERROR_INT_OVERFLOW;
         }
         break;
       }
     }  // shall fall trough
 
-    case '1':  case '2':  case '3':  case '4':
-    case '5':  case '6':  case '7':  case '8':  case '9':
+    case START_DIGIT:
     {
       token.kind = TOKEN_INT;
-      for (char c = peekChar(lexer); isdigit(c) || c == '_'; c = peekChar(lexer)) {
-        nextChar(lexer);
-      }
-      if (isalpha(peekChar(lexer))) {
+      skipWhile(lexer, CHAR_DIGIT | CHAR_UNDERSCORE);
+      bool fraction = lexFraction(lexer, CHAR_DIGIT);
+      bool exponent = lexExponent(lexer, 'e');
+      if (charClass[(unsigned char) peekChar(lexer)] & CHAR_ALPHA) {
         nextChar(lexer);
         token.kind = TOKEN_ERROR;
-        errorLoc = lexer->currentLoc;
-        errorMsg = stringFromArray("invalid integer format");
-        for (char c = peekChar(lexer); isalnum(c); c = peekChar(lexer)) {
-          nextChar(lexer);
+        token.caret = lexer->index - 1 - lexer->mark;
+        token.error = (fraction || exponent) ? LEX_ERROR_FLOAT_FORMAT : LEX_ERROR_INT_FORMAT;
+        skipWhile(lexer, CHAR_ALPHA | CHAR_DIGIT);
+      } else if (fraction || exponent) {
+        token.kind = TOKEN_FLOAT;
+        if (!floatValue(lexer, &token.floatValue)) {
+          token.kind = TOKEN_ERROR;
+          token.caret = 0;
+          token.error = LEX_ERROR_FLOAT_OVERFLOW;
         }
+      } else if (!tokenValue(lexer, 0, decimalValue, &token.value)) {
+        token.kind = TOKEN_ERROR;
+        token.caret = 0;
+        token.error = LEX_ERROR_INT_OVERFLOW;
       }
     } break;
 
-    // separators "(" ")" "[" "]" "{" "}" "," ";" ":" "."
-    case '(':  case ')':  case '[':  case ']':  case '{':  case '}':
-    case ',':  case ';':  case ':':  case '.':
+    // separators "(" ")" "[" "]" "{" "}" "," ";" ":" "." and all operators but "/"
+    case START_SYMBOL:
     {
       token.kind = TOKEN_SYMBOL;
-    } break;
-
-    // operators "!" "!=" "=" "==" "<" "<=" ">" ">="
-    case '!':  case '=':  case '<':  case '>':
-    {
-      token.kind = TOKEN_SYMBOL;
-      if (peekChar(lexer) == '=') {
+      const SymbolEntry* entry = &symbolTable[(unsigned char) c];
+      token.symbol = entry->single;
+      if (entry->extension != '\0' && peekChar(lexer) == entry->extension) {
         nextChar(lexer);
+        token.symbol = entry->extended;
       }
     } break;
 
-    // operators "&" "&&" "|" "||"
-    case '&':  case '|':
+    // operator "/" and single-line and multi-line comments
+    case START_SLASH:
     {
-      token.kind = TOKEN_SYMBOL;
-      if (peekChar(lexer) == lexer->currentChar) {
+      if (peekChar(lexer) == '/') {  // munch single-line comment
+        token.kind = TOKEN_COMMENT;
+        skipLine(lexer);
+      } else if (peekChar(lexer) == '*') {  // munch multi-line comment
         nextChar(lexer);
+        token.kind = TOKEN_COMMENT;
+        if (!skipBlockComment(lexer)) {
+          token.kind = TOKEN_ERROR;
+          token.caret = 0;
+          token.error = LEX_ERROR_UNCLOSED_COMMENT;
+        }
+      } else {
+        token.kind = TOKEN_SYMBOL;
+        token.symbol = SYMBOL_SLASH;
       }
     } break;
 
-    // operators "+" "*" "%" "^" "~"
-    case '+':  case '*':  case '%':  case '^':  case '~':
-    {
-      token.kind = TOKEN_SYMBOL;
-    } break;
-
-    // operators "-" "->"
-    case '-':
+    // string literal, its value is the length of the decoded string
+    case START_STRING:
     {
-      token.kind = TOKEN_SYMBOL;
-      if (peekChar(lexer) == '>') {
-        nextChar(lexer);
+      token.kind = TOKEN_STRING;
+      size_t saved = 0;
+      if (!skipQuoted(lexer, '"', &token, &saved)) {
+        token.kind = TOKEN_ERROR;
+        token.caret = 0;
+        token.error = LEX_ERROR_UNCLOSED_STRING;
+      } else if (token.kind == TOKEN_STRING) {
+        token.value = lexer->index - lexer->mark - 2 - saved;
       }
     } break;
 
-    // operator "/" and single-line and multi-line comments
-    case '/':
+    // character literal, its value is the code point
+    case START_CHAR:
     {
-      token.kind = TOKEN_SYMBOL;
-
-      if (peekChar(lexer) == '/') {  // munch single-line comment
-        token.kind = TOKEN_COMMENT;
-        for (char c = peekChar(lexer); c != '\0' && c != '\n'; c = peekChar(lexer)) {
-          nextChar(lexer);
-        }
-      } else if (peekChar(lexer) == '*') {  // munch multi-line comment
+      token.kind = TOKEN_CHAR;
+      token.value = 0;
+      char c = peekChar(lexer);
+      if (c == '\\') {
         nextChar(lexer);
-        for (char c = peekChar(lexer); c != '\0'; c = peekChar(lexer)) {
-          if (peekChar(lexer) == '*') {
-            nextChar(lexer);
-            if (peekChar(lexer) == '/') {
-              token.kind = TOKEN_COMMENT;
-              nextChar(lexer);
-              break;
-            }
-          } else {
-            nextChar(lexer);
-          }
-        }
-        if (token.kind != TOKEN_COMMENT) {
+        if (!lexEscape(lexer, &token.value)) {
           token.kind = TOKEN_ERROR;
-          errorLoc = token.start;
-          errorMsg = stringFromArray("unclosed multi-line comment");
+          token.caret = lexer->index - lexer->mark;
+          token.error = LEX_ERROR_INVALID_ESCAPE;
         }
+      } else if (c != '\'' && c != '\n' && c != '\0') {
+        token.value = lexCodePoint(lexer);
+      }
+
+      int length = lexer->index - lexer->mark;
+      size_t saved = 0;
+      if (!skipQuoted(lexer, '\'', &token, &saved)) {
+        token.kind = TOKEN_ERROR;
+        token.caret = 0;
+        token.error = LEX_ERROR_UNCLOSED_CHAR;
+      } else if (token.kind == TOKEN_CHAR &&
+                 (length == 1 || lexer->index - lexer->mark > length + 1)) {
+        token.kind = TOKEN_ERROR;
+        token.caret = length;  // the closing quote of an empty literal or the second character
+        token.error = LEX_ERROR_CHAR_LENGTH;
       }
     } break;
 
-    default:
+    case START_ILLEGAL:
     {
       token.kind = TOKEN_ERROR;
-      errorLoc = lexer->currentLoc;
-      errorMsg = stringFromPrint("illegal character '%c'", c);
+      token.error = LEX_ERROR_ILLEGAL_CHAR;
+      token.caret = 0;
+      if ((unsigned char) c >= 0x80) {  // sources are valid UTF-8, consume the whole character
+        for (char c = peekChar(lexer); ((unsigned char) c & 0xC0) == 0x80; c = peekChar(lexer)) {
+          nextChar(lexer);
+        }
+      }
     } break;
   }
 
-  token.end = lexer->currentLoc;
+  const char* start = &lexer->source->content.chars[lexer->mark];
   const char* end = &lexer->source->content.chars[lexer->index];
   token.chars = stringFromRange(start, (token.kind == TOKEN_EOF) ? end-1 : end);
   if (token.kind == TOKEN_ERROR) {
-    string msg = generateError(token.source, token.start, errorLoc, token.end, errorMsg.chars);
-    token.error = (Error*) malloc(sizeof(Error));
-    *token.error = createError(errorLoc, msg, NULL);
+    sbufPush(lexer->errors, (LexError){ .kind=token.error, .offset=inputOffset(lexer, lexer->mark),
+                                        .length=token.chars.len, .caret=token.caret });
   }
 
   return token;
 }
 
+
+Token nextToken(Lexer* lexer) {
+  Token token = lexToken(lexer);
+  while (token.kind == TOKEN_COMMENT && lexer->triviaMode != TRIVIA_TOKENS) {
+    if (lexer->triviaMode == TRIVIA_COLLECT) {
+      size_t offset = inputOffset(lexer, lexer->mark);
+      sbufPush(lexer->trivia, (Trivia){ .kind=TRIVIA_COMMENT, .offset=offset,
+                                        .length=token.chars.len });
+    }
+    token = lexToken(lexer);
+  }
+  return token;
+}
+
+
+
+/**
+ * **INTERNAL!** `lexOversized()` returns the tokens of a source that is too large for a token
+ * array, i.e. the error and the `TOKEN_EOF` at the start of the content.
+ */
+static TokenArray lexOversized(const Source* src) {
+  TokenArray tokens = { .source=src, .kinds=NULL, .subkinds=NULL, .offsets=NULL, .lengths=NULL,
+                        .values=NULL, .errors=NULL
+                      };
+  string empty = stringFromRange(src->content.chars, src->content.chars);
+  Token token = { .kind=TOKEN_ERROR, .error=LEX_ERROR_SOURCE_SIZE, .caret=0, .source=src,
+                  .chars=empty
+                };
+  appendToken(&tokens, token);
+  sbufPush(tokens.errors, (LexError){ .kind=LEX_ERROR_SOURCE_SIZE, .offset=0, .length=0,
+                                      .caret=0 });
+  appendToken(&tokens, (Token){ .kind=TOKEN_EOF, .source=src, .chars=empty });
+  return tokens;
+}
+
+
+/**
+ * The buffers are reserved for one token per four characters up front, which avoids most of the
+ * reallocations for typical code.
+ */
+TokenArray lexSource(const Source* src) {
+  if (src->content.len > TOKEN_ARRAY_MAX_CONTENT) {
+    return lexOversized(src);
+  }
+  TokenArray tokens = { .source=src, .kinds=NULL, .subkinds=NULL, .offsets=NULL, .lengths=NULL,
+                        .values=NULL, .errors=NULL
+                      };
+  size_t estimate = src->content.len / 4 + 1;
+  sbufFit(tokens.kinds, estimate);
+  sbufFit(tokens.subkinds, estimate);
+  sbufFit(tokens.offsets, estimate);
+  sbufFit(tokens.lengths, estimate);
+
+  Lexer lexer = lexerFromSource(src);
+  Token token;
+  do {
+    token = nextToken(&lexer);
+    appendToken(&tokens, token);
+  } while (token.kind != TOKEN_EOF);
+
+  tokens.errors = lexer.errors;  // the array takes over the records
+  return tokens;
+}
+
+
+/**
+ * **INTERNAL!** `looksBehind()` checks if the lexer may have read up to the offset to end the
+ * token. Only numbers and their errors look further than one character.
+ */
+static bool looksBehind(const TokenArray* tokens, size_t index, size_t offset) {
+  TokenKind kind = tokens->kinds[index];
+  bool number = (kind == TOKEN_INT || kind == TOKEN_FLOAT || kind == TOKEN_ERROR);
+  return number && tokens->offsets[index] + tokens->lengths[index] + MAX_LOOKAHEAD > offset;
+}
+
+
+/**
+ * The lexer looks one character past a token, behind digits up to three, e.g. at `".5"` or
+ * `"e+5"`. The first damaged token is the first one that ends at or after the edit, or a number
+ * that ends less than three characters before it. All tokens before it are kept, the relexing
+ * starts at the end of the last kept token. An old token behind the edit is shifted by the edit's
+ * size difference.
+ */
+TokenRange relexSource(TokenArray* tokens, const Source* src, TextEdit edit) {
+  size_t count = tokenCount(tokens);
+  if (src->content.len > TOKEN_ARRAY_MAX_CONTENT) {
+    TokenArray fresh = lexOversized(src);
+    replaceTokens(tokens, 0, count, &fresh, 0);
+    deleteTokenArray(&fresh);
+    return (TokenRange){ .first=0, .removed=count, .inserted=2 };
+  }
+  size_t low = 0;
+  size_t high = count - 1;  // the final TOKEN_EOF always ends at or after the edit
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (tokens->offsets[mid] + tokens->lengths[mid] < edit.offset) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  size_t first = low;
+  while (first > 0 && looksBehind(tokens, first - 1, edit.offset)) {
+    first--;
+  }
+  size_t start = (first > 0) ? tokens->offsets[first-1] + tokens->lengths[first-1] : 0;
+
+  int64_t shift = (int64_t) edit.inserted - (int64_t) edit.removed;
+  size_t editEnd = edit.offset + edit.removed;
+  TokenArray fresh = { .source=src, .kinds=NULL, .subkinds=NULL, .offsets=NULL, .lengths=NULL,
+                       .values=NULL, .errors=NULL
+                     };
+  Lexer lexer = lexerFromOffset(src, start);
+  size_t end = first;
+  while (true) {
+    Token token = nextToken(&lexer);
+    while (end < count && (tokens->offsets[end] < editEnd ||
+                           tokens->offsets[end] + shift < lexer.mark)) {
+      end++;
+    }
+    if (end < count && tokens->offsets[end] + shift == lexer.mark) {  // synchronized
+      if (token.kind == TOKEN_ERROR) {
+        sbufPop(lexer.errors);
+      }
+      break;
+    }
+    appendToken(&fresh, token);
+    if (token.kind == TOKEN_EOF) {
+      end = count;
+      break;
+    }
+  }
+  fresh.errors = lexer.errors;
+
+  replaceTokens(tokens, first, end, &fresh, shift);
+  TokenRange range = { .first=first, .removed=end - first, .inserted=tokenCount(&fresh) };
+  deleteTokenArray(&fresh);
+  return range;
+}
+
+
+/**
+ * The line is lexed by a lexer on a view of the source that ends before the newline, thus the
+ * lexer never reads past the line. A comment that is still open at the end of the line becomes an
+ * unclosed comment in the view. A comment that is open at the start of the line is skipped up to
+ * its closing by hand.
+ */
+LineState lexLine(const Source* src, size_t line, LineState state, SBUF(TokenSpan)* spans) {
+  string text = getLine(src, line);
+  Source view = *src;
+  view.content = stringFromRange(text.chars, text.chars + text.len);
+  if (view.content.len > 0 && view.content.chars[view.content.len-1] == '\n') {
+    view.content.len--;
+  }
+  uint32_t lineOffset = text.chars - src->content.chars;
+  int length = view.content.len;
+
+  int start = 0;
+  if (state == LINE_COMMENT) {
+    int close = scanBlockComment(view.content.chars, 0, length - 1);
+    start = (close < length - 1) ? close + 2 : length;
+    if (start > 0) {
+      sbufPush(*spans, (TokenSpan){ .kind=TOKEN_COMMENT, .offset=lineOffset, .length=start });
+    }
+    if (close >= length - 1) {
+      return LINE_COMMENT;
+    }
+  }
+
+  state = LINE_CODE;
+  Lexer lexer = lexerFromOffset(&view, start);
+  for (Token token = nextToken(&lexer); token.kind != TOKEN_EOF; token = nextToken(&lexer)) {
+    TokenKind kind = token.kind;
+    if (kind == TOKEN_ERROR && token.error == LEX_ERROR_UNCLOSED_COMMENT) {
+      kind = TOKEN_COMMENT;
+      state = LINE_COMMENT;
+    }
+    sbufPush(*spans, (TokenSpan){ .kind=kind, .offset=token.chars.chars - src->content.chars,
+                                  .length=token.chars.len });
+  }
+  deleteLexer(&lexer);
+  return state;
+}
+
+
+/**
+ * All lines after the first line of a comment start inside the comment. The line of the
+ * comment's end is included, as the end is the offset after the comment's last character.
+ */
+SBUF(LineState) lineStates(const Source* src) {
+  SBUF(LineState) states = NULL;
+  size_t lines = (src->lines != NULL) ? sbufLength(src->lines) : 0;
+  for (size_t i = 0; i < lines; i++) {
+    sbufPush(states, LINE_CODE);
+  }
+
+  Lexer lexer = lexerFromSource(src);
+  for (Token token = nextToken(&lexer); token.kind != TOKEN_EOF; token = nextToken(&lexer)) {
+    if (token.kind == TOKEN_COMMENT || token.kind == TOKEN_ERROR) {
+      size_t end = token.chars.chars + token.chars.len - src->content.chars;
+      size_t first = tokenStart(token).line + 1 - src->firstLine;
+      size_t last = getLocation(src, end).line - src->firstLine;
+      for (size_t i = first; i <= last && i < lines; i++) {
+        states[i] = LINE_COMMENT;
+      }
+    }
+  }
+  deleteLexer(&lexer);
+  return states;
+}
+
+
+/**
+ * The escape sequences were validated by the lexer. The runs between them are copied as a whole.
+ */
+string stringValue(Token token, Arena* arena) {
+  const char* chars = token.chars.chars + 1;
+  const char* end = token.chars.chars + token.chars.len - 1;
+  if (token.value == (uint64_t) (end - chars)) {
+    return stringFromRange(chars, end);  // no escape sequences
+  }
+
+  char* text = (char*) arenaAlloc(arena, token.value + 1);
+  char* out = text;
+  while (chars < end) {
+    const char* backslash = memchr(chars, '\\', end - chars);
+    const char* run = (backslash != NULL) ? backslash : end;
+    memcpy(out, chars, run - chars);
+    out += run - chars;
+    chars = run;
+    if (chars == end) {
+      break;
+    }
+    if (chars[1] == 'x') {
+      *out++ = (hexDigit(chars[2]) << 4) | hexDigit(chars[3]);
+      chars += 4;
+    } else {
+      *out++ = escapeTable[(unsigned char) chars[1]] & 0xFF;
+      chars += 2;
+    }
+  }
+  *out = '\0';
+  return stringFromRange(text, out);
+}
+
+
+Error errorFromLexError(const Source* src, LexError error) {
+  const char* chars = src->content.chars + error.offset;
+  Token token = { .kind=TOKEN_ERROR, .error=error.kind, .caret=error.caret, .source=src,
+                  .chars=stringFromRange(chars, chars + error.length)
+                };
+  return errorFromToken(token);
+}
@@ -0,0 +1,113 @@
+#include "loader.h"
+
+#include "sbuffer.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+
+#define MIN(a, b) ((a) <= (b) ? (a) : (b))
+
+
+/**
+ * **INTERNAL!** `LoadedSource` is a source that was read and waits to be passed to the callback.
+ */
+typedef struct LoadedSource {
+  Source source;
+  size_t index;
+} LoadedSource;
+
+
+/**
+ * **INTERNAL!** `LoadQueue` is shared by the workers and the calling thread. Workers take the next
+ * path by incrementing `next` and push the result to `ready`. The calling thread waits on `signal`
+ * for new results.
+ */
+typedef struct LoadQueue {
+  const char* const*   paths;
+  size_t               count;
+  size_t               next;
+  SBUF(LoadedSource)   ready;
+  pthread_mutex_t      mutex;
+  pthread_cond_t       signal;
+} LoadQueue;
+
+
+static void* loadWorker(void* arg) {
+  LoadQueue* queue = (LoadQueue*) arg;
+
+  while (true) {
+    pthread_mutex_lock(&queue->mutex);
+    size_t index = queue->next++;
+    pthread_mutex_unlock(&queue->mutex);
+    if (index >= queue->count) {
+      return NULL;
+    }
+
+    Source source = sourceFromFile(queue->paths[index]);  // blocking read outside the lock
+
+    pthread_mutex_lock(&queue->mutex);
+    sbufPush(queue->ready, (LoadedSource){ .source=source, .index=index });
+    pthread_cond_signal(&queue->signal);
+    pthread_mutex_unlock(&queue->mutex);
+  }
+}
+
+
+/**
+ * The calling thread takes all ready sources at once by swapping the buffer, such that the workers
+ * are not blocked while the callbacks run.
+ */
+void loadSources(const char* const* paths, size_t count, int threads,
+                 SourceCallback callback, void* data) {
+  if (count == 0) {
+    return;
+  }
+  if (threads <= 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cores > 0) ? cores : 1;
+  }
+  threads = MIN((size_t) threads, count);
+
+  LoadQueue queue = { .paths=paths, .count=count, .next=0, .ready=NULL };
+  pthread_mutex_init(&queue.mutex, NULL);
+  pthread_cond_init(&queue.signal, NULL);
+
+  SBUF(pthread_t) workers = NULL;
+  for (int i = 0; i < threads; i++) {
+    pthread_t worker;
+    if (pthread_create(&worker, NULL, loadWorker, &queue) == 0) {
+      sbufPush(workers, worker);
+    }
+  }
+  if (sbufLength(workers) == 0) {
+    loadWorker(&queue);  // no threads available, load everything on the calling thread
+  }
+
+  SBUF(LoadedSource) batch = NULL;
+  for (size_t delivered = 0; delivered < count; ) {
+    pthread_mutex_lock(&queue.mutex);
+    while (sbufLength(queue.ready) == 0) {
+      pthread_cond_wait(&queue.signal, &queue.mutex);
+    }
+    SBUF(LoadedSource) swap = queue.ready;
+    queue.ready = batch;
+    batch = swap;
+    pthread_mutex_unlock(&queue.mutex);
+
+    for (LoadedSource* it = batch; it != sbufEnd(batch); it++) {
+      callback(&it->source, it->index, data);
+    }
+    delivered += sbufLength(batch);
+    sbufClear(batch);
+  }
+
+  for (pthread_t* it = workers; it != sbufEnd(workers); it++) {
+    pthread_join(*it, NULL);
+  }
+  sbufFree(workers);
+  sbufFree(batch);
+  sbufFree(queue.ready);
+  pthread_cond_destroy(&queue.signal);
+  pthread_mutex_destroy(&queue.mutex);
+}
@@ -1,50 +1,1027 @@
 #include "number.h"
 
+#include "arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#ifndef __has_builtin
+#define __has_builtin(x) 0
+#endif
+
+#define MAX(x, y) ((x) >= (y) ? (x) : (y))
+
+/**
+ * **INTERNAL!** `SIGN_LIMB` is a limb that only extends the sign, i.e. all bits are the sign bit.
+ */
+#define SIGN_LIMB(negative) ((negative) ? UINT64_MAX : 0)
+
+/**
+ * **INTERNAL!** Intermediate results are computed in scratch limbs, which are on the stack for up
+ * to `SCRATCH_LIMBS` limbs. Only a normalized result that does not fit inline goes to the arena.
+ */
+#define SCRATCH_LIMBS 16
+
+#define DIGIT_SEPARATOR -1
+#define DIGIT_END       -2
+
+
+static Arena limbArena = {};
+
 
 Number numFromInt(int value) {
-  return (Number){ .value=value };
+  return numFromInt64(value);
 }
 
 
-Number numFromString(string s) {
-  return (Number){ .value=atoi(s.chars) };
+Number numFromInt64(int64_t value) {
+  return (Number){ .size=0, .negative=(value < 0), .value=(uint64_t) value };
+}
+
+
+Number numFromUInt64(uint64_t value) {
+  return (Number){ .size=0, .negative=false, .value=value };
 }
 
 
 void deleteNum(Number* num) {
+  *num = numFromInt(0);
+}
+
+
+void numFree() {
+  arenaFree(&limbArena);
+}
+
+
+/********************************************* LIMBS *********************************************/
+
+
+/**
+ * An inline number has two limbs, the value and its sign.
+ */
+static size_t limbCount(Number num) {
+  return (num.size == 0) ? 2 : num.size;
+}
+
+
+/**
+ * Returns the limb at the index, any limb above the number's limbs extends the sign.
+ */
+static uint64_t limbAt(Number num, size_t index) {
+  if (num.size == 0) {
+    return (index == 0) ? num.value : SIGN_LIMB(num.negative);
+  }
+  return (index < num.size) ? num.limbs[index] : SIGN_LIMB(num.negative);
+}
+
+
+/**
+ * Adds with the carry of the previous limb and sets the carry for the next one. The compiler
+ * turns the chain into add-with-carry instructions.
+ */
+static inline uint64_t addCarry(uint64_t a, uint64_t b, bool* carry) {
+#if __has_builtin(__builtin_addcll)
+  unsigned long long out;
+  uint64_t sum = __builtin_addcll(a, b, *carry, &out);
+  *carry = (out != 0);
+  return sum;
+#else
+  uint64_t sum;
+  bool high = __builtin_add_overflow(a, b, &sum);
+  high |= __builtin_add_overflow(sum, (uint64_t) *carry, &sum);
+  *carry = high;
+  return sum;
+#endif
+}
+
+
+static void negate(uint64_t* limbs, size_t count) {
+  bool carry = true;
+  for (size_t i = 0; i < count; i++) {
+    limbs[i] = addCarry(~limbs[i], 0, &carry);
+  }
+}
+
+
+/**
+ * The arithmetic has no way to report an error, thus running out of memory aborts.
+ */
+static uint64_t* scratchAlloc(uint64_t* local, size_t count) {
+  if (count <= SCRATCH_LIMBS) {
+    return local;
+  }
+  uint64_t* limbs = (uint64_t*) malloc(count * sizeof(uint64_t));
+  if (limbs == NULL) {
+    fputs("ERROR: could not allocate enough memory\n", stderr);
+    abort();
+  }
+  return limbs;
+}
+
+
+static void scratchFree(uint64_t* limbs, const uint64_t* local) {
+  if (limbs != local) {
+    free(limbs);
+  }
+}
+
+
+/**
+ * Strips the upper limbs that only extend the sign of the limb below. Two limbs fit inline if the
+ * upper one is a pure sign, otherwise the limbs are copied to the arena. No limbs at all are zero.
+ */
+static Number numFromLimbs(const uint64_t* limbs, size_t count) {
+  if (count == 0) {
+    return numFromInt(0);
+  }
+  bool negative = (limbs[count-1] >> 63) != 0;
+  while (count > 2 && limbs[count-1] == SIGN_LIMB(negative) &&
+         (limbs[count-2] >> 63) == negative) {
+    count--;
+  }
+  if (count == 1 || (count == 2 && limbs[1] == SIGN_LIMB(negative))) {
+    return (Number){ .size=0, .negative=negative, .value=limbs[0] };
+  }
+
+  Number num = { .size=count, .negative=negative };
+  num.limbs = (uint64_t*) arenaAlloc(&limbArena, count * sizeof(uint64_t));
+  memcpy(num.limbs, limbs, count * sizeof(uint64_t));
+  return num;
+}
+
+
+/**
+ * Multiplies the unsigned limbs by a factor and adds a summand. The limbs must have room for the
+ * result.
+ */
+static void mulAddLimbs(uint64_t* limbs, size_t count, uint64_t factor, uint64_t summand) {
+  uint64_t carry = summand;
+  for (size_t i = 0; i < count; i++) {
+    unsigned __int128 t = (unsigned __int128) limbs[i] * factor + carry;
+    limbs[i] = (uint64_t) t;
+    carry = (uint64_t) (t >> 64);
+  }
+}
+
+
+/**
+ * Writes the magnitude of the number as `limbCount()` unsigned limbs and returns the number of
+ * limbs without the leading zeros.
+ */
+static size_t magnitude(Number num, uint64_t* limbs) {
+  size_t count = limbCount(num);
+  for (size_t i = 0; i < count; i++) {
+    limbs[i] = limbAt(num, i);
+  }
+  if (num.negative) {
+    negate(limbs, count);
+  }
+  while (count > 1 && limbs[count-1] == 0) {
+    count--;
+  }
+  return count;
 }
 
 
+/**
+ * Returns a limb of the magnitude without copying the number. The limbs must be visited from the
+ * lowest up, the carry of the negation is kept between the calls and starts as `true`.
+ */
+static uint64_t magnitudeAt(Number num, size_t index, bool* carry) {
+  uint64_t limb = limbAt(num, index);
+  return num.negative ? addCarry(~limb, 0, carry) : limb;
+}
+
+
+/**
+ * Returns the number of magnitude limbs without the leading zeros, the highest of them is stored
+ * to `top`.
+ */
+static size_t magnitudeTop(Number num, uint64_t* top) {
+  bool carry = true;
+  size_t count = 1;
+  *top = magnitudeAt(num, 0, &carry);
+  for (size_t i = 1; i < limbCount(num); i++) {
+    uint64_t limb = magnitudeAt(num, i, &carry);
+    if (limb != 0) {
+      count = i + 1;
+      *top = limb;
+    }
+  }
+  return count;
+}
+
+
+/**
+ * Divides the unsigned limbs in place and returns the remainder. Leading zero limbs are dropped.
+ */
+static uint64_t divideLimbs(uint64_t* limbs, size_t* count, uint64_t divisor) {
+  unsigned __int128 remainder = 0;
+  for (size_t i = *count; i-- > 0; ) {
+    unsigned __int128 dividend = (remainder << 64) | limbs[i];
+    limbs[i] = (uint64_t) (dividend / divisor);
+    remainder = dividend % divisor;
+  }
+  while (*count > 1 && limbs[*count-1] == 0) {
+    (*count)--;
+  }
+  return (uint64_t) remainder;
+}
+
+
+/******************************************* CONVERSION ******************************************/
+
+
+static int digitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+    return (c | 0x20) - 'a' + 10;
+  } else {
+    return (c == '_') ? DIGIT_SEPARATOR : DIGIT_END;
+  }
+}
+
+
+/**
+ * Collects as many digits into a chunk as fit into 64 bits, then adds the chunk to the limbs. The
+ * limbs have room for four bits per digit plus a sign limb, which is enough for any base up to 16.
+ */
+static Number bigFromDigits(string s, int start, int base) {
+  size_t count = (s.len - start) * 4 / 64 + 2;
+  uint64_t local[SCRATCH_LIMBS];
+  uint64_t* limbs = scratchAlloc(local, count);
+  memset(limbs, 0, count * sizeof(uint64_t));
+
+  uint64_t chunk = 0;
+  uint64_t scale = 1;
+  for (int i = start; i < s.len; i++) {
+    int digit = digitValue(s.chars[i]);
+    if (digit == DIGIT_SEPARATOR) {
+      continue;
+    } else if (digit == DIGIT_END) {
+      break;
+    }
+    chunk = chunk * base + digit;
+    scale *= base;
+    if (scale > UINT64_MAX / base) {
+      mulAddLimbs(limbs, count, scale, chunk);
+      chunk = 0;
+      scale = 1;
+    }
+  }
+  mulAddLimbs(limbs, count, scale, chunk);
+
+  Number num = numFromLimbs(limbs, count);
+  scratchFree(limbs, local);
+  return num;
+}
+
+
+/**
+ * Literals up to 64 bits are converted in a plain loop. Only on an overflow the conversion starts
+ * again with limbs.
+ */
+Number numFromString(string s) {
+  int base = 10;
+  int i = 0;
+  if (s.len > 1 && s.chars[0] == '0' && (s.chars[1] == 'x' || s.chars[1] == 'X')) {
+    base = 16;
+    i = 2;
+  } else if (s.len > 1 && s.chars[0] == '0' && (s.chars[1] == 'b' || s.chars[1] == 'B')) {
+    base = 2;
+    i = 2;
+  }
+
+  int start = i;
+  uint64_t value = 0;
+  for (; i < s.len; i++) {
+    int digit = digitValue(s.chars[i]);
+    if (digit == DIGIT_SEPARATOR) {
+      continue;
+    } else if (digit == DIGIT_END) {
+      break;
+    }
+    if (__builtin_mul_overflow(value, base, &value) ||
+        __builtin_add_overflow(value, digit, &value)) {
+      return bigFromDigits(s, start, base);
+    }
+  }
+  return numFromUInt64(value);
+}
+
+
+/******************************************* OPERATIONS ******************************************/
+
+
 int bitSize(Number num) {
+  size_t top = (num.size == 0) ? 0 : num.size - 1;
+  uint64_t limb = limbAt(num, top) ^ SIGN_LIMB(num.negative);
+  return 64 * top + ((limb != 0) ? 64 - __builtin_clzll(limb) : 0);
+}
+
+
+/**
+ * Two's complement numbers of the same sign compare like their limbs as unsigned integers.
+ */
+int compare(Number a, Number b) {
+  if (a.negative != b.negative) {
+    return a.negative ? -1 : 1;
+  }
+  if (a.size == 0 && b.size == 0) {
+    return (a.value > b.value) - (a.value < b.value);
+  }
+  for (size_t i = MAX(limbCount(a), limbCount(b)); i-- > 0; ) {
+    uint64_t x = limbAt(a, i);
+    uint64_t y = limbAt(b, i);
+    if (x != y) {
+      return (x > y) ? 1 : -1;
+    }
+  }
   return 0;
 }
 
 
+/**
+ * Subtracts by adding the complement of `b` and an initial carry. One extra limb takes the carry
+ * of the sum.
+ */
+static Number addLimbs(Number a, Number b, bool subtract) {
+  size_t count = MAX(limbCount(a), limbCount(b)) + 1;
+  uint64_t local[SCRATCH_LIMBS];
+  uint64_t* limbs = scratchAlloc(local, count);
+  bool carry = subtract;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t limb = limbAt(b, i);
+    limbs[i] = addCarry(limbAt(a, i), subtract ? ~limb : limb, &carry);
+  }
+  Number sum = numFromLimbs(limbs, count);
+  scratchFree(limbs, local);
+  return sum;
+}
+
+
+/**
+ * The sign bit of the 65 bit sum is `a.negative ^ b.negative ^ carry`. The sum overflows only if
+ * both operands have the same sign and the sum has another one.
+ */
 Number add(Number a, Number b) {
-  return (Number){ .value=0 };
+  if (a.size == 0 && b.size == 0) {
+    uint64_t sum;
+    bool carry = __builtin_add_overflow(a.value, b.value, &sum);
+    bool negative = a.negative ^ b.negative ^ carry;
+    if (a.negative != b.negative || negative == a.negative) {
+      return (Number){ .size=0, .negative=negative, .value=sum };
+    }
+  }
+  return addLimbs(a, b, false);
 }
 
 
+/**
+ * The difference overflows only if the operands have different signs and the difference has
+ * another sign than `a`.
+ */
 Number sub(Number a, Number b) {
-  return (Number){ .value=0 };
+  if (a.size == 0 && b.size == 0) {
+    uint64_t diff;
+    bool borrow = __builtin_sub_overflow(a.value, b.value, &diff);
+    bool negative = a.negative ^ b.negative ^ borrow;
+    if (a.negative == b.negative || negative == a.negative) {
+      return (Number){ .size=0, .negative=negative, .value=diff };
+    }
+  }
+  return addLimbs(a, b, true);
 }
 
 
 Number neg(Number a) {
-  return (Number){ .value=0 };
+  return sub(numFromInt(0), a);
 }
 
 
-string toDecString(Number num) {
-  return stringFromArray("0");
+/**
+ * Multiplies the magnitudes by schoolbook multiplication and negates the product if the signs
+ * differ. The magnitude of a number fits into as many unsigned limbs as the number has.
+ */
+static Number mulLimbs(Number a, Number b) {
+  size_t countA = limbCount(a);
+  size_t countB = limbCount(b);
+  size_t count = countA + countB + 1;
+  uint64_t local[SCRATCH_LIMBS];
+  uint64_t* x = scratchAlloc(local, countA + countB + count);
+  uint64_t* y = x + countA;
+  uint64_t* limbs = y + countB;
+
+  for (size_t i = 0; i < countA; i++) {
+    x[i] = limbAt(a, i);
+  }
+  for (size_t i = 0; i < countB; i++) {
+    y[i] = limbAt(b, i);
+  }
+  if (a.negative) {
+    negate(x, countA);
+  }
+  if (b.negative) {
+    negate(y, countB);
+  }
+
+  memset(limbs, 0, count * sizeof(uint64_t));
+  for (size_t i = 0; i < countA; i++) {
+    if (x[i] == 0) {
+      continue;
+    }
+    uint64_t carry = 0;
+    for (size_t j = 0; j < countB; j++) {
+      unsigned __int128 t = (unsigned __int128) x[i] * y[j] + limbs[i+j] + carry;
+      limbs[i+j] = (uint64_t) t;
+      carry = (uint64_t) (t >> 64);
+    }
+    limbs[i+countB] = carry;
+  }
+  if (a.negative != b.negative) {
+    negate(limbs, count);
+  }
+
+  Number product = numFromLimbs(limbs, count);
+  scratchFree(x, local);
+  return product;
 }
 
 
-string toHexString(Number num) {
-  return stringFromArray("0x");
+/**
+ * Small factors multiply within 64 bits, either both signed or both not negative.
+ */
+Number mul(Number a, Number b) {
+  if (a.size == 0 && b.size == 0) {
+    int64_t product;
+    uint64_t unsignedProduct;
+    if (a.negative == (a.value >> 63) && b.negative == (b.value >> 63) &&
+        !__builtin_mul_overflow((int64_t) a.value, (int64_t) b.value, &product)) {
+      return numFromInt64(product);
+    }
+    if (!a.negative && !b.negative &&
+        !__builtin_mul_overflow(a.value, b.value, &unsignedProduct)) {
+      return numFromUInt64(unsignedProduct);
+    }
+  }
+  return mulLimbs(a, b);
 }
 
 
-string toBinString(Number num) {
-  return stringFromArray("0b");
+/**
+ * An inline number stays inline if the shifted out bits are all equal to the sign.
+ */
+Number shiftLeft(Number a, unsigned int bits) {
+  if (a.size == 0 && bits < 64) {
+    uint64_t lost = a.negative ? ~a.value : a.value;
+    if (bits == 0 || (lost >> (64 - bits)) == 0) {
+      return (Number){ .size=0, .negative=a.negative, .value=a.value << bits };
+    }
+  }
+
+  size_t shift = bits / 64;
+  unsigned int rest = bits % 64;
+  size_t count = limbCount(a) + shift + 1;
+  uint64_t local[SCRATCH_LIMBS];
+  uint64_t* limbs = scratchAlloc(local, count);
+  memset(limbs, 0, shift * sizeof(uint64_t));
+  for (size_t i = shift; i < count; i++) {
+    uint64_t high = limbAt(a, i - shift);
+    uint64_t low = (i > shift) ? limbAt(a, i - shift - 1) : 0;
+    limbs[i] = (rest == 0) ? high : (high << rest) | (low >> (64 - rest));
+  }
+  Number num = numFromLimbs(limbs, count);
+  scratchFree(limbs, local);
+  return num;
+}
+
+
+Number shiftRight(Number a, unsigned int bits) {
+  size_t shift = bits / 64;
+  if ((a.size == 0) ? bits >= 64 : shift >= a.size) {
+    return numFromInt(a.negative ? -1 : 0);
+  }
+  if (a.size == 0) {
+    uint64_t sign = (bits == 0) ? 0 : SIGN_LIMB(a.negative) << (64 - bits);
+    return (Number){ .size=0, .negative=a.negative, .value=(a.value >> bits) | sign };
+  }
+
+  unsigned int rest = bits % 64;
+  size_t count = a.size - shift;
+  uint64_t local[SCRATCH_LIMBS];
+  uint64_t* limbs = scratchAlloc(local, count);
+  for (size_t i = 0; i < count; i++) {
+    uint64_t low = limbAt(a, i + shift);
+    uint64_t high = limbAt(a, i + shift + 1);
+    limbs[i] = (rest == 0) ? low : (low >> rest) | (high << (64 - rest));
+  }
+  Number num = numFromLimbs(limbs, count);
+  scratchFree(limbs, local);
+  return num;
+}
+
+
+/**
+ * Returns whether the unsigned limbs `r` are less than `y`, where `r` has one more limb.
+ */
+static bool lessLimbs(const uint64_t* r, const uint64_t* y, size_t count) {
+  if (r[count] != 0) {
+    return false;
+  }
+  for (size_t i = count; i-- > 0; ) {
+    if (r[i] != y[i]) {
+      return r[i] < y[i];
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Divides the magnitudes and signs the results like C does. A divisor of one limb divides limb by
+ * limb, a larger one by binary long division. The quotient replaces the dividend bit by bit.
+ */
+static void divideBig(Number a, Number b, Number* quotient, Number* remainder) {
+  size_t countA = limbCount(a);
+  size_t countB = limbCount(b);
+  uint64_t local[SCRATCH_LIMBS];
+  uint64_t* x = scratchAlloc(local, countA + 2 * countB + 2);
+  uint64_t* y = x + countA + 1;
+  uint64_t* r = y + countB;
+  size_t sizeA = magnitude(a, x);
+  size_t sizeB = magnitude(b, y);
+  memset(r, 0, (countB + 1) * sizeof(uint64_t));
+
+  if (sizeB == 1) {
+    r[0] = divideLimbs(x, &sizeA, y[0]);
+  } else {
+    for (size_t i = 64 * sizeA; i-- > 0; ) {
+      uint64_t bit = 1ull << (i % 64);
+      for (size_t k = sizeB; k > 0; k--) {
+        r[k] = (r[k] << 1) | (r[k-1] >> 63);
+      }
+      r[0] = (r[0] << 1) | ((x[i/64] & bit) != 0);
+      x[i/64] &= ~bit;
+      if (!lessLimbs(r, y, sizeB)) {
+        bool borrow = false;
+        for (size_t k = 0; k <= sizeB; k++) {
+          uint64_t yk = (k < sizeB) ? y[k] : 0;
+          bool high = __builtin_sub_overflow(r[k], yk, &r[k]);
+          high |= __builtin_sub_overflow(r[k], (uint64_t) borrow, &r[k]);
+          borrow = high;
+        }
+        x[i/64] |= bit;
+      }
+    }
+  }
+
+  x[sizeA] = 0;
+  if (a.negative != b.negative) {
+    negate(x, sizeA + 1);
+  }
+  if (a.negative) {
+    negate(r, sizeB + 1);
+  }
+  *quotient = numFromLimbs(x, sizeA + 1);
+  *remainder = numFromLimbs(r, sizeB + 1);
+  scratchFree(x, local);
+}
+
+
+/**
+ * Small operands divide natively, either both signed or both not negative. Only `INT64_MIN / -1`
+ * is out of the signed range.
+ */
+static void divideNum(Number a, Number b, Number* quotient, Number* remainder) {
+  if (a.size == 0 && b.size == 0) {
+    int64_t x = (int64_t) a.value;
+    int64_t y = (int64_t) b.value;
+    if (a.negative == (x < 0) && b.negative == (y < 0) && !(x == INT64_MIN && y == -1)) {
+      *quotient = numFromInt64(x / y);
+      *remainder = numFromInt64(x % y);
+      return;
+    }
+    if (!a.negative && !b.negative) {
+      *quotient = numFromUInt64(a.value / b.value);
+      *remainder = numFromUInt64(a.value % b.value);
+      return;
+    }
+  }
+  divideBig(a, b, quotient, remainder);
+}
+
+
+Number divide(Number a, Number b) {
+  Number quotient, remainder;
+  divideNum(a, b, &quotient, &remainder);
+  return quotient;
+}
+
+
+Number modulo(Number a, Number b) {
+  Number quotient, remainder;
+  divideNum(a, b, &quotient, &remainder);
+  return remainder;
+}
+
+
+/****************************************** FIXED WIDTH ******************************************/
+
+
+typedef enum FixedOp {
+  FIXED_ADD,
+  FIXED_SUB,
+  FIXED_MUL,
+} FixedOp;
+
+
+/**
+ * Replaces the upper `unused` bits of the limb by its sign bit if signed, otherwise by zeros.
+ */
+static inline uint64_t extend(uint64_t limb, unsigned int unused, bool isSigned) {
+  if (isSigned) {
+    return (uint64_t) ((int64_t) (limb << unused) >> unused);
+  }
+  return (limb << unused) >> unused;
+}
+
+
+static Number numFromFixed(uint64_t value, NumType type) {
+  return type.isSigned ? numFromInt64((int64_t) value) : numFromUInt64(value);
+}
+
+
+static bool isZero(Number num) {
+  return num.size == 0 && !num.negative && num.value == 0;
+}
+
+
+/**
+ * Keeps the lower bits of the two's complement limbs and extends them like the type does.
+ */
+static Number wrapNum(Number num, NumType type) {
+  if (type.bits <= 64) {
+    return numFromFixed(extend(limbAt(num, 0), 64 - type.bits, type.isSigned), type);
+  }
+
+  size_t count = (type.bits + 63) / 64;
+  uint64_t local[SCRATCH_LIMBS];
+  uint64_t* limbs = scratchAlloc(local, count + 1);
+  for (size_t i = 0; i < count; i++) {
+    limbs[i] = limbAt(num, i);
+  }
+  limbs[count-1] = extend(limbs[count-1], 64 * count - type.bits, type.isSigned);
+  limbs[count] = type.isSigned ? SIGN_LIMB(limbs[count-1] >> 63) : 0;
+  Number wrapped = numFromLimbs(limbs, count + 1);
+  scratchFree(limbs, local);
+  return wrapped;
+}
+
+
+bool fitsType(Number num, NumType type) {
+  if (type.isSigned) {
+    return bitSize(num) < type.bits;
+  }
+  return !num.negative && bitSize(num) <= type.bits;
+}
+
+
+Number minOfType(NumType type) {
+  if (!type.isSigned) {
+    return numFromInt(0);
+  }
+  if (type.bits <= 64) {
+    return numFromInt64((int64_t) (UINT64_MAX << (type.bits - 1)));
+  }
+  return neg(shiftLeft(numFromInt(1), type.bits - 1));
+}
+
+
+Number maxOfType(NumType type) {
+  unsigned int bits = type.isSigned ? type.bits - 1 : type.bits;
+  if (bits <= 64) {
+    return numFromUInt64((bits == 0) ? 0 : UINT64_MAX >> (64 - bits));
+  }
+  return sub(shiftLeft(numFromInt(1), bits), numFromInt(1));
+}
+
+
+Number toFixed(Number num, NumType type, Overflow mode, bool* overflow) {
+  bool fits = fitsType(num, type);
+  if (overflow) {
+    *overflow = !fits;
+  }
+  if (fits || mode == OVERFLOW_TRAP) {
+    return num;
+  }
+  if (mode == OVERFLOW_SATURATE) {
+    return num.negative ? minOfType(type) : maxOfType(type);
+  }
+  return wrapNum(num, type);
+}
+
+
+/**
+ * Computes by a single native instruction on 64 bits. The result wraps to the type, which is exact
+ * unless the returned flag tells an overflow of either the 64 bits or the narrower type.
+ */
+static bool nativeOp(FixedOp op, uint64_t a, uint64_t b, NumType type, uint64_t* result) {
+  bool overflow = false;
+  if (type.isSigned) {
+    int64_t r = 0;
+    switch (op) {
+      case FIXED_ADD: overflow = __builtin_add_overflow((int64_t) a, (int64_t) b, &r); break;
+      case FIXED_SUB: overflow = __builtin_sub_overflow((int64_t) a, (int64_t) b, &r); break;
+      case FIXED_MUL: overflow = __builtin_mul_overflow((int64_t) a, (int64_t) b, &r); break;
+    }
+    *result = (uint64_t) r;
+  } else {
+    switch (op) {
+      case FIXED_ADD: overflow = __builtin_add_overflow(a, b, result); break;
+      case FIXED_SUB: overflow = __builtin_sub_overflow(a, b, result); break;
+      case FIXED_MUL: overflow = __builtin_mul_overflow(a, b, result); break;
+    }
+  }
+  uint64_t wrapped = extend(*result, 64 - type.bits, type.isSigned);
+  overflow |= (wrapped != *result);
+  *result = wrapped;
+  return overflow;
+}
+
+
+/**
+ * Operands of a type up to 64 bits are inline, thus the native result is taken as is if it is
+ * exact or if it shall wrap anyway. Only saturating or trapping an overflow needs the exact result.
+ */
+static Number fixedOp(FixedOp op, Number a, Number b, NumType type, Overflow mode,
+                      bool* overflow) {
+  if (type.bits <= 64 && fitsType(a, type) && fitsType(b, type)) {
+    uint64_t result = 0;
+    bool wrapped = nativeOp(op, a.value, b.value, type, &result);
+    if (!wrapped || mode == OVERFLOW_WRAP) {
+      if (overflow) {
+        *overflow = wrapped;
+      }
+      return numFromFixed(result, type);
+    }
+  }
+  Number exact = (op == FIXED_ADD) ? add(a, b) : (op == FIXED_SUB) ? sub(a, b) : mul(a, b);
+  return toFixed(exact, type, mode, overflow);
+}
+
+
+Number addFixed(Number a, Number b, NumType type, Overflow mode, bool* overflow) {
+  return fixedOp(FIXED_ADD, a, b, type, mode, overflow);
+}
+
+
+Number subFixed(Number a, Number b, NumType type, Overflow mode, bool* overflow) {
+  return fixedOp(FIXED_SUB, a, b, type, mode, overflow);
+}
+
+
+Number negFixed(Number a, NumType type, Overflow mode, bool* overflow) {
+  return fixedOp(FIXED_SUB, numFromInt(0), a, type, mode, overflow);
+}
+
+
+Number mulFixed(Number a, Number b, NumType type, Overflow mode, bool* overflow) {
+  return fixedOp(FIXED_MUL, a, b, type, mode, overflow);
+}
+
+
+/**
+ * Shifting by the width or more leaves no bits, thus only trapping needs the exact result. A
+ * native shift overflows if shifting back does not restore the operand.
+ */
+Number shiftLeftFixed(Number a, unsigned int bits, NumType type, Overflow mode, bool* overflow) {
+  if (bits >= type.bits && mode != OVERFLOW_TRAP) {
+    bool lost = !isZero(a);
+    if (overflow) {
+      *overflow = lost;
+    }
+    if (lost && mode == OVERFLOW_SATURATE) {
+      return a.negative ? minOfType(type) : maxOfType(type);
+    }
+    return numFromInt(0);
+  }
+  if (type.bits <= 64 && bits < type.bits && fitsType(a, type)) {
+    uint64_t wrapped = extend(a.value << bits, 64 - type.bits, type.isSigned);
+    uint64_t back = type.isSigned ? (uint64_t) ((int64_t) wrapped >> bits) : wrapped >> bits;
+    if (back == a.value || mode == OVERFLOW_WRAP) {
+      if (overflow) {
+        *overflow = (back != a.value);
+      }
+      return numFromFixed(wrapped, type);
+    }
+  }
+  return toFixed(shiftLeft(a, bits), type, mode, overflow);
+}
+
+
+/******************************************** STRINGS ********************************************/
+
+
+/**
+ * **INTERNAL!** `DEC_PAIRS` holds the two digits of every number below 100, thus the decimal
+ * conversion needs one division per two digits.
+ */
+static const char DEC_PAIRS[200] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static const char HEX_DIGITS[16] = "0123456789ABCDEF";
+
+/**
+ * **INTERNAL!** `BIN_BYTES` holds the eight binary digits of every byte.
+ */
+#define BIN_BYTE(b)  { '0' + (((b) >> 7) & 1), '0' + (((b) >> 6) & 1), '0' + (((b) >> 5) & 1), \
+                       '0' + (((b) >> 4) & 1), '0' + (((b) >> 3) & 1), '0' + (((b) >> 2) & 1), \
+                       '0' + (((b) >> 1) & 1), '0' + ((b) & 1) }
+#define BIN_BYTES4(b)  BIN_BYTE(b), BIN_BYTE((b) + 1), BIN_BYTE((b) + 2), BIN_BYTE((b) + 3)
+#define BIN_BYTES16(b) BIN_BYTES4(b), BIN_BYTES4((b) + 4), BIN_BYTES4((b) + 8), BIN_BYTES4((b) + 12)
+#define BIN_BYTES64(b) BIN_BYTES16(b), BIN_BYTES16((b) + 16), BIN_BYTES16((b) + 32), \
+                       BIN_BYTES16((b) + 48)
+
+static const char BIN_BYTES[256][8] = {
+  BIN_BYTES64(0), BIN_BYTES64(64), BIN_BYTES64(128), BIN_BYTES64(192)
+};
+
+#define DEC_CHUNK_DIGITS 19
+#define DEC_CHUNK        10000000000000000000ull  // 10^19, the largest power of ten in 64 bits
+
+
+static int decDigits(uint64_t value) {
+  int digits = 1;
+  for (uint64_t limit = 10; digits < 20 && value >= limit; limit *= 10) {
+    digits++;
+  }
+  return digits;
+}
+
+
+/**
+ * Writes the decimal digits backwards from the end, two at a time. Returns the first digit.
+ */
+static char* writeDecimal(char* end, uint64_t value) {
+  while (value >= 100) {
+    end -= 2;
+    memcpy(end, &DEC_PAIRS[2 * (value % 100)], 2);
+    value /= 100;
+  }
+  if (value >= 10) {
+    end -= 2;
+    memcpy(end, &DEC_PAIRS[2 * value], 2);
+  } else {
+    *--end = '0' + value;
+  }
+  return end;
+}
+
+
+/**
+ * Writes a lower chunk of a large number with all its leading zeros.
+ */
+static void writeDecimalChunk(char* end, uint64_t value) {
+  for (int i = 0; i < DEC_CHUNK_DIGITS / 2; i++) {
+    end -= 2;
+    memcpy(end, &DEC_PAIRS[2 * (value % 100)], 2);
+    value /= 100;
+  }
+  *--end = '0' + value;
+}
+
+
+/**
+ * Spreads the digits to insert a `'_'` after every group of digits, counted from the right. The
+ * digits are moved from the end, thus the buffer must have room for the separators.
+ */
+static void groupDigits(char* digits, size_t count, size_t group) {
+  size_t separators = (count - 1) / group;
+  char* to = digits + count + separators;
+  const char* from = digits + count;
+  for (size_t i = 1; separators > 0; i++) {
+    *--to = *--from;
+    if (i % group == 0) {
+      *--to = '_';
+      separators--;
+    }
+  }
+}
+
+
+/**
+ * Puts the sign and the prefix in front of the digits and groups them. Returns the length of the
+ * literal, but writes it only if it fits into the buffer.
+ */
+static size_t writeLiteral(Number num, const char* prefix, size_t digits, size_t group,
+                           bool grouped, char* chars, size_t size, char** start) {
+  size_t head = num.negative + strlen(prefix);
+  size_t length = head + digits + (grouped ? (digits - 1) / group : 0);
+  *start = NULL;
+  if (length < size) {
+    if (num.negative) {
+      chars[0] = '-';
+    }
+    memcpy(&chars[num.negative], prefix, strlen(prefix));
+    chars[length] = '\0';
+    *start = &chars[head];
+  }
+  return length;
+}
+
+
+/**
+ * Numbers up to 64 bits are written directly. Larger ones are divided into chunks of 19 digits
+ * first, which come out from the lowest. The magnitude and the chunks share the scratch.
+ */
+size_t toDecString(Number num, char* chars, size_t size, bool grouped, uint64_t* scratch) {
+  uint64_t local[6];  // NUM_DEC_SCRATCH() of an inline number
+  uint64_t* limbs = (scratch != NULL) ? scratch : local;
+  uint64_t* chunks = limbs + limbCount(num);
+  size_t count = magnitude(num, limbs);
+  size_t chunkCount = 0;
+  while (count > 1 || limbs[0] >= DEC_CHUNK) {
+    chunks[chunkCount++] = divideLimbs(limbs, &count, DEC_CHUNK);
+  }
+  chunks[chunkCount] = limbs[0];
+
+  size_t digits = chunkCount * DEC_CHUNK_DIGITS + decDigits(chunks[chunkCount]);
+  char* start;
+  size_t length = writeLiteral(num, "", digits, 3, grouped, chars, size, &start);
+  if (start != NULL) {
+    char* end = start + digits;
+    for (size_t i = 0; i < chunkCount; i++, end -= DEC_CHUNK_DIGITS) {
+      writeDecimalChunk(end, chunks[i]);
+    }
+    writeDecimal(end, chunks[chunkCount]);
+    if (grouped) {
+      groupDigits(start, digits, 3);
+    }
+  }
+  return length;
+}
+
+
+/**
+ * The digits are written from the lowest, while the magnitude is negated limb by limb.
+ */
+size_t toHexString(Number num, char* chars, size_t size, bool grouped) {
+  uint64_t top;
+  size_t count = magnitudeTop(num, &top);
+  size_t digits = (count - 1) * 16 + ((top == 0) ? 1 : (67 - __builtin_clzll(top)) / 4);
+
+  char* start;
+  size_t length = writeLiteral(num, "0x", digits, 4, grouped, chars, size, &start);
+  if (start != NULL) {
+    char* it = start + digits;
+    bool carry = true;
+    for (size_t i = 0; i < count; i++) {
+      uint64_t limb = magnitudeAt(num, i, &carry);
+      for (int k = 0; k < 16 && it != start; k++, limb >>= 4) {
+        *--it = HEX_DIGITS[limb & 0xF];
+      }
+    }
+    if (grouped) {
+      groupDigits(start, digits, 4);
+    }
+  }
+  return length;
+}
+
+
+/**
+ * The digits are written a byte at a time, like the hex digits from the lowest limb of the
+ * magnitude. The highest byte is cut to its significant digits.
+ */
+size_t toBinString(Number num, char* chars, size_t size, bool grouped) {
+  uint64_t top;
+  size_t count = magnitudeTop(num, &top);
+  size_t digits = (count - 1) * 64 + ((top == 0) ? 1 : 64 - __builtin_clzll(top));
+
+  char* start;
+  size_t length = writeLiteral(num, "0b", digits, 8, grouped, chars, size, &start);
+  if (start != NULL) {
+    char* it = start + digits;
+    bool carry = true;
+    for (size_t i = 0; i < count; i++) {
+      uint64_t limb = magnitudeAt(num, i, &carry);
+      for (int k = 0; k < 8 && it != start; k++, limb >>= 8) {
+        size_t n = (it - start < 8) ? it - start : 8;
+        it -= n;
+        memcpy(it, &BIN_BYTES[limb & 0xFF][8 - n], n);
+      }
+    }
+    if (grouped) {
+      groupDigits(start, digits, 8);
+    }
+  }
+  return length;
 }
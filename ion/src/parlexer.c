@@ -0,0 +1,220 @@
+#include "parlexer.h"
+
+#include "lexer.h"
+#include "sbuffer.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+
+#define MIN(a, b) ((a) <= (b) ? (a) : (b))
+#define MAX(a, b) ((a) >= (b) ? (a) : (b))
+
+#define MIN_CHUNK_SIZE (64 * 1024)
+
+
+/**
+ * **INTERNAL!** `ChunkJob` lexes the tokens that start within `[start, end)`. A speculative job
+ * assumes the chunk starts inside a multi-line comment and skips it first. `restart` is the
+ * offset the lexing started at, `exit` is the end of the last token or `restart` if there is
+ * none. The last token of a chunk may reach far into the next chunks.
+ */
+typedef struct ChunkJob {
+  size_t     start;
+  size_t     end;
+  bool       inComment;
+  size_t     restart;
+  size_t     exit;
+  TokenArray tokens;
+} ChunkJob;
+
+
+/**
+ * **INTERNAL!** `JobQueue` is shared by the workers, which take the next job by incrementing
+ * `next`.
+ */
+typedef struct JobQueue {
+  const Source*   source;
+  ChunkJob*       jobs;
+  size_t          count;
+  size_t          next;
+  pthread_mutex_t mutex;
+} JobQueue;
+
+
+/**
+ * Returns the offset after the first comment closing at or after `offset`, or the length of the
+ * content if the comment is unclosed.
+ */
+static size_t skipComment(const Source* src, size_t offset) {
+  const char* chars = src->content.chars;
+  size_t length = src->content.len;
+  while (offset + 1 < length) {
+    const char* star = memchr(&chars[offset], '*', length - offset - 1);
+    if (star == NULL) {
+      break;
+    }
+    offset = star - chars + 1;
+    if (chars[offset] == '/') {
+      return offset + 1;
+    }
+  }
+  return length;
+}
+
+
+/**
+ * The token that starts at or after the end of the chunk was lexed in vain. Its error record is
+ * dropped, as the next chunk records it again.
+ */
+static void lexChunk(const Source* src, ChunkJob* job, size_t restart) {
+  job->tokens = (TokenArray){ .source=src };
+  job->restart = restart;
+  job->exit = restart;
+  if (restart >= job->end) {
+    return;
+  }
+
+  Lexer lexer = lexerFromOffset(src, restart);
+  while (true) {
+    Token token = nextToken(&lexer);
+    if (lexer.mark >= job->end) {
+      if (token.kind == TOKEN_ERROR) {
+        sbufPop(lexer.errors);
+      }
+      break;
+    }
+    appendToken(&job->tokens, token);
+    job->exit = lexer.mark + token.chars.len;
+    if (token.kind == TOKEN_EOF) {
+      break;
+    }
+  }
+  job->tokens.errors = lexer.errors;  // the chunk takes over the records
+}
+
+
+static void* lexWorker(void* arg) {
+  JobQueue* queue = (JobQueue*) arg;
+
+  while (true) {
+    pthread_mutex_lock(&queue->mutex);
+    size_t index = queue->next++;
+    pthread_mutex_unlock(&queue->mutex);
+    if (index >= queue->count) {
+      return NULL;
+    }
+
+    ChunkJob* job = &queue->jobs[index];
+    size_t restart = job->inComment ? skipComment(queue->source, job->start) : job->start;
+    lexChunk(queue->source, job, restart);
+  }
+}
+
+
+#define APPEND(dst, src) \
+        do { \
+          if (sbufLength(src) > 0) { \
+            sbufFit(dst, sbufLength(src)); \
+            memcpy(sbufEnd(dst), src, sbufLength(src) * sizeof(*(src))); \
+            sbufSetLength(dst, sbufLength(dst) + sbufLength(src)); \
+          } \
+        } while (0)
+
+
+static void appendTokens(TokenArray* tokens, const TokenArray* chunk) {
+  uint32_t first = tokenCount(tokens);
+  APPEND(tokens->kinds, chunk->kinds);
+  APPEND(tokens->subkinds, chunk->subkinds);
+  APPEND(tokens->offsets, chunk->offsets);
+  APPEND(tokens->lengths, chunk->lengths);
+  APPEND(tokens->errors, chunk->errors);
+  for (const TokenValue* it = chunk->values; it != sbufEnd(chunk->values); it++) {
+    sbufPush(tokens->values, (TokenValue){ .index=first + it->index, .value=it->value });
+  }
+}
+
+
+/**
+ * The chunk boundaries are spread evenly and moved behind the next newline. The jobs of chunk `k`
+ * are `jobs[2k-1]` (from the start) and `jobs[2k]` (inside a comment), the first chunk has only
+ * one job. The last chunk ends behind the content, such that it also gets the `TOKEN_EOF`.
+ */
+TokenArray lexParallel(const Source* src, int threads) {
+  if (threads <= 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cores > 0) ? cores : 1;
+  }
+  size_t length = src->content.len;
+  size_t chunks = MIN((size_t) threads, length / MIN_CHUNK_SIZE);
+  if (chunks <= 1 || length > TOKEN_ARRAY_MAX_CONTENT) {
+    return lexSource(src);
+  }
+
+  SBUF(size_t) starts = NULL;
+  sbufPush(starts, 0);
+  for (size_t k = 1; k < chunks; k++) {
+    size_t split = MAX(k * length / chunks, starts[sbufLength(starts)-1]);
+    const char* newline = memchr(&src->content.chars[split], '\n', length - split);
+    if (newline == NULL) {
+      break;
+    }
+    size_t start = newline - src->content.chars + 1;
+    if (start < length) {
+      sbufPush(starts, start);
+    }
+  }
+  chunks = sbufLength(starts);
+
+  SBUF(ChunkJob) jobs = NULL;
+  for (size_t k = 0; k < chunks; k++) {
+    size_t end = (k + 1 < chunks) ? starts[k+1] : length + 1;
+    sbufPush(jobs, (ChunkJob){ .start=starts[k], .end=end, .inComment=false });
+    if (k > 0) {
+      sbufPush(jobs, (ChunkJob){ .start=starts[k], .end=end, .inComment=true });
+    }
+  }
+
+  JobQueue queue = { .source=src, .jobs=jobs, .count=sbufLength(jobs), .next=0 };
+  pthread_mutex_init(&queue.mutex, NULL);
+  threads = MIN((size_t) threads, queue.count);  // there might be fewer chunks than threads
+  SBUF(pthread_t) workers = NULL;
+  for (int i = 1; i < threads; i++) {
+    pthread_t worker;
+    if (pthread_create(&worker, NULL, lexWorker, &queue) == 0) {
+      sbufPush(workers, worker);
+    }
+  }
+  lexWorker(&queue);  // the calling thread helps out
+  for (pthread_t* it = workers; it != sbufEnd(workers); it++) {
+    pthread_join(*it, NULL);
+  }
+  sbufFree(workers);
+  pthread_mutex_destroy(&queue.mutex);
+
+  TokenArray tokens = { .source=src, .kinds=NULL, .subkinds=NULL, .offsets=NULL, .lengths=NULL,
+                        .values=NULL, .errors=NULL
+                      };
+  size_t exit = 0;
+  for (size_t k = 0; k < chunks; k++) {
+    size_t restart = MAX(exit, starts[k]);
+    ChunkJob* job = &jobs[(k == 0) ? 0 : 2*k - 1];
+    if (job->restart != restart && k > 0) {
+      job = &jobs[2*k];
+    }
+    if (job->restart != restart) {  // neither guess was right
+      deleteTokenArray(&job->tokens);
+      lexChunk(src, job, restart);
+    }
+    appendTokens(&tokens, &job->tokens);
+    exit = MAX(restart, job->exit);
+  }
+
+  for (ChunkJob* it = jobs; it != sbufEnd(jobs); it++) {
+    deleteTokenArray(&it->tokens);
+  }
+  sbufFree(jobs);
+  sbufFree(starts);
+  return tokens;
+}
@@ -4,7 +4,9 @@
 #include "lexer.h"
 #include "error.h"
 #include "strintern.h"
+#include "tokenqueue.h"
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -12,23 +14,48 @@
 /********************************************* PARSER ********************************************/
 
 
+/**
+ * **INTERNAL!** The parser reads the tokens either on demand from a lexer, from an already lexed
+ * token array or from a queue filled by a lexer thread, whichever is given.
+ */
 typedef struct Parser {
-  Lexer* lexer;
-  Token  currentToken;
-  Token  nextToken;
+  Lexer*         lexer;
+  TokenIterator* tokens;
+  TokenQueue*    queue;
+  Token          currentToken;
+  Token          nextToken;
 } Parser;
 
 
-static Parser createParser(Lexer* lexer) {
-  return (Parser){ .lexer=lexer, .currentToken=(Token){ .kind=TOKEN_NONE },
+static Parser createParser(Lexer* lexer, TokenIterator* tokens, TokenQueue* queue) {
+  return (Parser){ .lexer=lexer, .tokens=tokens, .queue=queue,
+                   .currentToken=(Token){ .kind=TOKEN_NONE },
                    .nextToken=(Token){ .kind=TOKEN_NONE }
                  };
 }
 
 
+/**
+ * The lexer drops the comments itself, but a token array contains them and they are skipped here.
+ */
+static Token fetch(Parser* parser) {
+  if (parser->queue != NULL) {
+    return queuePop(parser->queue);
+  }
+  if (parser->tokens == NULL) {
+    return nextToken(parser->lexer);
+  }
+  Token token = iteratorNext(parser->tokens);
+  while (token.kind == TOKEN_COMMENT) {
+    token = iteratorNext(parser->tokens);
+  }
+  return token;
+}
+
+
 static Token next(Parser* parser) {
   if (parser->nextToken.kind == TOKEN_NONE) {
-    parser->currentToken = nextToken(parser->lexer);
+    parser->currentToken = fetch(parser);
   } else {
     parser->currentToken = parser->nextToken;
     parser->nextToken = (Token){ .kind=TOKEN_NONE };
@@ -39,45 +66,12 @@ static Token next(Parser* parser) {
 
 static Token peek(Parser* parser) {
   if (parser->nextToken.kind == TOKEN_NONE) {
-    parser->nextToken = nextToken(parser->lexer);
+    parser->nextToken = fetch(parser);
   }
   return parser->nextToken;
 }
 
 
-static string LPAREN;
-static string RPAREN;
-static string UNOP_PLUS;
-static string UNOP_MINUS;
-static string UNOP_NOT;
-static string UNOP_NEG;
-static string BINOP_ADD;
-static string BINOP_SUB;
-static string BINOP_MUL;
-static string BINOP_DIV;
-static string BINOP_MOD;
-
-
-static bool initialized = false;
-static void init() {
-  if (!initialized) {
-    strintern("() !~+-*/%");
-    LPAREN = strintern("(");
-    RPAREN = strintern(")");
-    UNOP_PLUS = strintern("+");
-    UNOP_MINUS = strintern("-");
-    UNOP_NOT = strintern("!");
-    UNOP_NEG = strintern("~");
-    BINOP_ADD = strintern("+");
-    BINOP_SUB = strintern("-");
-    BINOP_MUL = strintern("*");
-    BINOP_DIV = strintern("/");
-    BINOP_MOD = strintern("%");
-    initialized = true;
-  }
-}
-
-
 /****************************************** CREATE NODES *****************************************/
 
 
@@ -101,7 +95,7 @@ static ASTNode* createErrorNode() {
 static ASTNode* createTokenNoneError(const Parser* parser) {
   Token token = parser->currentToken;
   ASTNode* node = createErrorNode();
-  string msg = generateError(token.source, token.start, token.start, token.end,
+  string msg = generateError(token.source, tokenStart(token), tokenStart(token), tokenEnd(token),
                              "Token[TOKEN_NONE] should not appear - how did it happen?");
   sbufPush(node->messages, msg);
   node->faultyNode = createEmptyNode();
@@ -113,9 +107,10 @@ static ASTNode* createUnexpectedTokenError(const Parser* parser) {
   Token token = parser->currentToken;
   ASTNode* node = createErrorNode();
   if (token.kind == TOKEN_ERROR) {
-    sbufPush(node->messages, token.error->message);
+    Error error = errorFromToken(token);
+    sbufPush(node->messages, error.message);  // the node takes over the message
   } else {
-    string msg = generateError(token.source, token.start, token.start, token.end,
+    string msg = generateError(token.source, tokenStart(token), tokenStart(token), tokenEnd(token),
                                (token.chars.len > 0) ? "unexpected Token[%s %.*s]"
                                                      : "unexpected Token[%s]",
                                strTokenKind(token.kind), token.chars.len, token.chars.chars);
@@ -146,11 +141,11 @@ static ASTNode* parseExprParen(Parser* parser) {
   ASTNode* node = createExprNode(EXPR_PAREN);
   Token lparen = parser->currentToken;
   Token rparen = peek(parser);
-  if (rparen.kind == TOKEN_SYMBOL && strequal(rparen.chars, RPAREN)) {
+  if (rparen.kind == TOKEN_SYMBOL && rparen.symbol == SYMBOL_RPAREN) {
     next(parser);
     ASTNode* error = createErrorNode();
     sbufPush(error->messages,
-             generateError(parser->lexer->source, lparen.start, rparen.start, rparen.end,
+             generateError(lparen.source, tokenStart(lparen), tokenStart(rparen), tokenEnd(rparen),
                            "missing expression"));
     node->expr.expr = createEmptyNode();
     error->faultyNode = node;
@@ -159,16 +154,16 @@ static ASTNode* parseExprParen(Parser* parser) {
 
   node->expr.expr = parseExpr(parser);
   rparen = peek(parser);
-  if (rparen.kind == TOKEN_SYMBOL && strequal(rparen.chars, RPAREN)) {
+  if (rparen.kind == TOKEN_SYMBOL && rparen.symbol == SYMBOL_RPAREN) {
     next(parser);
     return node;
   } else {
     ASTNode* error = createErrorNode();
     sbufPush(error->messages,
-             generateError(parser->lexer->source, lparen.start, rparen.end, rparen.end,
+             generateError(lparen.source, tokenStart(lparen), tokenEnd(rparen), tokenEnd(rparen),
                            "missing closing ')'"));
     sbufPush(error->messages,
-             generateNote(parser->lexer->source, lparen.start, lparen.start, lparen.end,
+             generateNote(lparen.source, tokenStart(lparen), tokenStart(lparen), tokenEnd(lparen),
                           "to match this '('"));
     error->faultyNode = node;
     return error;
@@ -187,7 +182,14 @@ static ASTNode* parseExprName(Parser* parser) {
 
 static ASTNode* parseExprInt(Parser* parser) {
   ASTNode* node = createExprNode(EXPR_INT);
-  node->expr.value = numFromString(parser->currentToken.chars);
+  node->expr.constant = constIntern(numFromUInt64(parser->currentToken.value));
+  return node;
+}
+
+
+static ASTNode* parseExprFloat(Parser* parser) {
+  ASTNode* node = createExprNode(EXPR_FLOAT);
+  node->expr.floatValue = parser->currentToken.floatValue;
   return node;
 }
 
@@ -196,17 +198,17 @@ static ASTNode* parseExprUnop(Parser* parser) {
   Token token = parser->currentToken;
   ASTNode* rhs = parseTerm(parser);
   ASTNode* node = createExprNode(EXPR_UNOP);
-  node->expr.op = strinternRange(token.chars.chars, token.chars.chars + token.chars.len);
+  node->expr.op = stringFromArray(symbolChars(token.symbol));
   node->expr.rhs = rhs;
   if (rhs->kind == AST_EXPR) {
     return node;
   } else {
     ASTNode* error = createErrorNode();
     Token current = parser->currentToken;
-    string msg = generateError(current.source, current.start, current.start, current.end,
-                             "missing operand");
+    string msg = generateError(current.source, tokenStart(current), tokenStart(current),
+                               tokenEnd(current), "missing operand");
     sbufPush(error->messages, msg);
-    string note = generateNote(token.source, token.start, token.start, token.end,
+    string note = generateNote(token.source, tokenStart(token), tokenStart(token), tokenEnd(token),
                                "for unary operator %.*s", token.chars.len, token.chars.chars);
     sbufPush(error->messages, note);
     error->faultyNode = node;
@@ -219,7 +221,7 @@ static ASTNode* parseExprBinop(Parser* parser, ASTNode* lhs) {
   Token token = next(parser);
   ASTNode* rhs = parseExpr(parser);
   ASTNode* node = createExprNode(EXPR_BINOP);
-  node->expr.op = strinternRange(token.chars.chars, token.chars.chars + token.chars.len);
+  node->expr.op = stringFromArray(symbolChars(token.symbol));
   node->expr.lhs = lhs;
   node->expr.rhs = rhs;
   if (rhs->kind == AST_EXPR || true) {
@@ -233,10 +235,10 @@ static ASTNode* parseExprBinop(Parser* parser, ASTNode* lhs) {
   } else {
     ASTNode* error = createErrorNode();
     Token current = parser->currentToken;
-    string msg = generateError(current.source, current.start, current.start, current.end,
-                             "missing operand");
+    string msg = generateError(current.source, tokenStart(current), tokenStart(current),
+                               tokenEnd(current), "missing operand");
     sbufPush(error->messages, msg);
-    string note = generateNote(token.source, token.start, token.start, token.end,
+    string note = generateNote(token.source, tokenStart(token), tokenStart(token), tokenEnd(token),
                                "for binary operator %.*s", token.chars.len, token.chars.chars);
     sbufPush(error->messages, note);
     error->faultyNode = node;
@@ -254,22 +256,31 @@ static ASTNode* parseTerm(Parser* parser) {
     case TOKEN_INT:
       return parseExprInt(parser);
 
+    case TOKEN_FLOAT:
+      return parseExprFloat(parser);
+
     case TOKEN_SYMBOL:
-      if (strequal(token.chars, UNOP_PLUS) ||
-          strequal(token.chars, UNOP_MINUS) ||
-          strequal(token.chars, UNOP_NOT) ||
-          strequal(token.chars, UNOP_NEG)) {
-        return parseExprUnop(parser);
-      } else if (strequal(token.chars, LPAREN)) {
-//        return parseExprParen(parser);
-      } else {
-        ASTNode* error = createErrorNode();
-        string msg = generateError(token.source, token.start, token.start, token.end,
-                                   "invalid unary operator %.*s",
-                                   token.chars.len, token.chars.chars);
-        sbufPush(error->messages, msg);
-        error->faultyNode = createEmptyNode();
-        return error;
+      switch (token.symbol) {
+        case SYMBOL_PLUS:
+        case SYMBOL_MINUS:
+        case SYMBOL_NOT:
+        case SYMBOL_TILDE:
+          return parseExprUnop(parser);
+
+        case SYMBOL_LPAREN:
+//          return parseExprParen(parser);
+          return createUnexpectedTokenError(parser);
+
+        default:
+        {
+          ASTNode* error = createErrorNode();
+          string msg = generateError(token.source, tokenStart(token), tokenStart(token),
+                                     tokenEnd(token), "invalid unary operator %.*s",
+                                     token.chars.len, token.chars.chars);
+          sbufPush(error->messages, msg);
+          error->faultyNode = createEmptyNode();
+          return error;
+        }
       }
 
     default:
@@ -284,12 +295,16 @@ static ASTNode* parseExpr(Parser* parser) {
   Token token = peek(parser);
   switch (token.kind) {
     case TOKEN_SYMBOL:
-      if (strequal(token.chars, BINOP_ADD) ||
-          strequal(token.chars, BINOP_SUB) ||
-          strequal(token.chars, BINOP_MUL) ||
-          strequal(token.chars, BINOP_DIV) ||
-          strequal(token.chars, BINOP_MOD)) {
-        return parseExprBinop(parser, term);
+      switch (token.symbol) {
+        case SYMBOL_PLUS:
+        case SYMBOL_MINUS:
+        case SYMBOL_STAR:
+        case SYMBOL_SLASH:
+        case SYMBOL_PERCENT:
+          return parseExprBinop(parser, term);
+
+        default:
+          return term;
       }
 
     default:
@@ -311,7 +326,7 @@ static ASTNode* parseStart(Parser* parser) {
     return node;
   } else {
     ASTNode* error = createErrorNode();
-    string msg = generateError(token.source, token.start, token.start, token.end,
+    string msg = generateError(token.source, tokenStart(token), tokenStart(token), tokenEnd(token),
                                "expected Token[TOKEN_EOF]");
     sbufPush(error->messages, msg);
     error->faultyNode = node;
@@ -321,10 +336,49 @@ static ASTNode* parseStart(Parser* parser) {
 
 
 ASTNode* parse(const Source* src) {
-  init();
-  Lexer lexer = lexerFromSource(src);
-  Parser parser = createParser(&lexer);
+  Lexer lexer = lexerFromSourceWith(src, TRIVIA_DROP);
+  Parser parser = createParser(&lexer, NULL, NULL);
+  ASTNode* node = parseStart(&parser);
+  deleteLexer(&lexer);
+  return node;
+}
+
+
+ASTNode* parseTokens(const TokenArray* tokens) {
+  TokenIterator it = iteratorFromTokens(tokens);
+  Parser parser = createParser(NULL, &it, NULL);
+  return parseStart(&parser);
+}
+
+
+static void* lexIntoQueue(void* arg) {
+  TokenQueue* queue = (TokenQueue*) arg;
+  Lexer lexer = lexerFromSourceWith(queue->source, TRIVIA_DROP);
+  Token token;
+  do {
+    token = nextToken(&lexer);
+  } while (queuePush(queue, token) && token.kind != TOKEN_EOF);
+  deleteLexer(&lexer);
+  return NULL;
+}
+
+
+/**
+ * The parser may stop before the `TOKEN_EOF` on an error, thus the queue is closed to release a
+ * lexer thread that waits for space.
+ */
+ASTNode* parsePipelined(const Source* src) {
+  TokenQueue queue = createTokenQueue(src);
+  pthread_t lexer;
+  if (pthread_create(&lexer, NULL, lexIntoQueue, &queue) != 0) {
+    deleteTokenQueue(&queue);
+    return parse(src);
+  }
+
+  Parser parser = createParser(NULL, NULL, &queue);
   ASTNode* node = parseStart(&parser);
-  initialized = false;
+  closeTokenQueue(&queue);
+  pthread_join(lexer, NULL);
+  deleteTokenQueue(&queue);
   return node;
 }
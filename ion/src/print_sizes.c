@@ -1,5 +1,6 @@
 #include "arena.h"
 #include "ast.h"
+#include "cache.h"
 #include "error.h"
 #include "lexer.h"
 #include "loc.h"
@@ -8,7 +9,10 @@
 #include "sbuffer.h"
 #include "source.h"
 #include "str.h"
+#include "stream.h"
 #include "token.h"
+#include "tokenarray.h"
+#include "tokenqueue.h"
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -52,6 +56,15 @@ int main() {
   PRINT_SIZE(Source);
   printf("\n");
 
+  printf("<stream.h>\n");
+  PRINT_SIZE(SourceStream);
+  printf("\n");
+
+  printf("<cache.h>\n");
+  PRINT_SIZE(CacheEntry);
+  PRINT_SIZE(SourceCache);
+  printf("\n");
+
   printf("<loc.h>\n");
   PRINT_SIZE(Location);
   printf("\n");
@@ -62,13 +75,34 @@ int main() {
 
   printf("<token.h>\n");
   PRINT_SIZE(TokenKind);
+  PRINT_SIZE(Keyword);
+  PRINT_SIZE(LexErrorKind);
+  PRINT_SIZE(LexError);
+  PRINT_SIZE(Symbol);
   PRINT_SIZE(Token);
   printf("\n");
 
   printf("<lexer.h>\n");
+  PRINT_SIZE(TriviaMode);
+  PRINT_SIZE(TriviaKind);
+  PRINT_SIZE(Trivia);
+  PRINT_SIZE(TextEdit);
+  PRINT_SIZE(TokenRange);
+  PRINT_SIZE(LineState);
+  PRINT_SIZE(TokenSpan);
   PRINT_SIZE(Lexer);
   printf("\n");
 
+  printf("<tokenarray.h>\n");
+  PRINT_SIZE(TokenArray);
+  PRINT_SIZE(TokenIterator);
+  printf("\n");
+
+  printf("<tokenqueue.h>\n");
+  PRINT_SIZE(QueuedToken);
+  PRINT_SIZE(TokenQueue);
+  printf("\n");
+
   printf("<ast.h>\n");
   PRINT_SIZE(ExprKind);
   PRINT_SIZE(ASTExpr);
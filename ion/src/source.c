@@ -3,12 +3,193 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "simd.h"
+
+
+/**
+ * Returns the length of a well-formed UTF-8 sequence starting with a non-ASCII byte or `0` if the
+ * sequence is malformed. Overlong encodings, surrogates and code points beyond U+10FFFF are
+ * rejected as specified by RFC 3629. Only the available bytes are checked, thus a sequence that is
+ * cut by the end but valid so far returns a length beyond them.
+ */
+static size_t utf8SequenceLength(const unsigned char* s, size_t available) {
+  unsigned char c = s[0];
+  size_t length;
+  unsigned char min = 0x80;
+  unsigned char max = 0xBF;
+
+  if (c >= 0xC2 && c <= 0xDF) {
+    length = 2;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    length = 3;
+    min = (c == 0xE0) ? 0xA0 : 0x80;
+    max = (c == 0xED) ? 0x9F : 0xBF;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    length = 4;
+    min = (c == 0xF0) ? 0x90 : 0x80;
+    max = (c == 0xF4) ? 0x8F : 0xBF;
+  } else {
+    return 0;
+  }
+
+  if (available < 2) {
+    return length;
+  }
+  if (s[1] < min || s[1] > max) {
+    return 0;
+  }
+  for (size_t i = 2; i < length && i < available; i++) {
+    if (s[i] < 0x80 || s[i] > 0xBF) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+
+/**
+ * Replaces the content by the error message at the current position of the written content.
+ */
+static void rejectSource(Source* source, size_t write, const char* reason) {
+  size_t line = sbufLength(source->lines);
+  size_t pos = write - source->lines[line-1] + 1;
+  free((char*) source->content.chars);
+  sbufFree(source->lines);
+  source->content = stringFromPrint("ERROR: %s at %zu:%zu", reason, line, pos);
+  source->status = SOURCE_ERROR;
+}
+
+
+/**
+ * Validates the content, normalizes CRLF if requested and builds the line index, all in a single
+ * pass. SIMD blocks of ASCII bytes without `'\r'` are handled at once and their newlines are
+ * found by a bit mask. Everything else is handled byte by byte. Normalization compacts the content
+ * in place, thus `write` lags behind `read` once the first CRLF was dropped.
+ */
+static void prepareSource(Source* source, SourceOptions options) {
+  char* chars = (char*) source->content.chars;
+  size_t length = source->content.len;
+  bool normalize = (options & SOURCE_NORMALIZE_CRLF) != 0;
+  size_t read = 0;
+  size_t write = 0;
+  sbufPush(source->lines, 0);
+
+  while (read < length) {
+#ifdef SIMD_WIDTH
+    if (read + SIMD_WIDTH <= length) {
+      SimdBlock block = simdLoad(chars + read);
+      uint32_t special = simdMask(block);  // bytes with the high bit set
+      special |= simdMask(simdEqual(block, simdSet('\0')));
+      if (normalize) {
+        special |= simdMask(simdEqual(block, simdSet('\r')));
+      }
+      if (special == 0) {
+        uint32_t newlines = simdMask(simdEqual(block, simdSet('\n')));
+        if (write != read) {
+          simdStore(chars + write, block);
+        }
+        for (; newlines != 0; newlines &= newlines - 1) {
+          sbufPush(source->lines, write + __builtin_ctz(newlines) + 1);
+        }
+        read += SIMD_WIDTH;
+        write += SIMD_WIDTH;
+        continue;
+      }
+    }
+#endif
+
+    unsigned char c = chars[read];
+    if (c == '\0') {
+      rejectSource(source, write, "NUL character");  // the lexer would take it as the end
+      return;
+    }
+    if (c < 0x80) {
+      if (c == '\r' && normalize && read + 1 < length && chars[read+1] == '\n') {
+        ++read;  // drop '\r', the '\n' is copied next
+        continue;
+      }
+      chars[write++] = chars[read++];
+      if (c == '\n') {
+        sbufPush(source->lines, write);
+      }
+      continue;
+    }
+
+    size_t n = utf8SequenceLength((const unsigned char*) chars + read, length - read);
+    if (n == 0 || n > length - read) {
+      rejectSource(source, write, "invalid UTF-8");
+      return;
+    }
+    memmove(chars + write, chars + read, n);
+    read += n;
+    write += n;
+  }
+
+  chars[write] = '\0';
+  source->content.len = write;
+}
+
+
+/**
+ * The SIMD blocks of ASCII bytes without `'\0'` are skipped at once, like in `prepareSource()`.
+ */
+size_t validContent(const char* chars, size_t length, bool* cut) {
+  if (cut != NULL) {
+    *cut = false;
+  }
+  size_t i = 0;
+  while (i < length) {
+#ifdef SIMD_WIDTH
+    if (i + SIMD_WIDTH <= length) {
+      SimdBlock block = simdLoad(chars + i);
+      if ((simdMask(block) | simdMask(simdEqual(block, simdSet('\0')))) == 0) {
+        i += SIMD_WIDTH;
+        continue;
+      }
+    }
+#endif
+
+    unsigned char c = chars[i];
+    if (c == '\0') {
+      return i;
+    }
+    if (c < 0x80) {
+      ++i;
+      continue;
+    }
+    size_t n = utf8SequenceLength((const unsigned char*) chars + i, length - i);
+    if (n == 0) {
+      return i;
+    }
+    if (n > length - i) {
+      if (cut != NULL) {
+        *cut = true;
+      }
+      return i;
+    }
+    i += n;
+  }
+  return i;
+}
+
 
 Source sourceFromString(const char* src) {
-  return (Source){ .fileName=stringFromArray(strdup("<cstring>")),
-                   .content=stringFromArray(strdup(src)),
-                   .status=SOURCE_OK
-                 };
+  return sourceFromStringWith(src, SOURCE_DEFAULT);
+}
+
+
+Source sourceFromStringWith(const char* src, SourceOptions options) {
+  Source source = { .fileName=stringFromArray(strdup("<cstring>")),
+                    .content=stringFromArray(strdup(src)),
+                    .status=SOURCE_OK, .firstLine=1, .lines=NULL
+                  };
+  prepareSource(&source, options);
+  return source;
+}
+
+
+Source sourceFromFile(const char* fileName) {
+  return sourceFromFileWith(fileName, SOURCE_DEFAULT);
 }
 
 
@@ -16,7 +197,7 @@ Source sourceFromString(const char* src) {
  * Opens the file and calculates the file size. Then allocates this amount of memory and reads in
  * the file content. If errors occured stores an error message.
  */
-Source sourceFromFile(const char* fileName) {
+Source sourceFromFileWith(const char* fileName, SourceOptions options) {
   char* name = strdup(fileName);
   char* content;
   SourceStatus status = SOURCE_OK;
@@ -64,8 +245,15 @@ Source sourceFromFile(const char* fileName) {
   }
 
   EXIT:
-  return (Source){ .fileName=stringFromArray(name), .content=stringFromArray(content),
-                   .status=status };
+  {
+    Source source = { .fileName=stringFromArray(name), .content=stringFromArray(content),
+                      .status=status, .firstLine=1, .lines=NULL };
+    if (status == SOURCE_OK) {
+      source.content.len = size;  // the content may contain NUL characters, which are rejected
+      prepareSource(&source, options);
+    }
+    return source;
+  }
 }
 
 
@@ -75,18 +263,31 @@ void deleteSource(Source* source) {
   source->fileName = stringFromArray("");
   source->content = stringFromArray("");
   source->status = SOURCE_NONE;
+  source->firstLine = 1;
+  sbufFree(source->lines);
 }
 
 
 string getLine(const Source* source, size_t line) {
-  if (line == 0) {
+  if (line < source->firstLine || line == 0) {
     return stringFromArray("");
   }
 
+  if (source->lines != NULL) {
+    size_t index = line - source->firstLine;
+    if (index >= sbufLength(source->lines)) {
+      return stringFromArray("");
+    }
+    size_t end = (index + 1 < sbufLength(source->lines)) ? source->lines[index+1]
+                                                         : source->content.len;
+    return stringFromRange(source->content.chars + source->lines[index],
+                           source->content.chars + end);
+  }
+
   size_t currentPos, currentLine;
 
   // skip to line
-  for (currentPos = 0, currentLine = 1;
+  for (currentPos = 0, currentLine = source->firstLine;
        currentPos < source->content.len && currentLine != line;
        currentPos++) {
     if (source->content.chars[currentPos] == '\n') {
@@ -110,3 +311,28 @@ string getLine(const Source* source, size_t line) {
 
   return stringFromRange(source->content.chars + start, source->content.chars + currentPos);
 }
+
+
+Location getLocation(const Source* source, size_t offset) {
+  if (source->lines == NULL) {
+    Location location = loc(source->firstLine, 1);
+    for (size_t i = 0; i < offset && i < source->content.len; i++) {
+      location = (source->content.chars[i] == '\n') ? loc(location.line + 1, 1)
+                                                      : loc(location.line, location.pos + 1);
+    }
+    return location;
+  }
+
+  // find the last line starting at or before the offset
+  size_t low = 0;
+  size_t high = sbufLength(source->lines);
+  while (high - low > 1) {
+    size_t mid = low + (high - low) / 2;
+    if (source->lines[mid] <= offset) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  return loc(source->firstLine + low, offset - source->lines[low] + 1);
+}
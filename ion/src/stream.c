@@ -0,0 +1,157 @@
+#include "stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+#define MAX(a, b) ((a) >= (b) ? (a) : (b))
+
+
+static SourceStream createStream(FILE* file, bool ownsFile, const char* name, size_t chunkSize) {
+  chunkSize = MAX(chunkSize, 1);
+  char* buffer = (char*) malloc(chunkSize + 1);
+  buffer[0] = '\0';
+  return (SourceStream){ .window=(Source){ .fileName=stringFromArray(strdup(name)),
+                                           .content=stringFromRange(buffer, buffer),
+                                           .status=SOURCE_OK, .firstLine=1
+                                         },
+                         .file=file, .ownsFile=ownsFile, .buffer=buffer, .capacity=chunkSize+1,
+                         .chunkSize=chunkSize, .offset=0, .eof=false, .tailSize=0,
+                         .message=stringFromArray("")
+                       };
+}
+
+
+SourceStream streamFromFile(const char* name, size_t chunkSize) {
+  FILE* file = fopen(name, "r");
+  if (file == NULL) {
+    char* message = strdup("ERROR: could not open the file");
+    return (SourceStream){ .window=(Source){ .fileName=stringFromArray(strdup(name)),
+                                             .content=stringFromArray(message),
+                                             .status=SOURCE_ERROR, .firstLine=1
+                                           },
+                           .file=NULL, .ownsFile=false, .buffer=message,
+                           .capacity=strlen(message)+1, .chunkSize=chunkSize, .offset=0,
+                           .eof=true, .tailSize=0, .message=stringFromPrint("%s", message)
+                         };
+  }
+  return createStream(file, true, name, chunkSize);
+}
+
+
+SourceStream streamFromHandle(FILE* file, const char* name, size_t chunkSize) {
+  return createStream(file, false, name, chunkSize);
+}
+
+
+/**
+ * Ends the window before the faulty character and stops reading. The location is given like the
+ * one of a rejected `Source`, the line counts from the start of the input.
+ */
+static void rejectInput(SourceStream* stream, size_t at, const char* reason) {
+  Source* window = &stream->window;
+  size_t line = window->firstLine;
+  size_t start = 0;
+  for (size_t i = 0; i < at; i++) {
+    if (stream->buffer[i] == '\n') {
+      ++line;
+      start = i + 1;
+    }
+  }
+  strFree(&stream->message);
+  stream->message = stringFromPrint("ERROR: %s at %zu:%zu", reason, line, at - start + 1);
+  stream->buffer[at] = '\0';
+  window->content = stringFromRange(stream->buffer, stream->buffer + at);
+  window->status = SOURCE_ERROR;
+  stream->tailSize = 0;
+  stream->eof = true;
+}
+
+
+/**
+ * The window is cut at the start of the line containing `keep`, so diagnostics still find the
+ * whole line. The lines within the dropped part are counted to keep `firstLine` up to date. The
+ * buffer only grows if the kept part and a new chunk do not fit, i.e. for very long lines.
+ *
+ * The held back bytes of a cut character precede the new chunk. Chunks are read until the window
+ * grows, as a chunk of a single byte may only continue the cut character.
+ */
+size_t streamRefill(SourceStream* stream, size_t keep) {
+  if (stream->eof) {
+    return 0;
+  }
+
+  Source* window = &stream->window;
+  size_t length = window->content.len;
+  size_t cut = (keep < length) ? keep : length;
+  while (cut > 0 && stream->buffer[cut-1] != '\n') {
+    --cut;
+  }
+  for (size_t i = 0; i < cut; i++) {
+    if (stream->buffer[i] == '\n') {
+      ++window->firstLine;
+    }
+  }
+
+  length -= cut;
+  memmove(stream->buffer, stream->buffer + cut, length);
+  stream->offset += cut;
+  window->content = stringFromRange(stream->buffer, stream->buffer + length);
+
+  size_t start = length;
+  while (length == start && !stream->eof) {
+    size_t needed = length + stream->tailSize + stream->chunkSize + 1;
+    if (needed > stream->capacity) {
+      stream->capacity = MAX(2*stream->capacity, needed);
+      stream->buffer = (char*) realloc(stream->buffer, stream->capacity);
+    }
+
+    memcpy(stream->buffer + length, stream->tail, stream->tailSize);
+    char* chunk = stream->buffer + length;
+    size_t count = stream->tailSize + fread(chunk + stream->tailSize, 1, stream->chunkSize,
+                                            stream->file);
+    bool failed = false;
+    if (count - stream->tailSize < stream->chunkSize) {
+      stream->eof = true;
+      failed = ferror(stream->file) != 0;
+    }
+
+    bool incomplete = false;
+    size_t valid = validContent(chunk, count, stream->eof ? NULL : &incomplete);
+    bool rejected = valid < count && !incomplete;
+    const char* reason = (rejected && chunk[valid] == '\0') ? "NUL character" : "invalid UTF-8";
+    stream->tailSize = incomplete ? count - valid : 0;
+    memcpy(stream->tail, chunk + valid, stream->tailSize);
+    length += valid;
+    stream->buffer[length] = '\0';
+    window->content = stringFromRange(stream->buffer, stream->buffer + length);
+
+    if (rejected) {
+      rejectInput(stream, length, reason);
+    } else if (failed) {
+      rejectInput(stream, length, "could not read the input");
+    }
+  }
+  return cut;
+}
+
+
+void deleteStream(SourceStream* stream) {
+  if (stream->ownsFile) {
+    fclose(stream->file);
+  }
+  free((char*) stream->window.fileName.chars);
+  free(stream->buffer);
+  strFree(&stream->message);
+  stream->window.fileName = stringFromArray("");
+  stream->window.content = stringFromArray("");
+  stream->window.status = SOURCE_NONE;
+  stream->window.firstLine = 1;
+  stream->file = NULL;
+  stream->ownsFile = false;
+  stream->buffer = NULL;
+  stream->capacity = 0;
+  stream->offset = 0;
+  stream->eof = true;
+  stream->tailSize = 0;
+}
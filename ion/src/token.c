@@ -11,8 +11,180 @@ const char* strTokenKind(TokenKind kind) {
     CASE(TOKEN_EOF);
     CASE(TOKEN_COMMENT);
     CASE(TOKEN_INT);
+    CASE(TOKEN_FLOAT);
+    CASE(TOKEN_STRING);
+    CASE(TOKEN_CHAR);
     CASE(TOKEN_NAME);
     CASE(TOKEN_KEYWORD);
     CASE(TOKEN_SYMBOL);
   }
 }
+
+
+const char* strKeyword(Keyword keyword) {
+  switch (keyword) {
+    CASE(KEYWORD_NONE);
+    CASE(KEYWORD_IF);
+    CASE(KEYWORD_ELSE);
+    CASE(KEYWORD_DO);
+    CASE(KEYWORD_WHILE);
+    CASE(KEYWORD_FOR);
+    CASE(KEYWORD_SWITCH);
+    CASE(KEYWORD_CASE);
+    CASE(KEYWORD_BREAK);
+    CASE(KEYWORD_CONTINUE);
+    CASE(KEYWORD_RETURN);
+    CASE(KEYWORD_TRUE);
+    CASE(KEYWORD_FALSE);
+    CASE(KEYWORD_VAR);
+    CASE(KEYWORD_CONST);
+    CASE(KEYWORD_FUNC);
+    CASE(KEYWORD_STRUCT);
+    CASE(KEYWORD_BLANK);
+  }
+}
+
+
+const char* strSymbol(Symbol symbol) {
+  switch (symbol) {
+    CASE(SYMBOL_NONE);
+    CASE(SYMBOL_LPAREN);
+    CASE(SYMBOL_RPAREN);
+    CASE(SYMBOL_LBRACKET);
+    CASE(SYMBOL_RBRACKET);
+    CASE(SYMBOL_LBRACE);
+    CASE(SYMBOL_RBRACE);
+    CASE(SYMBOL_COMMA);
+    CASE(SYMBOL_SEMICOLON);
+    CASE(SYMBOL_COLON);
+    CASE(SYMBOL_DOT);
+    CASE(SYMBOL_NOT);
+    CASE(SYMBOL_NOT_EQUAL);
+    CASE(SYMBOL_ASSIGN);
+    CASE(SYMBOL_EQUAL);
+    CASE(SYMBOL_LESS);
+    CASE(SYMBOL_LESS_EQUAL);
+    CASE(SYMBOL_GREATER);
+    CASE(SYMBOL_GREATER_EQUAL);
+    CASE(SYMBOL_AND);
+    CASE(SYMBOL_LOGICAL_AND);
+    CASE(SYMBOL_OR);
+    CASE(SYMBOL_LOGICAL_OR);
+    CASE(SYMBOL_PLUS);
+    CASE(SYMBOL_MINUS);
+    CASE(SYMBOL_ARROW);
+    CASE(SYMBOL_STAR);
+    CASE(SYMBOL_SLASH);
+    CASE(SYMBOL_PERCENT);
+    CASE(SYMBOL_CARET);
+    CASE(SYMBOL_TILDE);
+  }
+}
+
+
+const char* strLexErrorKind(LexErrorKind kind) {
+  switch (kind) {
+    CASE(LEX_ERROR_NONE);
+    CASE(LEX_ERROR_ILLEGAL_CHAR);
+    CASE(LEX_ERROR_UNCLOSED_COMMENT);
+    CASE(LEX_ERROR_INT_FORMAT);
+    CASE(LEX_ERROR_HEX_DIGITS);
+    CASE(LEX_ERROR_HEX_FORMAT);
+    CASE(LEX_ERROR_BIN_DIGITS);
+    CASE(LEX_ERROR_BIN_FORMAT);
+    CASE(LEX_ERROR_INT_OVERFLOW);
+    CASE(LEX_ERROR_FLOAT_FORMAT);
+    CASE(LEX_ERROR_HEX_EXPONENT);
+    CASE(LEX_ERROR_FLOAT_OVERFLOW);
+    CASE(LEX_ERROR_UNCLOSED_STRING);
+    CASE(LEX_ERROR_UNCLOSED_CHAR);
+    CASE(LEX_ERROR_INVALID_ESCAPE);
+    CASE(LEX_ERROR_CHAR_LENGTH);
+    CASE(LEX_ERROR_SOURCE_SIZE);
+  }
+}
+
+
+static const char* const SYMBOL_CHARS[] = {
+  [SYMBOL_NONE]          = "",
+  [SYMBOL_LPAREN]        = "(",
+  [SYMBOL_RPAREN]        = ")",
+  [SYMBOL_LBRACKET]      = "[",
+  [SYMBOL_RBRACKET]      = "]",
+  [SYMBOL_LBRACE]        = "{",
+  [SYMBOL_RBRACE]        = "}",
+  [SYMBOL_COMMA]         = ",",
+  [SYMBOL_SEMICOLON]     = ";",
+  [SYMBOL_COLON]         = ":",
+  [SYMBOL_DOT]           = ".",
+  [SYMBOL_NOT]           = "!",
+  [SYMBOL_NOT_EQUAL]     = "!=",
+  [SYMBOL_ASSIGN]        = "=",
+  [SYMBOL_EQUAL]         = "==",
+  [SYMBOL_LESS]          = "<",
+  [SYMBOL_LESS_EQUAL]    = "<=",
+  [SYMBOL_GREATER]       = ">",
+  [SYMBOL_GREATER_EQUAL] = ">=",
+  [SYMBOL_AND]           = "&",
+  [SYMBOL_LOGICAL_AND]   = "&&",
+  [SYMBOL_OR]            = "|",
+  [SYMBOL_LOGICAL_OR]    = "||",
+  [SYMBOL_PLUS]          = "+",
+  [SYMBOL_MINUS]         = "-",
+  [SYMBOL_ARROW]         = "->",
+  [SYMBOL_STAR]          = "*",
+  [SYMBOL_SLASH]         = "/",
+  [SYMBOL_PERCENT]       = "%",
+  [SYMBOL_CARET]         = "^",
+  [SYMBOL_TILDE]         = "~",
+};
+
+
+const char* symbolChars(Symbol symbol) {
+  return SYMBOL_CHARS[symbol];
+}
+
+
+Location tokenStart(Token token) {
+  return getLocation(token.source, token.chars.chars - token.source->content.chars);
+}
+
+
+Location tokenEnd(Token token) {
+  size_t offset = token.chars.chars - token.source->content.chars;
+  return getLocation(token.source, (token.chars.len > 0) ? offset + token.chars.len - 1 : offset);
+}
+
+
+static const char* LEX_ERROR_MESSAGES[] = {
+  [LEX_ERROR_NONE]             = "no error",
+  [LEX_ERROR_ILLEGAL_CHAR]     = "illegal character '%.*s'",
+  [LEX_ERROR_UNCLOSED_COMMENT] = "unclosed multi-line comment",
+  [LEX_ERROR_INT_FORMAT]       = "invalid integer format",
+  [LEX_ERROR_HEX_DIGITS]       = "hex integer must have at least one digit",
+  [LEX_ERROR_HEX_FORMAT]       = "invalid hex integer format",
+  [LEX_ERROR_BIN_DIGITS]       = "bin integer must have at least one digit",
+  [LEX_ERROR_BIN_FORMAT]       = "invalid bin integer format",
+  [LEX_ERROR_INT_OVERFLOW]     = "integer does not fit into 64 bits",
+  [LEX_ERROR_FLOAT_FORMAT]     = "invalid float format",
+  [LEX_ERROR_HEX_EXPONENT]     = "hex float must have a binary exponent",
+  [LEX_ERROR_FLOAT_OVERFLOW]   = "float does not fit into a double",
+  [LEX_ERROR_UNCLOSED_STRING]  = "unclosed string literal",
+  [LEX_ERROR_UNCLOSED_CHAR]    = "unclosed character literal",
+  [LEX_ERROR_INVALID_ESCAPE]   = "invalid escape sequence",
+  [LEX_ERROR_CHAR_LENGTH]      = "character literal must contain exactly one character",
+  [LEX_ERROR_SOURCE_SIZE]      = "source exceeds the 2 GiB of a token array",
+};
+
+
+/**
+ * Only the message of an illegal character has a parameter, which is the token's characters. The
+ * other messages ignore it.
+ */
+Error errorFromToken(Token token) {
+  size_t offset = token.chars.chars - token.source->content.chars;
+  Location caret = getLocation(token.source, offset + token.caret);
+  string msg = generateError(token.source, tokenStart(token), caret, tokenEnd(token),
+                             LEX_ERROR_MESSAGES[token.error], token.chars.len, token.chars.chars);
+  return createError(caret, msg, NULL);
+}
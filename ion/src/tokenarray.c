@@ -0,0 +1,220 @@
+#include "tokenarray.h"
+
+#include <string.h>
+
+
+size_t tokenCount(const TokenArray* tokens) {
+  return sbufLength(tokens->kinds);
+}
+
+
+/**
+ * Returns the position of the first value whose token is at or after the index by binary search,
+ * the values are sorted by the tokens' indices.
+ */
+static size_t lowerValue(const TokenArray* tokens, size_t index) {
+  size_t low = 0;
+  size_t high = sbufLength(tokens->values);
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (tokens->values[mid].index < index) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+
+/**
+ * Returns the index of the first error record at or after the offset.
+ */
+static size_t lowerError(const TokenArray* tokens, size_t offset) {
+  size_t low = 0;
+  size_t high = sbufLength(tokens->errors);
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (tokens->errors[mid].offset < offset) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+
+/**
+ * Returns the value at the position in `values` if it belongs to the token, otherwise `0`.
+ */
+static uint64_t valueAt(const TokenArray* tokens, size_t position, size_t index) {
+  if (position < sbufLength(tokens->values) && tokens->values[position].index == index) {
+    return tokens->values[position].value;
+  }
+  return 0;
+}
+
+
+static bool isLiteral(TokenKind kind) {
+  return kind == TOKEN_INT || kind == TOKEN_FLOAT || kind == TOKEN_STRING || kind == TOKEN_CHAR;
+}
+
+
+/**
+ * Restores the token, the position of its value in `values` is given by the caller.
+ */
+static Token restoreToken(const TokenArray* tokens, size_t index, size_t position) {
+  const char* chars = tokens->source->content.chars + tokens->offsets[index];
+  Token token = { .kind=tokens->kinds[index], .source=tokens->source,
+                  .chars=stringFromRange(chars, chars + tokens->lengths[index])
+                };
+
+  switch (token.kind) {
+    case TOKEN_SYMBOL:
+      token.symbol = tokens->subkinds[index];
+      break;
+    case TOKEN_INT:
+    case TOKEN_FLOAT:
+    case TOKEN_STRING:
+    case TOKEN_CHAR:
+      token.value = valueAt(tokens, position, index);
+      break;
+    case TOKEN_ERROR:
+      token.error = tokens->subkinds[index];
+      token.caret = valueAt(tokens, position, index);
+      break;
+    default:
+      token.keyword = tokens->subkinds[index];
+      break;
+  }
+  return token;
+}
+
+
+/**
+ * Only a literal or an error has a value, which is found by binary search.
+ */
+Token tokenAt(const TokenArray* tokens, size_t index) {
+  TokenKind kind = tokens->kinds[index];
+  size_t position = (isLiteral(kind) || kind == TOKEN_ERROR) ? lowerValue(tokens, index) : 0;
+  return restoreToken(tokens, index, position);
+}
+
+
+void appendToken(TokenArray* tokens, Token token) {
+  uint32_t index = sbufLength(tokens->kinds);
+  if (isLiteral(token.kind)) {
+    sbufPush(tokens->values, (TokenValue){ .index=index, .value=token.value });
+  } else if (token.kind == TOKEN_ERROR) {
+    sbufPush(tokens->values, (TokenValue){ .index=index, .value=token.caret });
+  }
+  uint8_t subkind = (token.kind == TOKEN_SYMBOL) ? token.symbol
+                  : (token.kind == TOKEN_ERROR)  ? token.error
+                  : token.keyword;
+  sbufPush(tokens->kinds, token.kind);
+  sbufPush(tokens->subkinds, subkind);
+  sbufPush(tokens->offsets, token.chars.chars - tokens->source->content.chars);
+  sbufPush(tokens->lengths, token.chars.len);
+}
+
+
+/**
+ * Replaces `removed` items at some position by `inserted` items and moves the items behind.
+ */
+static void* splice(void* buffer, size_t size, size_t at, size_t removed,
+                    const void* items, size_t inserted) {
+  size_t length = sbufLength(buffer);
+  if (length - removed + inserted > sbufCapacity(buffer)) {
+    buffer = __sbufGrow(buffer, length - removed + inserted, size);
+  }
+  if (buffer == NULL) {
+    return NULL;
+  }
+  char* bytes = (char*) buffer;
+  memmove(bytes + (at + inserted) * size, bytes + (at + removed) * size,
+          (length - at - removed) * size);
+  if (inserted > 0) {
+    memcpy(bytes + at * size, items, inserted * size);
+  }
+  sbufSetLength(buffer, length - removed + inserted);
+  return buffer;
+}
+
+#define SPLICE(b, at, removed, items, inserted) \
+        ((b) = splice(b, sizeof(*(b)), at, removed, items, inserted))
+
+
+/**
+ * The error records of the replaced tokens are found by a binary search over their offsets, as
+ * there is one record per error token. Everything behind the range is moved and shifted, thus the
+ * time is linear in the number of following tokens and errors.
+ */
+void replaceTokens(TokenArray* tokens, size_t first, size_t end,
+                   const TokenArray* replacement, int64_t shift) {
+  size_t removed = end - first;
+  size_t inserted = tokenCount(replacement);
+  size_t errorsFrom = tokens->offsets[first];
+  size_t errorsTo = (end < tokenCount(tokens)) ? tokens->offsets[end] : SIZE_MAX;
+
+  SPLICE(tokens->kinds, first, removed, replacement->kinds, inserted);
+  SPLICE(tokens->subkinds, first, removed, replacement->subkinds, inserted);
+  SPLICE(tokens->offsets, first, removed, replacement->offsets, inserted);
+  SPLICE(tokens->lengths, first, removed, replacement->lengths, inserted);
+  for (size_t i = first + inserted; i < tokenCount(tokens); i++) {
+    tokens->offsets[i] = tokens->offsets[i] + shift;
+  }
+
+  size_t valuesFrom = lowerValue(tokens, first);
+  size_t valuesTo = lowerValue(tokens, end);
+  for (size_t i = valuesTo; i < sbufLength(tokens->values); i++) {
+    tokens->values[i].index = tokens->values[i].index - removed + inserted;
+  }
+  SPLICE(tokens->values, valuesFrom, valuesTo - valuesFrom,
+         replacement->values, sbufLength(replacement->values));
+  for (size_t i = valuesFrom; i < valuesFrom + sbufLength(replacement->values); i++) {
+    tokens->values[i].index += first;
+  }
+
+  size_t errorsBegin = lowerError(tokens, errorsFrom);
+  size_t errorsEnd = lowerError(tokens, errorsTo);
+  for (size_t i = errorsEnd; i < sbufLength(tokens->errors); i++) {
+    tokens->errors[i].offset = tokens->errors[i].offset + shift;
+  }
+  SPLICE(tokens->errors, errorsBegin, errorsEnd - errorsBegin,
+         replacement->errors, sbufLength(replacement->errors));
+
+  tokens->source = replacement->source;
+}
+
+
+void deleteTokenArray(TokenArray* tokens) {
+  sbufFree(tokens->kinds);
+  sbufFree(tokens->subkinds);
+  sbufFree(tokens->offsets);
+  sbufFree(tokens->lengths);
+  sbufFree(tokens->values);
+  sbufFree(tokens->errors);
+  tokens->source = NULL;
+}
+
+
+TokenIterator iteratorFromTokens(const TokenArray* tokens) {
+  return (TokenIterator){ .tokens=tokens, .index=0, .value=0 };
+}
+
+
+/**
+ * The values are passed in step with the tokens, thus a walk over the array never searches.
+ */
+Token iteratorNext(TokenIterator* it) {
+  const TokenArray* tokens = it->tokens;
+  Token token = restoreToken(tokens, it->index, it->value);
+  if (it->index + 1 < tokenCount(tokens)) {
+    while (it->value < sbufLength(tokens->values) && tokens->values[it->value].index <= it->index) {
+      it->value++;
+    }
+    it->index++;
+  }
+  return token;
+}
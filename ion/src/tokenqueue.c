@@ -0,0 +1,117 @@
+#include "tokenqueue.h"
+
+#include <sched.h>
+#include <stdlib.h>
+
+
+#define QUEUE_MASK (TOKEN_QUEUE_SIZE - 1)
+
+
+TokenQueue createTokenQueue(const Source* src) {
+  TokenQueue queue = { .source=src, .tail=0, .pushed=0, .knownHead=0,
+                       .head=0, .popped=0, .knownTail=0, .closed=false };
+  queue.slots = (QueuedToken*) aligned_alloc(64, TOKEN_QUEUE_SIZE * sizeof(QueuedToken));
+  return queue;
+}
+
+
+void deleteTokenQueue(TokenQueue* queue) {
+  free(queue->slots);
+  queue->slots = NULL;
+  queue->source = NULL;
+}
+
+
+static void publishTail(TokenQueue* queue) {
+  __atomic_store_n(&queue->tail, queue->pushed, __ATOMIC_RELEASE);
+}
+
+
+static void publishHead(TokenQueue* queue) {
+  __atomic_store_n(&queue->head, queue->popped, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * The head is only read again when the ring looks full. Before waiting, the pushed tokens are
+ * published, otherwise the consumer might wait for them as well.
+ */
+bool queuePush(TokenQueue* queue, Token token) {
+  while (queue->pushed - queue->knownHead == TOKEN_QUEUE_SIZE) {
+    publishTail(queue);
+    if (__atomic_load_n(&queue->closed, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    queue->knownHead = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (queue->pushed - queue->knownHead == TOKEN_QUEUE_SIZE) {
+      sched_yield();
+    }
+  }
+
+  QueuedToken* slot = &queue->slots[queue->pushed & QUEUE_MASK];
+  slot->kind = token.kind;
+  slot->subkind = (token.kind == TOKEN_SYMBOL) ? token.symbol
+                : (token.kind == TOKEN_ERROR)  ? token.error
+                : token.keyword;
+  slot->value = (token.kind == TOKEN_ERROR) ? token.caret : token.value;
+  slot->offset = token.chars.chars - queue->source->content.chars;
+  slot->length = token.chars.len;
+  queue->pushed++;
+
+  if (queue->pushed - queue->tail >= TOKEN_QUEUE_BATCH || token.kind == TOKEN_EOF) {
+    publishTail(queue);
+  }
+  return true;
+}
+
+
+/**
+ * The tail is only read again when the ring looks empty. Before waiting, the popped slots are
+ * released, otherwise the producer might wait for them as well. The `TOKEN_EOF` is never popped.
+ */
+Token queuePop(TokenQueue* queue) {
+  while (queue->popped == queue->knownTail) {
+    publishHead(queue);
+    queue->knownTail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (queue->popped == queue->knownTail) {
+      sched_yield();
+    }
+  }
+
+  const QueuedToken* slot = &queue->slots[queue->popped & QUEUE_MASK];
+  const char* chars = queue->source->content.chars + slot->offset;
+  Token token = { .kind=slot->kind, .source=queue->source,
+                  .chars=stringFromRange(chars, chars + slot->length)
+                };
+  switch (token.kind) {
+    case TOKEN_SYMBOL:
+      token.symbol = slot->subkind;
+      break;
+    case TOKEN_INT:
+    case TOKEN_FLOAT:
+    case TOKEN_STRING:
+    case TOKEN_CHAR:
+      token.value = slot->value;
+      break;
+    case TOKEN_ERROR:
+      token.error = slot->subkind;
+      token.caret = slot->value;
+      break;
+    default:
+      token.keyword = slot->subkind;
+      break;
+  }
+
+  if (token.kind != TOKEN_EOF) {
+    queue->popped++;
+    if (queue->popped - queue->head >= TOKEN_QUEUE_BATCH) {
+      publishHead(queue);
+    }
+  }
+  return token;
+}
+
+
+void closeTokenQueue(TokenQueue* queue) {
+  __atomic_store_n(&queue->closed, true, __ATOMIC_RELEASE);
+}
@@ -6,11 +6,20 @@ extern TestResult arena_alltests(PrintLevel);
 extern TestResult str_alltests(PrintLevel);
 extern TestResult strintern_alltests(PrintLevel);
 extern TestResult source_alltests(PrintLevel);
+extern TestResult stream_alltests(PrintLevel);
+extern TestResult cache_alltests(PrintLevel);
+extern TestResult loader_alltests(PrintLevel);
 extern TestResult error_alltests(PrintLevel);
 extern TestResult lexer_alltests(PrintLevel);
+extern TestResult tokenarray_alltests(PrintLevel);
+extern TestResult parlexer_alltests(PrintLevel);
+extern TestResult tokenqueue_alltests(PrintLevel);
 extern TestResult number_alltests(PrintLevel);
+extern TestResult floating_alltests(PrintLevel);
+extern TestResult constpool_alltests(PrintLevel);
 extern TestResult parser_alltests(PrintLevel);
 extern TestResult astprinter_alltests(PrintLevel);
+extern TestResult fold_alltests(PrintLevel);
 
 
 int main() {
@@ -21,9 +30,18 @@ int main() {
   result = unite(result, strintern_alltests(SPARSE));
   result = unite(result, error_alltests(SPARSE));
   result = unite(result, source_alltests(SPARSE));
+  result = unite(result, stream_alltests(SPARSE));
+  result = unite(result, cache_alltests(SPARSE));
+  result = unite(result, loader_alltests(SPARSE));
   result = unite(result, lexer_alltests(SUMMARY));
+  result = unite(result, tokenarray_alltests(SPARSE));
+  result = unite(result, parlexer_alltests(SPARSE));
+  result = unite(result, tokenqueue_alltests(SPARSE));
   result = unite(result, number_alltests(SPARSE));
+  result = unite(result, floating_alltests(SPARSE));
+  result = unite(result, constpool_alltests(SPARSE));
   result = unite(result, parser_alltests(VERBOSE));
   result = unite(result, astprinter_alltests(VERBOSE));
+  result = unite(result, fold_alltests(SPARSE));
   printResult(result);
 }
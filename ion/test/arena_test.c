@@ -36,7 +36,7 @@ static TestResult testCreation() {
     TEST(assertNotNull(arena.ptr));
     TEST(assertNotNull(arena.end));
     TEST(assertNotNull(arena.blocks));
-    TEST(assertEqualSize(arena.totalSpace, 1));
+    TEST(assertEqualSize(arena.totalSpace, 4096));  // a whole block is allocated
     TEST(assertEqualSize(arena.usedSpace, 1));
     TEST(assertNotNull(p));
     arenaFree(&arena);
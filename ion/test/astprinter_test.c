@@ -44,8 +44,7 @@ static TestResult testPrintError() {
        "(error \"<cstring>:1:1: \e[31mError:\e[39m unexpected token TOKEN_KEYWORD\" in (none))"));
   TEST(createTest("_",
        "(error \"<cstring>:1:1: \e[31mError:\e[39m unexpected token TOKEN_KEYWORD\" in (none))"));
-  TEST(createTest("// comment",
-       "(error \"<cstring>:1:1: \e[31mError:\e[39m unexpected token TOKEN_COMMENT\" in (none))"));
+  TEST(createTest("// comment", "(none)"));  // comments are dropped before parsing
   return result;
 }
 
@@ -67,6 +66,18 @@ static TestResult testPrintExprInt() {
 }
 
 
+static TestResult testPrintExprFloat() {
+  TestResult result = {};
+  TEST(createTest("1.5", "1.5"));
+  TEST(createTest("0.1e1", "1.0"));
+  TEST(createTest("12_500e-2", "125.0"));
+  TEST(createTest("0x1p-2", "0.25"));
+  TEST(createTest("1e100", "1e100"));
+  TEST(createTest("1e400",
+       "(error \"<cstring>:1:1: \e[31mError:\e[39m float does not fit into a double\" in (none))"));
+  return result;
+}
+
 
 static TestResult testPrintExprUnop() {
   TestResult result = {};
@@ -114,6 +125,7 @@ TestResult astprinter_alltests(PrintLevel verbosity) {
   addTest(&suite, testPrintError);
   addTest(&suite, testPrintExprName);
   addTest(&suite, testPrintExprInt);
+  addTest(&suite, testPrintExprFloat);
   addTest(&suite, testPrintExprUnop);
 //  addTest(&suite, testPrintExprBinop);
 //  addTest(&suite, testPrintExprParen);
@@ -0,0 +1,253 @@
+#include "cunit.h"
+#define FILENAME "__cache__.tmp"
+#include "util.h"
+
+#include "cache.h"
+
+#include "lexer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <utime.h>
+
+
+#define DIRNAME "__cache_dir__.tmp"
+
+
+static void setModificationTime(const char* fileName, time_t time) {
+  struct utimbuf times = { .actime=time, .modtime=time };
+  utime(fileName, &times);
+}
+
+
+static TestResult testCreation() {
+  TestResult result = {};
+
+  {
+    SourceCache cache = createSourceCache(NULL);
+    TEST(assertNull(cache.entries));
+    TEST(assertNull(cache.slots));
+    TEST(assertNull(cache.directory));
+    TEST(assertEqualInt(cache.reads, 0));
+    TEST(assertEqualInt(cache.lexes, 0));
+    deleteSourceCache(&cache);
+  }
+
+  return result;
+}
+
+
+static TestResult testHash() {
+  TestResult result = {};
+  TEST(assertTrue(hashString(stringFromArray("")) == hashString(stringFromArray(""))));
+  TEST(assertTrue(hashString(stringFromArray("abc")) == hashString(stringFromArray("abc"))));
+  TEST(assertTrue(hashString(stringFromArray("abc")) != hashString(stringFromArray("abd"))));
+  TEST(assertTrue(hashString(stringFromArray("12345678a")) !=
+                  hashString(stringFromArray("12345678b"))));
+  TEST(assertTrue(hashString(stringFromArray("a")) !=
+                  hashString(stringFromRange("a", "a" + 2))));
+  return result;
+}
+
+
+static TestResult testCacheInMemory() {
+  TestResult result = {};
+  WRITE_FILE("x + 1");
+  setModificationTime(FILENAME, 1000);
+
+  {
+    SourceCache cache = createSourceCache(NULL);
+    const CacheEntry* entry = cacheSource(&cache, FILENAME);
+    ABORT(assertNotNull(entry));
+    TEST(assertEqualInt(entry->source.status, SOURCE_OK));
+    TEST(assertEqualStr(entry->source.content, "x + 1"));
+    TEST(assertEqualSize(sbufLength(entry->tokens), 4));
+    TEST(assertEqualInt(entry->tokens[0].kind, TOKEN_NAME));
+    TEST(assertEqualInt(entry->tokens[3].kind, TOKEN_EOF));
+    TEST(assertEqualInt(cache.reads, 1));
+    TEST(assertEqualInt(cache.lexes, 1));
+
+    // unchanged file is neither read nor lexed
+    const CacheEntry* again = cacheSource(&cache, FILENAME);
+    TEST(assertSame(again, entry));
+    TEST(assertEqualInt(cache.reads, 1));
+    TEST(assertEqualInt(cache.lexes, 1));
+
+    // touched file is read, but not lexed
+    setModificationTime(FILENAME, 2000);
+    again = cacheSource(&cache, FILENAME);
+    TEST(assertSame(again, entry));
+    TEST(assertEqualInt(cache.reads, 2));
+    TEST(assertEqualInt(cache.lexes, 1));
+
+    // modified file is read and lexed
+    WRITE_FILE("x + 12");
+    setModificationTime(FILENAME, 3000);
+    again = cacheSource(&cache, FILENAME);
+    TEST(assertSame(again, entry));
+    TEST(assertEqualStr(entry->source.content, "x + 12"));
+    TEST(assertEqualStr(entry->tokens[2].chars, "12"));
+    TEST(assertEqualInt(cache.reads, 3));
+    TEST(assertEqualInt(cache.lexes, 2));
+
+    deleteSourceCache(&cache);
+  }
+
+  {
+    SourceCache cache = createSourceCache(NULL);
+    const CacheEntry* entry = cacheSource(&cache, "." FILENAME);
+    ABORT(assertNotNull(entry));
+    TEST(assertEqualInt(entry->source.status, SOURCE_ERROR));
+    TEST(assertEqualStr(entry->source.content, "ERROR: could not open the file"));
+    TEST(assertNull(entry->tokens));
+    deleteSourceCache(&cache);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
+static TestResult testManyEntries() {
+  TestResult result = {};
+
+  {
+    SourceCache cache = createSourceCache(NULL);
+    const CacheEntry* entries[200];
+    int mismatches = 0;
+    for (int i = 0; i < 200; i++) {
+      char path[32];
+      snprintf(path, sizeof(path), "." FILENAME "%d", i);  // none of the files exist
+      entries[i] = cacheSource(&cache, path);
+      mismatches += strcmp(entries[i]->path, path) != 0;
+    }
+    for (int i = 0; i < 200; i++) {
+      char path[32];
+      snprintf(path, sizeof(path), "." FILENAME "%d", i);
+      mismatches += cacheSource(&cache, path) != entries[i];
+    }
+    TEST(assertEqualInt(mismatches, 0));
+    TEST(assertEqualSize(sbufLength(cache.entries), 200));
+    TEST(assertTrue(cache.slotCount >= 400));
+    deleteSourceCache(&cache);
+    TEST(assertNull(cache.slots));
+  }
+
+  return result;
+}
+
+
+static TestResult testCacheOnDisk() {
+  TestResult result = {};
+  WRITE_FILE("var x := 42;\n// comment");
+  string tokenFile = {};
+
+  {
+    SourceCache cache = createSourceCache(DIRNAME);
+    const CacheEntry* entry = cacheSource(&cache, FILENAME);
+    TEST(assertEqualInt(cache.lexes, 1));
+    tokenFile = stringFromPrint(DIRNAME "/%016llx.tok", (unsigned long long) entry->hash);
+    deleteSourceCache(&cache);
+  }
+
+  {
+    SourceCache cache = createSourceCache(DIRNAME);
+    const CacheEntry* entry = cacheSource(&cache, FILENAME);
+    TEST(assertEqualInt(cache.reads, 1));
+    TEST(assertEqualInt(cache.lexes, 0));  // tokens were loaded from the cache directory
+
+    Source src = sourceFromString("var x := 42;\n// comment");
+    Lexer lexer = lexerFromSource(&src);
+    ABORT(assertEqualSize(sbufLength(entry->tokens), 8));
+    for (int i = 0; i < sbufLength(entry->tokens); i++) {
+      Token exp = nextToken(&lexer);
+      Token token = entry->tokens[i];
+      TEST(assertEqualInt(token.kind, exp.kind));
+      TEST(assertEqualInt(token.keyword, exp.keyword));
+      TEST(assertEqualInt(token.symbol, exp.symbol));
+      TEST(assertTrue(token.value == exp.value));
+      TEST(assertSame(token.source, &entry->source));
+      TEST(assertEqualInt(tokenStart(token).line, tokenStart(exp).line));
+      TEST(assertEqualInt(tokenStart(token).pos, tokenStart(exp).pos));
+      TEST(assertEqualInt(tokenEnd(token).line, tokenEnd(exp).line));
+      TEST(assertEqualInt(tokenEnd(token).pos, tokenEnd(exp).pos));
+      TEST(assertTrue(strequal(token.chars, exp.chars)));
+    }
+    deleteSource(&src);
+    deleteSourceCache(&cache);
+  }
+
+  TEST(assertEqualInt(remove(tokenFile.chars), 0));
+  TEST(assertEqualInt(rmdir(DIRNAME), 0));
+  strFree(&tokenFile);
+  DELETE_FILE();
+  return result;
+}
+
+
+static TestResult testCorruptTokenFile() {
+  TestResult result = {};
+  WRITE_FILE("x + 1");
+  string tokenFile = {};
+  char bytes[32 + 4 * 24];  // the header and the records of "x", "+", "1" and the final EOF
+
+  {
+    SourceCache cache = createSourceCache(DIRNAME);
+    const CacheEntry* entry = cacheSource(&cache, FILENAME);
+    tokenFile = stringFromPrint(DIRNAME "/%016llx.tok", (unsigned long long) entry->hash);
+    deleteSourceCache(&cache);
+  }
+  FILE* file = fopen(tokenFile.chars, "rb");
+  ABORT(assertNotNull(file));
+  size_t length = fread(bytes, 1, sizeof(bytes), file);
+  fclose(file);
+  ABORT(assertEqualSize(length, sizeof(bytes)));
+
+  // each record is the value, kind, subkind, offset and length
+  struct { size_t at; uint32_t field; } cases[] = {
+    { 32 + 8, 99 },             // kind beyond TokenKind
+    { 32 + 24 + 12, 1000 },     // symbol beyond Symbol
+    { 32 + 16, UINT32_MAX },    // offset + length wraps around in 32 bits
+    { 32 + 3 * 24 + 16, 6 },    // EOF beyond the end of the source
+  };
+  for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    char corrupt[sizeof(bytes)];
+    memcpy(corrupt, bytes, sizeof(bytes));
+    memcpy(corrupt + cases[i].at, &cases[i].field, sizeof(uint32_t));
+    file = fopen(tokenFile.chars, "wb");
+    ABORT(assertNotNull(file));
+    fwrite(corrupt, 1, sizeof(corrupt), file);
+    fclose(file);
+
+    SourceCache cache = createSourceCache(DIRNAME);
+    const CacheEntry* entry = cacheSource(&cache, FILENAME);
+    TEST(assertEqualInt(cache.lexes, 1));  // the corrupt file is a cache miss
+    ABORT(assertEqualSize(sbufLength(entry->tokens), 4));
+    TEST(assertEqualInt(entry->tokens[0].kind, TOKEN_NAME));
+    TEST(assertEqualInt(entry->tokens[1].symbol, SYMBOL_PLUS));
+    TEST(assertEqualStr(entry->tokens[2].chars, "1"));
+    TEST(assertEqualInt(entry->tokens[3].kind, TOKEN_EOF));
+    deleteSourceCache(&cache);
+  }
+
+  TEST(assertEqualInt(remove(tokenFile.chars), 0));
+  TEST(assertEqualInt(rmdir(DIRNAME), 0));
+  strFree(&tokenFile);
+  DELETE_FILE();
+  return result;
+}
+
+
+TestResult cache_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<cache>", "Test source cache.");
+  addTest(&suite, testCreation);
+  addTest(&suite, testHash);
+  addTest(&suite, testCacheInMemory);
+  addTest(&suite, testManyEntries);
+  addTest(&suite, testCacheOnDisk);
+  addTest(&suite, testCorruptTokenFile);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
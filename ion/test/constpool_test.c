@@ -0,0 +1,77 @@
+#include "cunit.h"
+#include "util.h"
+
+#include "constpool.h"
+
+
+static TestResult testIntern() {
+  TestResult result = {};
+  constpoolFree();  // start with an empty pool
+
+  {
+    ConstIndex a = constIntern(numFromInt(0xFF));
+    ConstIndex b = constIntern(numFromString(stringFromArray("0b1111_1111")));
+    ConstIndex c = constIntern(numFromInt(-0xFF));
+    ConstIndex d = constIntern(numFromUInt64(UINT64_MAX));
+    TEST(assertEqualInt(a, 0));
+    TEST(assertEqualInt(b, a));
+    TEST(assertEqualInt(c, 1));
+    TEST(assertEqualInt(d, 2));
+    TEST(assertEqualInt(constIntern(numFromInt(-1)), 3));  // same lower bits as UINT64_MAX
+    TEST(assertEqualInt(constCount(), 4));
+    TEST(assertEqualNumber(constAt(a), numFromInt(255)));
+    TEST(assertEqualNumber(constAt(c), numFromInt(-255)));
+    TEST(assertEqualNumber(constAt(d), numFromUInt64(UINT64_MAX)));
+    constpoolFree();
+    TEST(assertEqualInt(constCount(), 0));
+  }
+
+  {
+    Number big = shiftLeft(numFromInt(1), 100);
+    ConstIndex a = constIntern(big);
+    ConstIndex b = constIntern(mul(shiftLeft(numFromInt(1), 50), shiftLeft(numFromInt(1), 50)));
+    ConstIndex c = constIntern(neg(big));
+    TEST(assertEqualInt(b, a));
+    TEST(assertNotEqualInt(c, a));
+    TEST(assertTrue(constAt(a).limbs != big.limbs));  // the pool has its own limbs
+    numFree();
+    TEST(assertEqualInt(bitSize(constAt(a)), 101));
+    TEST(assertTrue(constAt(c).negative));
+    TEST(assertEqualInt(constCount(), 2));
+    constpoolFree();
+  }
+
+  return result;
+}
+
+
+static TestResult testManyConstants() {
+  TestResult result = {};
+
+  int mismatches = 0;
+  for (int i = 0; i < 10000; i++) {
+    Number num = (i % 2 == 0) ? numFromInt(i) : shiftLeft(numFromInt(i), 64 + i % 100);
+    mismatches += constIntern(num) != (ConstIndex) i;
+  }
+  for (int i = 0; i < 10000; i++) {
+    Number num = (i % 2 == 0) ? numFromInt(i) : shiftLeft(numFromInt(i), 64 + i % 100);
+    mismatches += constIntern(num) != (ConstIndex) i;  // interned again
+    mismatches += compare(constAt(i), num) != 0;
+  }
+  TEST(assertEqualInt(mismatches, 0));
+  TEST(assertEqualInt(constCount(), 10000));
+
+  numFree();
+  constpoolFree();
+  return result;
+}
+
+
+TestResult constpool_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<constpool>", "Test the constant pool.");
+  addTest(&suite, testIntern);
+  addTest(&suite, testManyConstants);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
@@ -0,0 +1,210 @@
+#include "cunit.h"
+#include "util.h"
+
+#include "floating.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static bool sameDouble(double a, double b) {
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+
+static bool sameFloat(float a, float b) {
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+
+static double toDouble(const char* chars) {
+  double value = -1.0;
+  doubleFromString(stringFromArray(chars), &value);
+  return value;
+}
+
+
+static float toFloat(const char* chars) {
+  float value = -1.0f;
+  floatFromString(stringFromArray(chars), &value);
+  return value;
+}
+
+
+static TestResult testDoubleFromString() {
+  TestResult result = {};
+
+  TEST(assertTrue(sameDouble(toDouble("0.0"), 0.0)));
+  TEST(assertTrue(sameDouble(toDouble("0e10"), 0.0)));
+  TEST(assertTrue(sameDouble(toDouble("1.5"), 1.5)));
+  TEST(assertTrue(sameDouble(toDouble("0.1"), 0.1)));
+  TEST(assertTrue(sameDouble(toDouble("3.141_592_653_589_793"), 3.141592653589793)));
+  TEST(assertTrue(sameDouble(toDouble("1_000.25e-2"), 10.0025)));
+  TEST(assertTrue(sameDouble(toDouble("6.022_140_76e23"), 6.02214076e23)));
+  TEST(assertTrue(sameDouble(toDouble("1e22"), 1e22)));
+  TEST(assertTrue(sameDouble(toDouble("1e23"), 1e23)));
+  TEST(assertTrue(sameDouble(toDouble("9007199254740993"), 9007199254740992.0)));  // tie to even
+  TEST(assertTrue(sameDouble(toDouble("1.7976931348623157e308"), 1.7976931348623157e308)));
+  TEST(assertTrue(sameDouble(toDouble("2.2250738585072014e-308"), 2.2250738585072014e-308)));
+  TEST(assertTrue(sameDouble(toDouble("4.9406564584124654e-324"), 4.9406564584124654e-324)));
+  TEST(assertTrue(sameDouble(toDouble("2.4703282292062327e-324"), 0.0)));
+  TEST(assertTrue(sameDouble(toDouble("2.4703282292062328e-324"), 4.9406564584124654e-324)));
+  TEST(assertTrue(sameDouble(toDouble("1e-400"), 0.0)));
+  TEST(assertTrue(sameDouble(toDouble("0.000000000000000000000000000000000000001"), 1e-39)));
+
+  // more than 19 digits, the cut-off digits decide the rounding
+  TEST(assertTrue(sameDouble(toDouble("9007199254740993.0000000000000000001"),
+                             9007199254740994.0)));
+  TEST(assertTrue(sameDouble(toDouble("9007199254740992.9999999999999999999"),
+                             9007199254740992.0)));
+  TEST(assertTrue(sameDouble(toDouble("123456789012345678901234567890"),
+                             123456789012345678901234567890.0)));
+
+  double value;
+  TEST(assertFalse(doubleFromString(stringFromArray("1.7976931348623159e308"), &value)));
+  TEST(assertTrue(isinf(value)));
+  TEST(assertFalse(doubleFromString(stringFromArray("1e400"), &value)));
+  TEST(assertTrue(doubleFromString(stringFromArray("1e-99999999999"), &value)));
+  TEST(assertTrue(sameDouble(value, 0.0)));
+  TEST(assertTrue(doubleFromString(stringFromRange("2.5e1", "2.5e1" + 3), &value)));
+  TEST(assertTrue(sameDouble(value, 2.5)));
+
+  return result;
+}
+
+
+static TestResult testHexFromString() {
+  TestResult result = {};
+
+  TEST(assertTrue(sameDouble(toDouble("0x1p0"), 1.0)));
+  TEST(assertTrue(sameDouble(toDouble("0x1.8p1"), 3.0)));
+  TEST(assertTrue(sameDouble(toDouble("0XA_B.Cp-4"), 0xAB.Cp-4)));
+  TEST(assertTrue(sameDouble(toDouble("0x1p-1074"), 0x1p-1074)));
+  TEST(assertTrue(sameDouble(toDouble("0x1p-1075"), 0.0)));  // tie to even
+  TEST(assertTrue(sameDouble(toDouble("0x1.0000000000001p-1075"), 0x1p-1074)));
+  TEST(assertTrue(sameDouble(toDouble("0x1.00000000000008p0"), 1.0)));  // tie to even
+  TEST(assertTrue(sameDouble(toDouble("0x1.000000000000080000001p0"), 0x1.0000000000001p0)));
+  TEST(assertTrue(sameDouble(toDouble("0x1.fffffffffffff7ffp1023"), 0x1.fffffffffffffp1023)));
+
+  double value;
+  TEST(assertFalse(doubleFromString(stringFromArray("0x1.fffffffffffff8p1023"), &value)));
+  TEST(assertFalse(doubleFromString(stringFromArray("0x1p1024"), &value)));
+
+  return result;
+}
+
+
+static TestResult testFloatFromString() {
+  TestResult result = {};
+
+  TEST(assertTrue(sameFloat(toFloat("0.1"), 0.1f)));
+  TEST(assertTrue(sameFloat(toFloat("1.5e10"), 1.5e10f)));
+  TEST(assertTrue(sameFloat(toFloat("3.402_823_466e38"), 3.402823466e38f)));
+  TEST(assertTrue(sameFloat(toFloat("1.401298464e-45"), 1.401298464e-45f)));
+  TEST(assertTrue(sameFloat(toFloat("0x1.8p-149"), 0x1p-148f)));
+  TEST(assertTrue(sameFloat(toFloat("16777217"), 16777216.0f)));  // tie to even
+
+  // rounding the double again would round up to 1.00000012f
+  TEST(assertTrue(sameFloat(toFloat("1.00000005960464477539062500001"), 1.00000012f)));
+  TEST(assertTrue(sameFloat(toFloat("1.000000059604644775390625"), 1.0f)));
+
+  float value;
+  TEST(assertFalse(floatFromString(stringFromArray("3.5e38"), &value)));
+  TEST(assertTrue(isinf(value)));
+
+  return result;
+}
+
+
+/**
+ * Compares the conversion of random literals with the C library, which rounds correctly.
+ */
+static TestResult testRandomLiterals() {
+  TestResult result = {};
+
+  uint64_t state = 88172645463325252ull;
+  int doubleMismatches = 0;
+  int floatMismatches = 0;
+  for (int i = 0; i < 100000; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    char chars[64];
+    double bits;
+    memcpy(&bits, &state, sizeof(bits));
+    if (i % 2 == 0 && isfinite(bits)) {
+      snprintf(chars, sizeof(chars), "%.*e", (int) (state % 20), fabs(bits));
+    } else {
+      snprintf(chars, sizeof(chars), "%llu.%llue%d", (unsigned long long) (state >> 40),
+               (unsigned long long) (state & 0xFFFFFFF), (int) (state % 90) - 45);
+    }
+
+    doubleMismatches += !sameDouble(toDouble(chars), strtod(chars, NULL));
+    floatMismatches += !sameFloat(toFloat(chars), strtof(chars, NULL));
+  }
+  TEST(assertEqualInt(doubleMismatches, 0));
+  TEST(assertEqualInt(floatMismatches, 0));
+
+  return result;
+}
+
+
+static TestResult testDoubleToString() {
+  TestResult result = {};
+
+  struct { double value; const char* chars; } doubles[] = {
+    { 0.0,                     "0.0" },
+    { -0.0,                    "-0.0" },
+    { 1.0,                     "1.0" },
+    { 150.0,                   "150.0" },
+    { 12.5,                    "12.5" },
+    { 0.1,                     "0.1" },
+    { 0.3,                     "0.3" },
+    { 0.1 + 0.2,               "0.30000000000000004" },
+    { 0.001,                   "0.001" },
+    { 1e-5,                    "0.00001" },
+    { 1.5e-7,                  "1.5e-7" },
+    { 1e16,                    "10000000000000000.0" },
+    { 1e17,                    "1e17" },
+    { 1e300,                   "1e300" },
+    { 1.7976931348623157e308,  "1.7976931348623157e308" },
+    { 4.9406564584124654e-324, "5e-324" },
+    { INFINITY,                "inf" },
+    { -2.5,                    "-2.5" },
+  };
+
+  for (int i = 0; i < sizeof(doubles) / sizeof(doubles[0]); i++) {
+    string s = doubleToString(doubles[i].value);
+    TEST(assertEqualStr(s, doubles[i].chars));
+    strFree(&s);
+  }
+
+  string s = floatToString(0.1f);
+  TEST(assertEqualStr(s, "0.1"));
+  strFree(&s);
+  s = floatToString(16777216.0f);
+  TEST(assertEqualStr(s, "16777216.0"));
+  strFree(&s);
+  s = floatToString(3.4028235e38f);
+  TEST(assertEqualStr(s, "3.4028235e38"));
+  strFree(&s);
+
+  return result;
+}
+
+
+TestResult floating_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<floating>", "Test floating-point conversions.");
+  addTest(&suite, testDoubleFromString);
+  addTest(&suite, testHexFromString);
+  addTest(&suite, testFloatFromString);
+  addTest(&suite, testRandomLiterals);
+  addTest(&suite, testDoubleToString);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
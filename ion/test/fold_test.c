@@ -0,0 +1,162 @@
+#include "cunit.h"
+#include "util.h"
+
+#include "fold.h"
+
+#include "astprinter.h"
+#include "parser.h"
+
+
+#define foldTest(in, type, mode, diagnostics, exp) \
+  __foldTest(__FILE__, __LINE__, in, type, mode, diagnostics, exp)
+static bool __foldTest(const char* file, int line, const char* input, NumType type, Overflow mode,
+                       int diagnostics, const char* exp) {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString(input);
+    ASTNode* node = parse(&src);
+    TEST(assertEqualInt(foldConstants(node, type, mode), diagnostics));
+    string s = printAST(node);
+    TEST(__assertEqualStr(file, line, s, exp));
+    strFree(&s);
+    deleteNode(node);
+    deleteSource(&src);
+  }
+
+  numFree();
+  return result.failedTests == 0;
+}
+
+
+static TestResult testFoldArithmetic() {
+  TestResult result = {};
+  NumType u128 = { .bits=128, .isSigned=false };
+  TEST(foldTest("42", NUM_I32, OVERFLOW_TRAP, 0, "42"));
+  TEST(foldTest("0x10 * 4 + 3", NUM_I32, OVERFLOW_TRAP, 0, "67"));
+  TEST(foldTest("1 - 2 - 3", NUM_I32, OVERFLOW_TRAP, 0, "-4"));
+  TEST(foldTest("7 / 2", NUM_I32, OVERFLOW_TRAP, 0, "3"));
+  TEST(foldTest("-7 / 2", NUM_I32, OVERFLOW_TRAP, 0, "-3"));
+  TEST(foldTest("-7 % 2", NUM_I32, OVERFLOW_TRAP, 0, "-1"));
+  TEST(foldTest("0xFFFFFFFFFFFFFFFF * 0xFFFFFFFFFFFFFFFF", u128, OVERFLOW_TRAP, 0,
+                "340282366920938463426481119284349108225"));
+
+  NumType u512 = { .bits=512, .isSigned=false };
+  const char* factor = "0xFFFFFFFFFFFFFFFF";
+  string product = stringFromPrint("%s * %s * %s * %s * %s * %s * %s * %s", factor, factor, factor,
+                                   factor, factor, factor, factor, factor);
+  TEST(foldTest(product.chars, u512, OVERFLOW_TRAP, 0,  // more digits than NUM_STRING_SIZE
+                "1340780792994259709375931520384099100418803153098740252071862840701566976975784"
+                "2313630909715223819254400837606388228716074377856895316039510175975812890625"));
+  strFree(&product);
+  return result;
+}
+
+
+static TestResult testFoldUnary() {
+  TestResult result = {};
+  TEST(foldTest("+5", NUM_I32, OVERFLOW_TRAP, 0, "5"));
+  TEST(foldTest("-5", NUM_I32, OVERFLOW_TRAP, 0, "-5"));
+  TEST(foldTest("- - 1", NUM_I32, OVERFLOW_TRAP, 0, "1"));
+  TEST(foldTest("-127", NUM_I8, OVERFLOW_TRAP, 0, "-127"));
+  TEST(foldTest("~0", NUM_I32, OVERFLOW_TRAP, 0, "-1"));
+  TEST(foldTest("~0", NUM_U8, OVERFLOW_TRAP, 0, "255"));
+  TEST(foldTest("~5", NUM_U16, OVERFLOW_TRAP, 0, "65530"));
+  TEST(foldTest("!0", NUM_I32, OVERFLOW_TRAP, 0, "1"));
+  TEST(foldTest("!3", NUM_I32, OVERFLOW_TRAP, 0, "0"));
+  return result;
+}
+
+
+static TestResult testFoldPartially() {
+  TestResult result = {};
+  TEST(foldTest("x", NUM_I32, OVERFLOW_TRAP, 0, "x"));
+  TEST(foldTest("x + 1", NUM_I32, OVERFLOW_TRAP, 0, "(+ x 1)"));
+  TEST(foldTest("1 + 2 + x", NUM_I32, OVERFLOW_TRAP, 0, "(+ 3 x)"));
+  TEST(foldTest("-x", NUM_I32, OVERFLOW_TRAP, 0, "(- x)"));
+  TEST(foldTest("x / 0", NUM_I32, OVERFLOW_TRAP, 0, "(/ x 0)"));
+  TEST(foldTest("1.5 + 2", NUM_I32, OVERFLOW_TRAP, 0, "(+ 1.5 2)"));
+  TEST(foldTest("", NUM_I32, OVERFLOW_TRAP, 0, "(none)"));
+  return result;
+}
+
+
+static TestResult testFoldDivisionByZero() {
+  TestResult result = {};
+  TEST(foldTest("7 / 0", NUM_I32, OVERFLOW_WRAP, 1,
+                "(error \"\e[31mError:\e[39m division by zero\" in (/ 7 0))"));
+  TEST(foldTest("7 % 0", NUM_I32, OVERFLOW_WRAP, 1,
+                "(error \"\e[31mError:\e[39m division by zero\" in (% 7 0))"));
+  TEST(foldTest("1 + 3 / 0", NUM_I32, OVERFLOW_WRAP, 1,
+                "(error \"\e[31mError:\e[39m division by zero\" in (/ 4 0))"));
+  return result;
+}
+
+
+static TestResult testFoldOverflow() {
+  TestResult result = {};
+  TEST(foldTest("127 + 1", NUM_I8, OVERFLOW_TRAP, 1,
+                "(error \"\e[31mError:\e[39m overflow, 128 does not fit into i8\" in (+ 127 1))"));
+  TEST(foldTest("0 - 1", NUM_U32, OVERFLOW_TRAP, 1,
+                "(error \"\e[31mError:\e[39m overflow, -1 does not fit into u32\" in (- 0 1))"));
+  TEST(foldTest("-127 - 1 / -1", NUM_I8, OVERFLOW_TRAP, 1,
+                "(error \"\e[31mError:\e[39m overflow, 128 does not fit into i8\" "
+                "in (/ -128 -1))"));
+  TEST(foldTest("127 + 1", NUM_I8, OVERFLOW_WRAP, 1, "-128"));
+  TEST(foldTest("127 + 1", NUM_I8, OVERFLOW_SATURATE, 1, "127"));
+  TEST(foldTest("0 - 1", NUM_U64, OVERFLOW_WRAP, 1, "18446744073709551615"));
+  TEST(foldTest("255 * 255 * 255", NUM_U8, OVERFLOW_WRAP, 1, "255"));
+
+  {
+    Source src = sourceFromString("200 + 100 + 1");
+    ASTNode* node = parse(&src);
+    TEST(assertEqualInt(foldConstants(node, NUM_U8, OVERFLOW_WRAP), 1));
+    ABORT(assertEqualSize(sbufLength(node->messages), 1));  // the warning of the operand moved up
+    TEST(assertEqualStr(node->messages[0],
+                        "\e[33mWarning:\e[39m overflow of u8, wrapped to 44\n"));
+    TEST(assertTrue(compare(constAt(node->expr.constant), numFromInt(45)) == 0));
+    deleteNode(node);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testFoldLiteralOverflow() {
+  TestResult result = {};
+  TEST(foldTest("300", NUM_U8, OVERFLOW_TRAP, 1,
+                "(error \"\e[31mError:\e[39m overflow, 300 does not fit into u8\" in 300)"));
+  TEST(foldTest("+300", NUM_U8, OVERFLOW_TRAP, 1,
+                "(+ (error \"\e[31mError:\e[39m overflow, 300 does not fit into u8\" in 300))"));
+  TEST(foldTest("-300", NUM_U8, OVERFLOW_TRAP, 1,
+                "(- (error \"\e[31mError:\e[39m overflow, 300 does not fit into u8\" in 300))"));
+  TEST(foldTest("~300", NUM_U8, OVERFLOW_TRAP, 1,
+                "(~ (error \"\e[31mError:\e[39m overflow, 300 does not fit into u8\" in 300))"));
+  TEST(foldTest("-128", NUM_I8, OVERFLOW_TRAP, 1,
+                "(- (error \"\e[31mError:\e[39m overflow, 128 does not fit into i8\" in 128))"));
+  TEST(foldTest("300", NUM_U8, OVERFLOW_WRAP, 1, "44"));
+  TEST(foldTest("+300", NUM_U8, OVERFLOW_WRAP, 1, "44"));
+  TEST(foldTest("-300", NUM_U8, OVERFLOW_WRAP, 2, "212"));
+  TEST(foldTest("~300", NUM_U8, OVERFLOW_WRAP, 1, "211"));
+  TEST(foldTest("300", NUM_U8, OVERFLOW_SATURATE, 1, "255"));
+  TEST(foldTest("+300", NUM_U8, OVERFLOW_SATURATE, 1, "255"));
+  TEST(foldTest("-300", NUM_U8, OVERFLOW_SATURATE, 2, "0"));
+  TEST(foldTest("~300", NUM_U8, OVERFLOW_SATURATE, 1, "0"));
+  TEST(foldTest("x + 300", NUM_U8, OVERFLOW_WRAP, 1, "(+ x 44)"));
+  return result;
+}
+
+
+TestResult fold_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<fold>", "Test the constant folding.");
+  addTest(&suite, testFoldArithmetic);
+  addTest(&suite, testFoldUnary);
+  addTest(&suite, testFoldPartially);
+  addTest(&suite, testFoldDivisionByZero);
+  addTest(&suite, testFoldOverflow);
+  addTest(&suite, testFoldLiteralOverflow);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
@@ -11,6 +11,8 @@
 
 
 GENERATE_ASSERT_EQUAL_ENUM(TokenKind)
+GENERATE_ASSERT_EQUAL_ENUM(Keyword)
+GENERATE_ASSERT_EQUAL_ENUM(Symbol)
 
 
 #define msg(loc, msg, line, spaces, indicator) \
@@ -26,18 +28,63 @@ static Error* error(Location loc, const char* message) {
 }
 
 
-static Token token(TokenKind kind, Location start, Location end, const char* chars) {
-  return (Token){ .kind=kind, .source=NULL, .start=start, .end=end,
-                  .chars=stringFromArray(chars), .error=NULL
-                };
+/**
+ * `ExpectedToken` is a token together with the locations and the rendered error, which tokens do
+ * not store.
+ */
+typedef struct ExpectedToken {
+  Token    token;
+  Location start;
+  Location end;
+  Error*   error;
+} ExpectedToken;
+
+
+/**
+ * The value of an integer token is computed by `numFromString()`, which is a plain loop over the
+ * digits, thus it cross-checks the lexer's word-wise computation.
+ */
+static ExpectedToken token(TokenKind kind, Location start, Location end, const char* chars) {
+  uint64_t value = (kind == TOKEN_INT) ? numFromString(stringFromArray(chars)).value : 0;
+  Token t = { .kind=kind, .value=value, .source=NULL, .chars=stringFromArray(chars) };
+  return (ExpectedToken){ .token=t, .start=start, .end=end, .error=NULL };
 }
 
 
-static Token tokenError(Location start, Location end, const char* chars, Location errorLoc,
-                        const char* message) {
-  return (Token){ .kind=TOKEN_ERROR, .source=NULL, .start=start, .end=end,
-                  .chars=stringFromArray(chars), .error=error(errorLoc, message)
-                };
+static ExpectedToken literal(TokenKind kind, Location start, Location end, const char* chars,
+                             uint64_t value) {
+  ExpectedToken t = token(kind, start, end, chars);
+  t.token.value = value;
+  return t;
+}
+
+
+static ExpectedToken floating(Location start, Location end, const char* chars, double value) {
+  ExpectedToken t = token(TOKEN_FLOAT, start, end, chars);
+  t.token.floatValue = value;
+  return t;
+}
+
+
+static ExpectedToken keyword(Keyword keyword, Location start, Location end, const char* chars) {
+  ExpectedToken t = token(TOKEN_KEYWORD, start, end, chars);
+  t.token.keyword = keyword;
+  return t;
+}
+
+
+static ExpectedToken symbol(Symbol symbol, Location start, Location end, const char* chars) {
+  ExpectedToken t = token(TOKEN_SYMBOL, start, end, chars);
+  t.token.symbol = symbol;
+  return t;
+}
+
+
+static ExpectedToken tokenError(Location start, Location end, const char* chars,
+                                Location errorLoc, const char* message) {
+  ExpectedToken t = token(TOKEN_ERROR, start, end, chars);
+  t.error = error(errorLoc, message);
+  return t;
 }
 
 
@@ -63,23 +110,26 @@ static bool __assertEqualLocation(const char* file, int line, Location loc, Loca
 
 
 #define assertEqualToken(t, exp)  __assertEqualToken(__FILE__, __LINE__, t, exp)
-static bool __assertEqualToken(const char* file, int line, Token t, Token exp) {
+static bool __assertEqualToken(const char* file, int line, Token t, ExpectedToken expected) {
+  Token exp = expected.token;
   bool equal = assertEqualEnum(TokenKind, t.kind, exp.kind);
   if (!equal) {
     return false;
   }
 
   printVerbose(__PROMPT, file, line);
-  if (!equalLoc(t.start, exp.start)) {
+  Location start = tokenStart(t);
+  if (!equalLoc(start, expected.start)) {
     printVerbose(RED "ERROR: " RST);
     printVerbose("expected Location [%d:%d] == [%d:%d]\n",
-                 t.start.line, t.start.pos, exp.start.line, exp.start.pos);
+                 start.line, start.pos, expected.start.line, expected.start.pos);
     return false;
   }
-  if (!equalLoc(t.end, exp.end)) {
+  Location end = tokenEnd(t);
+  if (!equalLoc(end, expected.end)) {
     printVerbose(RED "ERROR: " RST);
     printVerbose("expected Location [%d:%d] == [%d:%d]\n",
-                 t.end.line, t.end.pos, exp.end.line, exp.end.pos);
+                 end.line, end.pos, expected.end.line, expected.end.pos);
     return false;
   }
   printVerbose(GRN "OK\n" RST);
@@ -89,26 +139,44 @@ static bool __assertEqualToken(const char* file, int line, Token t, Token exp) {
     return false;
   }
 
-  if (exp.kind != TOKEN_ERROR) {
-    return true;
+  if (exp.kind == TOKEN_KEYWORD) {
+    equal = __assertEqualKeyword(file, line, t.keyword, exp.keyword);
+  } else if (exp.kind == TOKEN_SYMBOL) {
+    equal = __assertEqualSymbol(file, line, t.symbol, exp.symbol);
+  } else if (exp.kind != TOKEN_ERROR) {
+    equal = __assertEqualKeyword(file, line, t.keyword, KEYWORD_NONE);
   }
-
-  equal = __assertNotNull(file, line, t.error);
   if (!equal) {
     return false;
   }
 
+  if (exp.kind != TOKEN_ERROR) {
+    printVerbose(__PROMPT, file, line);
+    if (t.value != exp.value) {
+      printVerbose(RED "ERROR: " RST);
+      printVerbose("expected value [%llu] == [%llu]\n",
+                   (unsigned long long) t.value, (unsigned long long) exp.value);
+      return false;
+    }
+    printVerbose(GRN "OK\n" RST);
+    return true;
+  }
+
   printVerbose(__PROMPT, file, line);
-  if (!equalLoc(t.error->location, exp.error->location)) {
+  Error error = errorFromToken(t);
+  if (!equalLoc(error.location, expected.error->location)) {
     printVerbose(RED "ERROR: " RST);
     printVerbose("expected Location [%d:%d] == [%d:%d]\n",
-                 t.error->location.line, t.error->location.pos,
-                 exp.error->location.line, exp.error->location.pos);
+                 error.location.line, error.location.pos,
+                 expected.error->location.line, expected.error->location.pos);
+    deleteError(&error);
     return false;
   }
   printVerbose(GRN "OK\n" RST);
 
-  return __assertEqualStr(file, line, t.error->message, exp.error->message.chars);
+  equal = __assertEqualStr(file, line, error.message, expected.error->message.chars);
+  deleteError(&error);
+  return equal;
 }
 
 
@@ -117,7 +185,7 @@ typedef struct TestCase {
   int         line;
   char*       name;
   char*       input;
-  SBUF(Token) tokens;
+  SBUF(ExpectedToken) tokens;
 } TestCase;
 
 
@@ -133,7 +201,7 @@ static TestResult testFunc() {
 
   for (int i = 0; i < sbufLength(testCase->tokens); i++) {
     Token token = nextToken(&lexer);
-    Token exp = testCase->tokens[i];
+    ExpectedToken exp = testCase->tokens[i];
 
     /* Assume that all tests are created as
      * addTest(&suite, numTok,
@@ -145,16 +213,13 @@ static TestResult testFunc() {
      */
     int line = testCase->line - sbufLength(testCase->tokens) + i;
     TEST(__assertEqualToken(testCase->file, line, token, exp));
-    if (token.kind == TOKEN_ERROR) {
-      deleteError(token.error);
-      free(token.error);
-    }
-    if (exp.kind == TOKEN_ERROR) {
+    if (exp.error != NULL) {
       deleteError(exp.error);
       free(exp.error);
     }
   }
 
+  deleteLexer(&lexer);
   deleteSource(&src);
   return result;
 }
@@ -207,7 +272,7 @@ static void __createTest(const char* file, int line, TestSuite* suite, const cha
   va_list args;
   va_start(args, numTokens);
   for (int i = 0; i < numTokens; i++) {
-    Token token = va_arg(args, Token);
+    ExpectedToken token = va_arg(args, ExpectedToken);
     sbufPush(testCase.tokens, token);
   }
   va_end(args);
@@ -229,8 +294,524 @@ static TestResult testCreation() {
     TEST(assertEqualStr(lexer.source->content, "foo bar"));
     TEST(assertEqualInt(lexer.index, 0));
     TEST(assertEqualChar(lexer.currentChar, 0));
-    TEST(assertEqualLocation(lexer.currentLoc, loc(0, 0)));
-    TEST(assertEqualLocation(lexer.nextLoc, loc(1, 1)));
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+/**
+ * Returns the location after the given characters.
+ */
+static Location locationAfter(const char* chars, int length) {
+  Location next = loc(1, 1);
+  for (int i = 0; i < length; i++) {
+    next = (chars[i] == '\n') ? loc(next.line + 1, 1) : loc(next.line, next.pos + 1);
+  }
+  return next;
+}
+
+
+static TestResult testLongRuns() {
+  TestResult result = {};
+
+  // the runs end at every position within and beyond a SIMD block
+  for (int n = 1; n <= 80; n++) {
+    char* input = (char*) malloc(n + 8);
+
+    {
+      memset(input, 'a', n);
+      strcpy(input + n, " b");
+      Source src = sourceFromString(input);
+      Lexer lexer = lexerFromSource(&src);
+      Token token = nextToken(&lexer);
+      TEST(assertEqualInt(token.kind, TOKEN_NAME));
+      TEST(assertEqualSize(token.chars.len, n));
+      TEST(assertEqualLocation(tokenEnd(token), loc(1, n)));
+      token = nextToken(&lexer);
+      TEST(assertEqualLocation(tokenStart(token), loc(1, n + 2)));
+      deleteSource(&src);
+    }
+
+    {
+      for (int i = 0; i < n; i++) {
+        input[i] = (i % 5 == 4) ? '\n' : (i % 3 == 0) ? '\t' : ' ';
+      }
+      strcpy(input + n, "x");
+      Source src = sourceFromString(input);
+      Lexer lexer = lexerFromSource(&src);
+      Token token = nextToken(&lexer);
+      TEST(assertEqualInt(token.kind, TOKEN_NAME));
+      TEST(assertEqualLocation(tokenStart(token), locationAfter(input, n)));
+      deleteSource(&src);
+    }
+
+    {
+      strcpy(input, "//");
+      memset(input + 2, '/', n);
+      strcpy(input + n + 2, "\nx");
+      Source src = sourceFromString(input);
+      Lexer lexer = lexerFromSource(&src);
+      Token token = nextToken(&lexer);
+      TEST(assertEqualInt(token.kind, TOKEN_COMMENT));
+      TEST(assertEqualLocation(tokenEnd(token), loc(1, n + 2)));
+      token = nextToken(&lexer);
+      TEST(assertEqualLocation(tokenStart(token), loc(2, 1)));
+      deleteSource(&src);
+    }
+
+    {
+      strcpy(input, "/*");
+      for (int i = 0; i < n; i++) {
+        input[i+2] = (i % 7 == 6) ? '\n' : (i % 2 == 0) ? '*' : '-';
+      }
+      strcpy(input + n + 2, "*/x");
+      Source src = sourceFromString(input);
+      Lexer lexer = lexerFromSource(&src);
+      Token token = nextToken(&lexer);
+      TEST(assertEqualInt(token.kind, TOKEN_COMMENT));
+      TEST(assertEqualSize(token.chars.len, n + 4));
+      token = nextToken(&lexer);
+      TEST(assertEqualLocation(tokenStart(token), locationAfter(input, n + 4)));
+      deleteSource(&src);
+
+      input[n+2] = '\0';  // unclosed
+      src = sourceFromString(input);
+      lexer = lexerFromSource(&src);
+      token = nextToken(&lexer);
+      TEST(assertEqualInt(token.kind, TOKEN_ERROR));
+      TEST(assertEqualLocation(tokenEnd(token), locationAfter(input, n + 1)));
+      deleteLexer(&lexer);
+      deleteSource(&src);
+    }
+
+    free(input);
+  }
+
+  return result;
+}
+
+
+static TestResult testIntegerValues() {
+  TestResult result = {};
+
+  struct { const char* chars; uint64_t value; } ints[] = {
+    { "0",                                     0 },
+    { "12345678",                              12345678 },
+    { "123456789",                             123456789 },
+    { "1234_5678_9",                           123456789 },
+    { "00000000000000000000042",               42 },
+    { "9876543210987654321",                   9876543210987654321u },
+    { "18446744073709551615",                  18446744073709551615u },
+    { "0x0",                                   0 },
+    { "0xdeadBEEF",                            0xDEADBEEF },
+    { "0x123456789abcdef",                     0x123456789ABCDEF },
+    { "0xFFFF_FFFF_FFFF_FFFF",                 0xFFFFFFFFFFFFFFFF },
+    { "0x000000000000000000000001",            1 },
+    { "0b10110011",                            0xB3 },
+    { "0b1_0110_0111",                         0x167 },
+    { "0b1111111111111111111111111111111111111111111111111111111111111111",
+                                               0xFFFFFFFFFFFFFFFF },
+  };
+
+  for (int i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+    Source src = sourceFromString(ints[i].chars);
+    Lexer lexer = lexerFromSource(&src);
+    Token token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_INT));
+    TEST(assertTrue(token.value == ints[i].value));
+    deleteSource(&src);
+  }
+
+  const char* overflows[] = {
+    "18446744073709551616", "99999999999999999999", "1_0000_0000_0000_0000_0000",
+    "0x1_0000_0000_0000_0000", "0x123456789abcdef01",
+    "0b10000000000000000000000000000000000000000000000000000000000000000",
+  };
+
+  for (int i = 0; i < sizeof(overflows) / sizeof(overflows[0]); i++) {
+    Source src = sourceFromString(overflows[i]);
+    Lexer lexer = lexerFromSource(&src);
+    Token token = nextToken(&lexer);
+    ABORT(assertEqualInt(token.kind, TOKEN_ERROR));
+    TEST(assertEqualSize(token.chars.len, strlen(overflows[i])));
+    TEST(assertEqualInt(token.error, LEX_ERROR_INT_OVERFLOW));
+    TEST(assertEqualInt(token.caret, 0));
+    deleteLexer(&lexer);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testFloatValues() {
+  TestResult result = {};
+
+  struct { const char* chars; double value; } floats[] = {
+    { "0.0",                                   0.0 },
+    { "1.5",                                   1.5 },
+    { "0.1",                                   0.1 },
+    { "3_141.592_653e-3",                      3.141592653 },
+    { "1e10",                                  1e10 },
+    { "2E-3",                                  2e-3 },
+    { "6.022_140_76e+23",                      6.02214076e23 },
+    { "1.7976931348623157e308",                1.7976931348623157e308 },
+    { "4.9406564584124654e-324",               4.9406564584124654e-324 },
+    { "1e-400",                                0.0 },
+    { "0.100000000000000005551115123125782702118158340454101562500001",  0.1 },
+    { "0x1p0",                                 1.0 },
+    { "0x1.8p1",                               3.0 },
+    { "0xA_B.Cp-4",                            0xAB.Cp-4 },
+    { "0X1P-1074",                             0x1p-1074 },
+  };
+
+  for (int i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+    Source src = sourceFromString(floats[i].chars);
+    Lexer lexer = lexerFromSource(&src);
+    Token token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_FLOAT));
+    TEST(assertEqualSize(token.chars.len, strlen(floats[i].chars)));
+    TEST(assertTrue(token.floatValue == floats[i].value));
+    deleteSource(&src);
+  }
+
+  const char* overflows[] = {
+    "1e400", "1.7976931348623159e308", "1_000e1_000", "0x1p1024", "0x1.fffffffffffff8p1023",
+  };
+
+  for (int i = 0; i < sizeof(overflows) / sizeof(overflows[0]); i++) {
+    Source src = sourceFromString(overflows[i]);
+    Lexer lexer = lexerFromSource(&src);
+    Token token = nextToken(&lexer);
+    ABORT(assertEqualInt(token.kind, TOKEN_ERROR));
+    TEST(assertEqualSize(token.chars.len, strlen(overflows[i])));
+    TEST(assertEqualInt(token.error, LEX_ERROR_FLOAT_OVERFLOW));
+    TEST(assertEqualInt(token.caret, 0));
+    deleteLexer(&lexer);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testLiteralValues() {
+  TestResult result = {};
+
+  struct { const char* chars; const char* value; size_t length; } strings[] = {
+    { "\"\"",                        "",                  0 },
+    { "\"plain text\"",              "plain text",        10 },
+    { "\"a\\tb\\nc\"",                "a\tb\nc",           5 },
+    { "\"\\\\ \\\" \\' \\r\"",          "\\ \" ' \r",         7 },
+    { "\"\\x41\\x4a\\x4F\\x00z\"",       "AJO\0z",            5 },
+    { "\"\\0\\0\"",                  "\0\0",              2 },
+    { "\"\xC3\xA4\\n\"",             "\xC3\xA4\n",         3 },
+  };
+
+  for (int i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+    Source src = sourceFromString(strings[i].chars);
+    Lexer lexer = lexerFromSource(&src);
+    Arena arena = {};
+    Token token = nextToken(&lexer);
+    ABORT(assertEqualInt(token.kind, TOKEN_STRING));
+    TEST(assertTrue(token.value == strings[i].length));
+    string value = stringValue(token, &arena);
+    TEST(assertEqualSize(value.len, strings[i].length));
+    TEST(assertTrue(memcmp(value.chars, strings[i].value, strings[i].length) == 0));
+    bool escaped = (strchr(strings[i].chars, '\\') != NULL);
+    TEST(assertTrue(escaped == (arena.blocks != NULL)));  // only escapes are decoded
+    if (!escaped) {
+      TEST(assertSame(value.chars, token.chars.chars + 1));
+    }
+    arenaFree(&arena);
+    deleteLexer(&lexer);
+    deleteSource(&src);
+  }
+
+  struct { const char* chars; uint64_t value; } chars[] = {
+    { "'a'",              'a' },
+    { "' '",              ' ' },
+    { "'\"'",             '"' },
+    { "'\\''",            '\'' },
+    { "'\\\\'",           '\\' },
+    { "'\\n'",            '\n' },
+    { "'\\0'",            0 },
+    { "'\\xfF'",          0xFF },
+    { "'\xC3\xA4'",       0xE4 },
+    { "'\xE2\x82\xAC'",   0x20AC },
+    { "'\xF0\x9F\x98\x80'", 0x1F600 },
+  };
+
+  for (int i = 0; i < sizeof(chars) / sizeof(chars[0]); i++) {
+    Source src = sourceFromString(chars[i].chars);
+    Lexer lexer = lexerFromSource(&src);
+    Token token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_CHAR));
+    TEST(assertTrue(token.value == chars[i].value));
+    TEST(assertEqualSize(token.chars.len, strlen(chars[i].chars)));
+    deleteLexer(&lexer);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+/**
+ * A generated string table has long literals with escapes at all offsets within the SIMD blocks.
+ * The decoded strings are larger than an arena block.
+ */
+static TestResult testLongLiterals() {
+  TestResult result = {};
+
+  {
+    SBUF(char) input = NULL;
+    SBUF(char) expected = NULL;
+    for (int row = 0; row < 3; row++) {
+      sbufPush(input, '"');
+      for (int i = 0; i < 5000; i++) {
+        if (i % (row + 7) == 0) {
+          sbufPush(input, '\\');
+          sbufPush(input, 't');
+          sbufPush(expected, '\t');
+        } else {
+          sbufPush(input, 'a' + i % 26);
+          sbufPush(expected, 'a' + i % 26);
+        }
+      }
+      sbufPush(input, '"');
+      sbufPush(input, ',');
+      sbufPush(input, '\n');
+    }
+    sbufPush(input, '\0');
+
+    Source src = sourceFromString(input);
+    Lexer lexer = lexerFromSource(&src);
+    Arena arena = {};
+    for (int row = 0; row < 3; row++) {
+      Token token = nextToken(&lexer);
+      ABORT(assertEqualInt(token.kind, TOKEN_STRING));
+      TEST(assertTrue(token.value == 5000));
+      string value = stringValue(token, &arena);
+      TEST(assertEqualSize(value.len, 5000));
+      TEST(assertTrue(memcmp(value.chars, expected + row * 5000, 5000) == 0));
+      TEST(assertEqualInt(nextToken(&lexer).symbol, SYMBOL_COMMA));
+    }
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_EOF));
+    TEST(assertEqualSize(sbufLength(lexer.errors), 0));
+    arenaFree(&arena);
+    deleteLexer(&lexer);
+    deleteSource(&src);
+    sbufFree(expected);
+    sbufFree(input);
+  }
+
+  return result;
+}
+
+
+static TestResult testErrorRecords() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("x $ 0x 12\n1x /* open");
+    Lexer lexer = lexerFromSource(&src);
+    while (nextToken(&lexer).kind != TOKEN_EOF) {
+    }
+    ABORT(assertEqualSize(sbufLength(lexer.errors), 4));
+    TEST(assertEqualInt(lexer.errors[0].kind, LEX_ERROR_ILLEGAL_CHAR));
+    TEST(assertEqualInt(lexer.errors[0].offset, 2));
+    TEST(assertEqualInt(lexer.errors[1].kind, LEX_ERROR_HEX_DIGITS));
+    TEST(assertEqualInt(lexer.errors[1].offset, 4));
+    TEST(assertEqualInt(lexer.errors[2].kind, LEX_ERROR_INT_FORMAT));
+    TEST(assertEqualInt(lexer.errors[2].offset, 10));
+    TEST(assertEqualInt(lexer.errors[2].caret, 1));
+    TEST(assertEqualInt(lexer.errors[3].kind, LEX_ERROR_UNCLOSED_COMMENT));
+    TEST(assertEqualInt(lexer.errors[3].length, 7));
+
+    Error error = errorFromLexError(&src, lexer.errors[2]);
+    TEST(assertEqualLocation(error.location, loc(2, 2)));
+    TEST(assertEqualStr(error.message,
+                        msg("2:2", "invalid integer format", "1x /* open", "", "~^")));
+    deleteError(&error);
+    deleteLexer(&lexer);
+    TEST(assertNull(lexer.errors));
+    deleteSource(&src);
+  }
+
+  {
+    // a megabyte of junk yields a record per character, but renders no message
+    const size_t length = 1 << 20;
+    char* input = (char*) malloc(length + 1);
+    memset(input, '$', length);
+    input[length] = '\0';
+    Source src = sourceFromString(input);
+    Lexer lexer = lexerFromSource(&src);
+    size_t errors = 0;
+    for (Token token = nextToken(&lexer); token.kind != TOKEN_EOF; token = nextToken(&lexer)) {
+      errors += (token.error == LEX_ERROR_ILLEGAL_CHAR);
+    }
+    TEST(assertEqualSize(errors, length));
+    ABORT(assertEqualSize(sbufLength(lexer.errors), length));
+    TEST(assertEqualInt(lexer.errors[length-1].offset, length - 1));
+    deleteLexer(&lexer);
+    deleteSource(&src);
+    free(input);
+  }
+
+  return result;
+}
+
+
+static TestResult testTrivia() {
+  TestResult result = {};
+  const char* input = "x +/*c*/ y  // d\n\tz";
+
+  {
+    Source src = sourceFromString(input);
+    Lexer lexer = lexerFromSource(&src);
+    TEST(assertEqualInt(lexer.triviaMode, TRIVIA_TOKENS));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_NAME));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_SYMBOL));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_COMMENT));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_NAME));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_COMMENT));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_NAME));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_EOF));
+    TEST(assertNull(lexer.trivia));
+    deleteLexer(&lexer);
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString(input);
+    Lexer lexer = lexerFromSourceWith(&src, TRIVIA_DROP);
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_NAME));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_SYMBOL));
+    Token token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_NAME));
+    TEST(assertEqualStr(token.chars, "y"));
+    token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_NAME));
+    TEST(assertEqualStr(token.chars, "z"));
+    TEST(assertEqualLocation(tokenStart(token), loc(2, 2)));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_EOF));
+    TEST(assertNull(lexer.trivia));
+    deleteLexer(&lexer);
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString(input);
+    Lexer lexer = lexerFromSourceWith(&src, TRIVIA_COLLECT);
+    while (nextToken(&lexer).kind != TOKEN_EOF) {
+    }
+    struct { TriviaKind kind; int offset; int length; } expected[] = {
+      { TRIVIA_WHITESPACE, 1, 1 }, { TRIVIA_COMMENT, 3, 5 }, { TRIVIA_WHITESPACE, 8, 1 },
+      { TRIVIA_WHITESPACE, 10, 2 }, { TRIVIA_COMMENT, 12, 4 }, { TRIVIA_WHITESPACE, 16, 2 },
+    };
+    ABORT(assertEqualSize(sbufLength(lexer.trivia), 6));
+    for (int i = 0; i < 6; i++) {
+      TEST(assertEqualInt(lexer.trivia[i].kind, expected[i].kind));
+      TEST(assertEqualInt(lexer.trivia[i].offset, expected[i].offset));
+      TEST(assertEqualInt(lexer.trivia[i].length, expected[i].length));
+    }
+    deleteLexer(&lexer);
+    TEST(assertNull(lexer.trivia));
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("/* unclosed");  // errors are never trivia
+    Lexer lexer = lexerFromSourceWith(&src, TRIVIA_DROP);
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_ERROR));
+    TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_EOF));
+    deleteLexer(&lexer);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+/**
+ * Splits the tokens of the lexer into spans per line like `lexLine()` does.
+ */
+static SBUF(TokenSpan) splitTokens(const Source* src) {
+  SBUF(TokenSpan) spans = NULL;
+  Lexer lexer = lexerFromSource(src);
+  for (Token token = nextToken(&lexer); token.kind != TOKEN_EOF; token = nextToken(&lexer)) {
+    TokenKind kind = (token.kind == TOKEN_ERROR && token.error == LEX_ERROR_UNCLOSED_COMMENT)
+                   ? TOKEN_COMMENT : token.kind;
+    const char* start = token.chars.chars;
+    const char* end = token.chars.chars + token.chars.len;
+    while (start < end) {
+      const char* newline = memchr(start, '\n', end - start);
+      const char* stop = (newline != NULL) ? newline : end;
+      if (stop > start) {
+        sbufPush(spans, (TokenSpan){ .kind=kind, .offset=start - src->content.chars,
+                                     .length=stop - start });
+      }
+      start = (newline != NULL) ? newline + 1 : end;
+    }
+  }
+  deleteLexer(&lexer);
+  return spans;
+}
+
+
+static TestResult testLexLine() {
+  TestResult result = {};
+
+  const char* inputs[] = {
+    "var x := 1;  /* a comment\n\n   over lines */ y = 0x2A // z\n/*/ still */ 1x $\n",
+    "a /**/ b /* c\n*/\n/* d */ /* e\n\n*/ f /*\n g",
+    "/*",
+    "",
+    "x\r\n/* y\r\n*/ z\r\n",
+  };
+
+  for (int i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    Source src = sourceFromString(inputs[i]);
+    SBUF(LineState) states = lineStates(&src);
+    SBUF(TokenSpan) spans = NULL;
+    LineState state = LINE_CODE;
+    for (size_t line = src.firstLine; line < src.firstLine + sbufLength(states); line++) {
+      TEST(assertEqualInt(state, states[line - src.firstLine]));
+      state = lexLine(&src, line, states[line - src.firstLine], &spans);
+    }
+
+    SBUF(TokenSpan) expected = splitTokens(&src);
+    ABORT(assertEqualSize(sbufLength(spans), sbufLength(expected)));
+    for (size_t j = 0; j < sbufLength(spans); j++) {
+      TEST(assertEqualInt(spans[j].kind, expected[j].kind));
+      TEST(assertEqualInt(spans[j].offset, expected[j].offset));
+      TEST(assertEqualInt(spans[j].length, expected[j].length));
+    }
+
+    sbufFree(expected);
+    sbufFree(spans);
+    sbufFree(states);
+    deleteSource(&src);
+  }
+
+  {
+    // a visible line in the middle is lexed with its cached state only
+    Source src = sourceFromString("x\n/* a\nb\nc */ d\ne");
+    SBUF(TokenSpan) spans = NULL;
+    TEST(assertEqualInt(lexLine(&src, 3, LINE_COMMENT, &spans), LINE_COMMENT));
+    ABORT(assertEqualSize(sbufLength(spans), 1));
+    TEST(assertEqualInt(spans[0].kind, TOKEN_COMMENT));
+    TEST(assertEqualInt(spans[0].offset, 7));
+    TEST(assertEqualInt(spans[0].length, 1));
+    TEST(assertEqualInt(lexLine(&src, 4, LINE_COMMENT, &spans), LINE_CODE));
+    ABORT(assertEqualSize(sbufLength(spans), 3));
+    TEST(assertEqualInt(spans[1].length, 4));
+    TEST(assertEqualInt(spans[2].kind, TOKEN_NAME));
+    TEST(assertEqualInt(spans[2].offset, 14));
+    sbufFree(spans);
     deleteSource(&src);
   }
 
@@ -303,7 +884,7 @@ static void addTestsTokenName(TestSuite* suite) {
 
   in = "_";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 1), "_")
+    keyword(KEYWORD_BLANK, loc(1, 1), loc(1, 1), "_")
   );
 
   in = "x_";
@@ -515,87 +1096,100 @@ static void addTestsTokenKeyword(TestSuite* suite) {
 
   in = "if";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 2), "if")
+    keyword(KEYWORD_IF, loc(1, 1), loc(1, 2), "if")
   );
 
   in = "else";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 4), "else")
+    keyword(KEYWORD_ELSE, loc(1, 1), loc(1, 4), "else")
   );
 
   in = "do";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 2), "do")
+    keyword(KEYWORD_DO, loc(1, 1), loc(1, 2), "do")
   );
 
   in = "while";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 5), "while")
+    keyword(KEYWORD_WHILE, loc(1, 1), loc(1, 5), "while")
   );
 
   in = "for";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 3), "for")
+    keyword(KEYWORD_FOR, loc(1, 1), loc(1, 3), "for")
   );
 
   in = "switch";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 6), "switch")
+    keyword(KEYWORD_SWITCH, loc(1, 1), loc(1, 6), "switch")
   );
 
   in = "case";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 4), "case")
+    keyword(KEYWORD_CASE, loc(1, 1), loc(1, 4), "case")
   );
 
   in = "break";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 5), "break")
+    keyword(KEYWORD_BREAK, loc(1, 1), loc(1, 5), "break")
   );
 
   in = "continue";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 8), "continue")
+    keyword(KEYWORD_CONTINUE, loc(1, 1), loc(1, 8), "continue")
   );
 
   in = "return";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 6), "return")
+    keyword(KEYWORD_RETURN, loc(1, 1), loc(1, 6), "return")
   );
 
   in = "true";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 4), "true")
+    keyword(KEYWORD_TRUE, loc(1, 1), loc(1, 4), "true")
   );
 
   in = "false";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 5), "false")
+    keyword(KEYWORD_FALSE, loc(1, 1), loc(1, 5), "false")
   );
 
   in = "var";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 3), "var")
+    keyword(KEYWORD_VAR, loc(1, 1), loc(1, 3), "var")
   );
 
   in = "const";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 5), "const")
+    keyword(KEYWORD_CONST, loc(1, 1), loc(1, 5), "const")
   );
 
   in = "func";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 4), "func")
+    keyword(KEYWORD_FUNC, loc(1, 1), loc(1, 4), "func")
   );
 
   in = "struct";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 6), "struct")
+    keyword(KEYWORD_STRUCT, loc(1, 1), loc(1, 6), "struct")
   );
 
   in = "_";
   createTest(suite, in, 1,
-    token(TOKEN_KEYWORD, loc(1, 1), loc(1, 1), "_")
+    keyword(KEYWORD_BLANK, loc(1, 1), loc(1, 1), "_")
+  );
+
+  // names that share length, first and last character with a keyword
+  in = "iff ief elze Else dxo ware __ ctrue";
+  createTest(suite, in, 8,
+    token(TOKEN_NAME, loc(1, 1), loc(1, 3), "iff"),
+    token(TOKEN_NAME, loc(1, 5), loc(1, 7), "ief"),
+    token(TOKEN_NAME, loc(1, 9), loc(1, 12), "elze"),
+    token(TOKEN_NAME, loc(1, 14), loc(1, 17), "Else"),
+    token(TOKEN_NAME, loc(1, 19), loc(1, 21), "dxo"),
+    token(TOKEN_NAME, loc(1, 23), loc(1, 26), "ware"),
+    token(TOKEN_NAME, loc(1, 28), loc(1, 29), "__"),
+    token(TOKEN_NAME, loc(1, 31), loc(1, 35), "ctrue")
   );
 }
 
@@ -605,52 +1199,52 @@ static void addTestsTokenSeparator(TestSuite* suite) {
 
   in = "(";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "(")
+    symbol(SYMBOL_LPAREN, loc(1, 1), loc(1, 1), "(")
   );
 
   in = ")";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), ")")
+    symbol(SYMBOL_RPAREN, loc(1, 1), loc(1, 1), ")")
   );
 
   in = "[";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "[")
+    symbol(SYMBOL_LBRACKET, loc(1, 1), loc(1, 1), "[")
   );
 
   in = "]";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "]")
+    symbol(SYMBOL_RBRACKET, loc(1, 1), loc(1, 1), "]")
   );
 
   in = "{";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "{")
+    symbol(SYMBOL_LBRACE, loc(1, 1), loc(1, 1), "{")
   );
 
   in = "}";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "}")
+    symbol(SYMBOL_RBRACE, loc(1, 1), loc(1, 1), "}")
   );
 
   in = ",";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), ",")
+    symbol(SYMBOL_COMMA, loc(1, 1), loc(1, 1), ",")
   );
 
   in = ";";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), ";")
+    symbol(SYMBOL_SEMICOLON, loc(1, 1), loc(1, 1), ";")
   );
 
   in = ":";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), ":")
+    symbol(SYMBOL_COLON, loc(1, 1), loc(1, 1), ":")
   );
 
   in = ".";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), ".")
+    symbol(SYMBOL_DOT, loc(1, 1), loc(1, 1), ".")
   );
 }
 
@@ -660,39 +1254,39 @@ static void addTestsTokenOperator(TestSuite* suite) {
 
   in = "+";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "+")
+    symbol(SYMBOL_PLUS, loc(1, 1), loc(1, 1), "+")
   );
 
   in = "++";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "+"),
-    token(TOKEN_SYMBOL, loc(1, 2), loc(1, 2), "+")
+    symbol(SYMBOL_PLUS, loc(1, 1), loc(1, 1), "+"),
+    symbol(SYMBOL_PLUS, loc(1, 2), loc(1, 2), "+")
   );
 
   in = "-";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "-")
+    symbol(SYMBOL_MINUS, loc(1, 1), loc(1, 1), "-")
   );
 
   in = "--";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "-"),
-    token(TOKEN_SYMBOL, loc(1, 2), loc(1, 2), "-")
+    symbol(SYMBOL_MINUS, loc(1, 1), loc(1, 1), "-"),
+    symbol(SYMBOL_MINUS, loc(1, 2), loc(1, 2), "-")
   );
 
   in = "*";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "*")
+    symbol(SYMBOL_STAR, loc(1, 1), loc(1, 1), "*")
   );
 
   in = "/";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "/")
+    symbol(SYMBOL_SLASH, loc(1, 1), loc(1, 1), "/")
   );
 
   in = "%";
   createTest(suite, in, 1,
-    token(TOKEN_SYMBOL, loc(1, 1), loc(1, 1), "%")
+    symbol(SYMBOL_PERCENT, loc(1, 1), loc(1, 1), "%")
   );
 }
 
@@ -813,146 +1407,328 @@ static void addTestsTokenComment(TestSuite* suite) {
 }
 
 
+static void addTestsTokenFloat(TestSuite* suite) {
+  const char* in;
+
+  in = "1.5";
+  createTest(suite, in, 1,
+    floating(loc(1, 1), loc(1, 3), "1.5", 1.5)
+  );
+
+  in = "2e-3 1_0.2_5E+1_0";
+  createTest(suite, in, 2,
+    floating(loc(1, 1), loc(1, 4), "2e-3", 2e-3),
+    floating(loc(1, 6), loc(1, 17), "1_0.2_5E+1_0", 10.25e10)
+  );
+
+  in = "0x1.8p3";
+  createTest(suite, in, 1,
+    floating(loc(1, 1), loc(1, 7), "0x1.8p3", 12.0)
+  );
+
+  in = "1.x";
+  createTest(suite, in, 3,
+    token(TOKEN_INT, loc(1, 1), loc(1, 1), "1"),
+    symbol(SYMBOL_DOT, loc(1, 2), loc(1, 2), "."),
+    token(TOKEN_NAME, loc(1, 3), loc(1, 3), "x")
+  );
+
+  in = "1.5x";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 4), "1.5x", loc(1, 4),
+               msg("1:4", "invalid float format", "1.5x", "", "~~~^"))
+  );
+
+  in = "1e+x";
+  createTest(suite, in, 3,
+    tokenError(loc(1, 1), loc(1, 2), "1e", loc(1, 2),
+               msg("1:2", "invalid integer format", "1e+x", "", "~^")),
+    symbol(SYMBOL_PLUS, loc(1, 3), loc(1, 3), "+"),
+    token(TOKEN_NAME, loc(1, 4), loc(1, 4), "x")
+  );
+
+  in = "0x1.8";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 5), "0x1.8", loc(1, 4),
+               msg("1:4", "hex float must have a binary exponent", "0x1.8", "", "~~~^~"))
+  );
+
+  in = "1e400";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 5), "1e400", loc(1, 1),
+               msg("1:1", "float does not fit into a double", "1e400", "", "^~~~~"))
+  );
+}
+
+
+static void addTestsTokenString(TestSuite* suite) {
+  const char* in;
+
+  in = "\"abc\"";
+  createTest(suite, in, 1,
+    literal(TOKEN_STRING, loc(1, 1), loc(1, 5), "\"abc\"", 3)
+  );
+
+  in = "\"\"";
+  createTest(suite, in, 1,
+    literal(TOKEN_STRING, loc(1, 1), loc(1, 2), "\"\"", 0)
+  );
+
+  in = "\"a\\\\tb\\\\x41\"";
+  createTest(suite, in, 1,
+    literal(TOKEN_STRING, loc(1, 1), loc(1, 10), "\"a\\tb\\x41\"", 4)
+  );
+
+  in = "\"a\\\\\\\"b\" x";
+  createTest(suite, in, 2,
+    literal(TOKEN_STRING, loc(1, 1), loc(1, 6), "\"a\\\"b\"", 3),
+    token(TOKEN_NAME, loc(1, 8), loc(1, 8), "x")
+  );
+
+  in = "\"// no comment /* here\"";
+  createTest(suite, in, 1,
+    literal(TOKEN_STRING, loc(1, 1), loc(1, 23), "\"// no comment /* here\"", 21)
+  );
+
+  in = "\"abc";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 4), "\"abc", loc(1, 1),
+               msg("1:1", "unclosed string literal", "\"abc", "", "^~~~"))
+  );
+
+  in = "\"ab\nx";
+  createTest(suite, in, 2,
+    tokenError(loc(1, 1), loc(1, 3), "\"ab", loc(1, 1),
+               msg("1:1", "unclosed string literal", "\"ab", "", "^~~")),
+    token(TOKEN_NAME, loc(2, 1), loc(2, 1), "x")
+  );
+
+  in = "\"a\\\\qb\"";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 6), "\"a\\qb\"", loc(1, 4),
+               msg("1:4", "invalid escape sequence", "\"a\\qb\"", "", "~~~^~~"))
+  );
+
+  in = "\"\\\\x4g\"";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 6), "\"\\x4g\"", loc(1, 5),
+               msg("1:5", "invalid escape sequence", "\"\\x4g\"", "", "~~~~^~"))
+  );
+}
+
+
+static void addTestsTokenChar(TestSuite* suite) {
+  const char* in;
+
+  in = "'a'";
+  createTest(suite, in, 1,
+    literal(TOKEN_CHAR, loc(1, 1), loc(1, 3), "'a'", 'a')
+  );
+
+  in = "'\\\\n' '\\\\''";
+  createTest(suite, in, 2,
+    literal(TOKEN_CHAR, loc(1, 1), loc(1, 4), "'\\n'", '\n'),
+    literal(TOKEN_CHAR, loc(1, 6), loc(1, 9), "'\\''", '\'')
+  );
+
+  in = "'\xC3\xA4'";
+  createTest(suite, in, 1,
+    literal(TOKEN_CHAR, loc(1, 1), loc(1, 4), "'\xC3\xA4'", 0xE4)
+  );
+
+  in = "''";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 2), "''", loc(1, 2),
+               msg("1:2", "character literal must contain exactly one character", "''", "",
+                   "~^"))
+  );
+
+  in = "'ab'";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 4), "'ab'", loc(1, 3),
+               msg("1:3", "character literal must contain exactly one character", "'ab'", "",
+                   "~~^~"))
+  );
+
+  in = "'a";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 2), "'a", loc(1, 1),
+               msg("1:1", "unclosed character literal", "'a", "", "^~"))
+  );
+
+  in = "'\\\\q'";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 4), "'\\q'", loc(1, 3),
+               msg("1:3", "invalid escape sequence", "'\\q'", "", "~~^~"))
+  );
+}
+
+
+static void addTestsIllegalCharacter(TestSuite* suite) {
+  const char* in;
+
+  in = "$";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 1), "$", loc(1, 1),
+               msg("1:1", "illegal character '$'", "$", "", "^"))
+  );
+
+  in = "\xC3\xA4";
+  createTest(suite, in, 1,
+    tokenError(loc(1, 1), loc(1, 2), "\xC3\xA4", loc(1, 1),
+               msg("1:1", "illegal character '\xC3\xA4'", "\xC3\xA4", "", "^~"))
+  );
+
+  in = "x\xE2\x82\xACy";
+  createTest(suite, in, 3,
+    token(TOKEN_NAME, loc(1, 1), loc(1, 1), "x"),
+    tokenError(loc(1, 2), loc(1, 4), "\xE2\x82\xAC", loc(1, 2),
+               msg("1:2", "illegal character '\xE2\x82\xAC'", "x\xE2\x82\xACy", " ", "^~~")),
+    token(TOKEN_NAME, loc(1, 5), loc(1, 5), "y")
+  );
+}
+
+
 static void addTestsDeclarations(TestSuite* suite) {
   const char* in;
 
   in = "var x : int;  // x = 0";
   createTest(suite, in, 7,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  3), "var"),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  5), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  7), loc(1,  7), ":"),
-    token(TOKEN_NAME,    loc(1,  9), loc(1, 11), "int"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), ";"),
-    token(TOKEN_COMMENT, loc(1, 15), loc(1, 22), "// x = 0"),
-    token(TOKEN_EOF,     loc(1, 23), loc(1, 23), "")
+    keyword(KEYWORD_VAR,     loc(1,  1), loc(1,  3), "var"),
+    token(TOKEN_NAME,        loc(1,  5), loc(1,  5), "x"),
+    symbol(SYMBOL_COLON,     loc(1,  7), loc(1,  7), ":"),
+    token(TOKEN_NAME,        loc(1,  9), loc(1, 11), "int"),
+    symbol(SYMBOL_SEMICOLON, loc(1, 12), loc(1, 12), ";"),
+    token(TOKEN_COMMENT,     loc(1, 15), loc(1, 22), "// x = 0"),
+    token(TOKEN_EOF,         loc(1, 23), loc(1, 23), "")
   );
 
   in = "var x : int = 123;  /* x = 123 */";
   createTest(suite, in, 9,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  3), "var"),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  5), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  7), loc(1,  7), ":"),
-    token(TOKEN_NAME,    loc(1,  9), loc(1, 11), "int"),
-    token(TOKEN_SYMBOL,  loc(1, 13), loc(1, 13), "="),
-    token(TOKEN_INT,     loc(1, 15), loc(1, 17), "123"),
-    token(TOKEN_SYMBOL,  loc(1, 18), loc(1, 18), ";"),
-    token(TOKEN_COMMENT, loc(1, 21), loc(1, 33), "/* x = 123 */"),
-    token(TOKEN_EOF,     loc(1, 34), loc(1, 34), "")
+    keyword(KEYWORD_VAR,     loc(1,  1), loc(1,  3), "var"),
+    token(TOKEN_NAME,        loc(1,  5), loc(1,  5), "x"),
+    symbol(SYMBOL_COLON,     loc(1,  7), loc(1,  7), ":"),
+    token(TOKEN_NAME,        loc(1,  9), loc(1, 11), "int"),
+    symbol(SYMBOL_ASSIGN,    loc(1, 13), loc(1, 13), "="),
+    token(TOKEN_INT,         loc(1, 15), loc(1, 17), "123"),
+    symbol(SYMBOL_SEMICOLON, loc(1, 18), loc(1, 18), ";"),
+    token(TOKEN_COMMENT,     loc(1, 21), loc(1, 33), "/* x = 123 */"),
+    token(TOKEN_EOF,         loc(1, 34), loc(1, 34), "")
   );
 
   in = "var mask := 0b1010_1011;";
   createTest(suite, in, 7,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  3), "var"),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  8), "mask"),
-    token(TOKEN_SYMBOL,  loc(1, 10), loc(1, 10), ":"),
-    token(TOKEN_SYMBOL,  loc(1, 11), loc(1, 11), "="),
-    token(TOKEN_INT,     loc(1, 13), loc(1, 23), "0b1010_1011"),
-    token(TOKEN_SYMBOL,  loc(1, 24), loc(1, 24), ";"),
-    token(TOKEN_EOF,     loc(1, 25), loc(1, 25), "")
+    keyword(KEYWORD_VAR,     loc(1,  1), loc(1,  3), "var"),
+    token(TOKEN_NAME,        loc(1,  5), loc(1,  8), "mask"),
+    symbol(SYMBOL_COLON,     loc(1, 10), loc(1, 10), ":"),
+    symbol(SYMBOL_ASSIGN,    loc(1, 11), loc(1, 11), "="),
+    token(TOKEN_INT,         loc(1, 13), loc(1, 23), "0b1010_1011"),
+    symbol(SYMBOL_SEMICOLON, loc(1, 24), loc(1, 24), ";"),
+    token(TOKEN_EOF,         loc(1, 25), loc(1, 25), "")
   );
 
   in = "const ADDR := 0x_AB40_;";
   createTest(suite, in, 7,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  5), "const"),
-    token(TOKEN_NAME,    loc(1,  7), loc(1, 10), "ADDR"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), ":"),
-    token(TOKEN_SYMBOL,  loc(1, 13), loc(1, 13), "="),
-    token(TOKEN_INT,     loc(1, 15), loc(1, 22), "0x_AB40_"),
-    token(TOKEN_SYMBOL,  loc(1, 23), loc(1, 23), ";"),
-    token(TOKEN_EOF,     loc(1, 24), loc(1, 24), "")
+    keyword(KEYWORD_CONST,   loc(1,  1), loc(1,  5), "const"),
+    token(TOKEN_NAME,        loc(1,  7), loc(1, 10), "ADDR"),
+    symbol(SYMBOL_COLON,     loc(1, 12), loc(1, 12), ":"),
+    symbol(SYMBOL_ASSIGN,    loc(1, 13), loc(1, 13), "="),
+    token(TOKEN_INT,         loc(1, 15), loc(1, 22), "0x_AB40_"),
+    symbol(SYMBOL_SEMICOLON, loc(1, 23), loc(1, 23), ";"),
+    token(TOKEN_EOF,         loc(1, 24), loc(1, 24), "")
   );
 
   in = "var a_1 := 0x_;";
   createTest(suite, in, 7,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  3), "var"),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  7), "a_1"),
-    token(TOKEN_SYMBOL,  loc(1,  9), loc(1,  9), ":"),
-    token(TOKEN_SYMBOL,  loc(1, 10), loc(1, 10), "="),
+    keyword(KEYWORD_VAR,     loc(1,  1), loc(1,  3), "var"),
+    token(TOKEN_NAME,        loc(1,  5), loc(1,  7), "a_1"),
+    symbol(SYMBOL_COLON,     loc(1,  9), loc(1,  9), ":"),
+    symbol(SYMBOL_ASSIGN,    loc(1, 10), loc(1, 10), "="),
     tokenError(loc(1, 12), loc(1, 14), "0x_", loc(1, 14),
                msg("1:14", "hex integer must have at least one digit",
                    "var a_1 := 0x_;", "           ", "~~^")),
-    token(TOKEN_SYMBOL,  loc(1, 15), loc(1, 15), ";"),
-    token(TOKEN_EOF,     loc(1, 16), loc(1, 16), "")
+    symbol(SYMBOL_SEMICOLON, loc(1, 15), loc(1, 15), ";"),
+    token(TOKEN_EOF,         loc(1, 16), loc(1, 16), "")
   );
 
   in = "func f : () -> int {\\n return -1;\\n }";
   createTest(suite, in, 14,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  4), "func"),
-    token(TOKEN_NAME,    loc(1,  6), loc(1,  6), "f"),
-    token(TOKEN_SYMBOL,  loc(1,  8), loc(1,  8), ":"),
-    token(TOKEN_SYMBOL,  loc(1, 10), loc(1, 10), "("),
-    token(TOKEN_SYMBOL,  loc(1, 11), loc(1, 11), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 13), loc(1, 14), "->"),
-    token(TOKEN_NAME,    loc(1, 16), loc(1, 18), "int"),
-    token(TOKEN_SYMBOL,  loc(1, 20), loc(1, 20), "{"),
-    token(TOKEN_KEYWORD, loc(2,  2), loc(2,  7), "return"),
-    token(TOKEN_SYMBOL,  loc(2,  9), loc(2,  9), "-"),
-    token(TOKEN_INT,     loc(2, 10), loc(2, 10), "1"),
-    token(TOKEN_SYMBOL,  loc(2, 11), loc(2, 11), ";"),
-    token(TOKEN_SYMBOL,  loc(3,  2), loc(3,  2), "}"),
-    token(TOKEN_EOF,     loc(3,  3), loc(3,  3), "")
+    keyword(KEYWORD_FUNC,    loc(1,  1), loc(1,  4), "func"),
+    token(TOKEN_NAME,        loc(1,  6), loc(1,  6), "f"),
+    symbol(SYMBOL_COLON,     loc(1,  8), loc(1,  8), ":"),
+    symbol(SYMBOL_LPAREN,    loc(1, 10), loc(1, 10), "("),
+    symbol(SYMBOL_RPAREN,    loc(1, 11), loc(1, 11), ")"),
+    symbol(SYMBOL_ARROW,     loc(1, 13), loc(1, 14), "->"),
+    token(TOKEN_NAME,        loc(1, 16), loc(1, 18), "int"),
+    symbol(SYMBOL_LBRACE,    loc(1, 20), loc(1, 20), "{"),
+    keyword(KEYWORD_RETURN,  loc(2,  2), loc(2,  7), "return"),
+    symbol(SYMBOL_MINUS,     loc(2,  9), loc(2,  9), "-"),
+    token(TOKEN_INT,         loc(2, 10), loc(2, 10), "1"),
+    symbol(SYMBOL_SEMICOLON, loc(2, 11), loc(2, 11), ";"),
+    symbol(SYMBOL_RBRACE,    loc(3,  2), loc(3,  2), "}"),
+    token(TOKEN_EOF,         loc(3,  3), loc(3,  3), "")
   );
 
   in = "func f : (a: int, b: int) -> int { return a+b; }";
   createTest(suite, in, 22,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  4), "func"),
-    token(TOKEN_NAME,    loc(1,  6), loc(1,  6), "f"),
-    token(TOKEN_SYMBOL,  loc(1,  8), loc(1,  8), ":"),
-    token(TOKEN_SYMBOL,  loc(1, 10), loc(1, 10), "("),
-    token(TOKEN_NAME,    loc(1, 11), loc(1, 11), "a"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), ":"),
-    token(TOKEN_NAME,    loc(1, 14), loc(1, 16), "int"),
-    token(TOKEN_SYMBOL,  loc(1, 17), loc(1, 17), ","),
-    token(TOKEN_NAME,    loc(1, 19), loc(1, 19), "b"),
-    token(TOKEN_SYMBOL,  loc(1, 20), loc(1, 20), ":"),
-    token(TOKEN_NAME,    loc(1, 22), loc(1, 24), "int"),
-    token(TOKEN_SYMBOL,  loc(1, 25), loc(1, 25), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 27), loc(1, 28), "->"),
-    token(TOKEN_NAME,    loc(1, 30), loc(1, 32), "int"),
-    token(TOKEN_SYMBOL,  loc(1, 34), loc(1, 34), "{"),
-    token(TOKEN_KEYWORD, loc(1, 36), loc(1, 41), "return"),
-    token(TOKEN_NAME,    loc(1, 43), loc(1, 43), "a"),
-    token(TOKEN_SYMBOL,  loc(1, 44), loc(1, 44), "+"),
-    token(TOKEN_NAME,    loc(1, 45), loc(1, 45), "b"),
-    token(TOKEN_SYMBOL,  loc(1, 46), loc(1, 46), ";"),
-    token(TOKEN_SYMBOL,  loc(1, 48), loc(1, 48), "}"),
-    token(TOKEN_EOF,     loc(1, 49), loc(1, 49), "")
+    keyword(KEYWORD_FUNC,    loc(1,  1), loc(1,  4), "func"),
+    token(TOKEN_NAME,        loc(1,  6), loc(1,  6), "f"),
+    symbol(SYMBOL_COLON,     loc(1,  8), loc(1,  8), ":"),
+    symbol(SYMBOL_LPAREN,    loc(1, 10), loc(1, 10), "("),
+    token(TOKEN_NAME,        loc(1, 11), loc(1, 11), "a"),
+    symbol(SYMBOL_COLON,     loc(1, 12), loc(1, 12), ":"),
+    token(TOKEN_NAME,        loc(1, 14), loc(1, 16), "int"),
+    symbol(SYMBOL_COMMA,     loc(1, 17), loc(1, 17), ","),
+    token(TOKEN_NAME,        loc(1, 19), loc(1, 19), "b"),
+    symbol(SYMBOL_COLON,     loc(1, 20), loc(1, 20), ":"),
+    token(TOKEN_NAME,        loc(1, 22), loc(1, 24), "int"),
+    symbol(SYMBOL_RPAREN,    loc(1, 25), loc(1, 25), ")"),
+    symbol(SYMBOL_ARROW,     loc(1, 27), loc(1, 28), "->"),
+    token(TOKEN_NAME,        loc(1, 30), loc(1, 32), "int"),
+    symbol(SYMBOL_LBRACE,    loc(1, 34), loc(1, 34), "{"),
+    keyword(KEYWORD_RETURN,  loc(1, 36), loc(1, 41), "return"),
+    token(TOKEN_NAME,        loc(1, 43), loc(1, 43), "a"),
+    symbol(SYMBOL_PLUS,      loc(1, 44), loc(1, 44), "+"),
+    token(TOKEN_NAME,        loc(1, 45), loc(1, 45), "b"),
+    symbol(SYMBOL_SEMICOLON, loc(1, 46), loc(1, 46), ";"),
+    symbol(SYMBOL_RBRACE,    loc(1, 48), loc(1, 48), "}"),
+    token(TOKEN_EOF,         loc(1, 49), loc(1, 49), "")
   );
 
   in = "struct Vec2 : {\\n x: int; y: int;\\n }";
   createTest(suite, in, 14,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  6), "struct"),
-    token(TOKEN_NAME,    loc(1,  8), loc(1, 11), "Vec2"),
-    token(TOKEN_SYMBOL,  loc(1, 13), loc(1, 13), ":"),
-    token(TOKEN_SYMBOL,  loc(1, 15), loc(1, 15), "{"),
-    token(TOKEN_NAME,    loc(2,  2), loc(2,  2), "x"),
-    token(TOKEN_SYMBOL,  loc(2,  3), loc(2,  3), ":"),
-    token(TOKEN_NAME,    loc(2,  5), loc(2,  7), "int"),
-    token(TOKEN_SYMBOL,  loc(2,  8), loc(2,  8), ";"),
-    token(TOKEN_NAME,    loc(2, 10), loc(2, 10), "y"),
-    token(TOKEN_SYMBOL,  loc(2, 11), loc(2, 11), ":"),
-    token(TOKEN_NAME,    loc(2, 13), loc(2, 15), "int"),
-    token(TOKEN_SYMBOL,  loc(2, 16), loc(2, 16), ";"),
-    token(TOKEN_SYMBOL,  loc(3,  2), loc(3,  2), "}"),
-    token(TOKEN_EOF,     loc(3,  3), loc(3,  3), "")
+    keyword(KEYWORD_STRUCT,  loc(1,  1), loc(1,  6), "struct"),
+    token(TOKEN_NAME,        loc(1,  8), loc(1, 11), "Vec2"),
+    symbol(SYMBOL_COLON,     loc(1, 13), loc(1, 13), ":"),
+    symbol(SYMBOL_LBRACE,    loc(1, 15), loc(1, 15), "{"),
+    token(TOKEN_NAME,        loc(2,  2), loc(2,  2), "x"),
+    symbol(SYMBOL_COLON,     loc(2,  3), loc(2,  3), ":"),
+    token(TOKEN_NAME,        loc(2,  5), loc(2,  7), "int"),
+    symbol(SYMBOL_SEMICOLON, loc(2,  8), loc(2,  8), ";"),
+    token(TOKEN_NAME,        loc(2, 10), loc(2, 10), "y"),
+    symbol(SYMBOL_COLON,     loc(2, 11), loc(2, 11), ":"),
+    token(TOKEN_NAME,        loc(2, 13), loc(2, 15), "int"),
+    symbol(SYMBOL_SEMICOLON, loc(2, 16), loc(2, 16), ";"),
+    symbol(SYMBOL_RBRACE,    loc(3,  2), loc(3,  2), "}"),
+    token(TOKEN_EOF,         loc(3,  3), loc(3,  3), "")
   );
 
   in = "var v: int[] = [1, 2];";
   createTest(suite, in, 14,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  3), "var"),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  5), "v"),
-    token(TOKEN_SYMBOL,  loc(1,  6), loc(1,  6), ":"),
-    token(TOKEN_NAME,    loc(1,  8), loc(1, 10), "int"),
-    token(TOKEN_SYMBOL,  loc(1, 11), loc(1, 11), "["),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), "]"),
-    token(TOKEN_SYMBOL,  loc(1, 14), loc(1, 14), "="),
-    token(TOKEN_SYMBOL,  loc(1, 16), loc(1, 16), "["),
-    token(TOKEN_INT,     loc(1, 17), loc(1, 17), "1"),
-    token(TOKEN_SYMBOL,  loc(1, 18), loc(1, 18), ","),
-    token(TOKEN_INT,     loc(1, 20), loc(1, 20), "2"),
-    token(TOKEN_SYMBOL,  loc(1, 21), loc(1, 21), "]"),
-    token(TOKEN_SYMBOL,  loc(1, 22), loc(1, 22), ";"),
-    token(TOKEN_EOF,     loc(1, 23), loc(1, 23), "")
+    keyword(KEYWORD_VAR,     loc(1,  1), loc(1,  3), "var"),
+    token(TOKEN_NAME,        loc(1,  5), loc(1,  5), "v"),
+    symbol(SYMBOL_COLON,     loc(1,  6), loc(1,  6), ":"),
+    token(TOKEN_NAME,        loc(1,  8), loc(1, 10), "int"),
+    symbol(SYMBOL_LBRACKET,  loc(1, 11), loc(1, 11), "["),
+    symbol(SYMBOL_RBRACKET,  loc(1, 12), loc(1, 12), "]"),
+    symbol(SYMBOL_ASSIGN,    loc(1, 14), loc(1, 14), "="),
+    symbol(SYMBOL_LBRACKET,  loc(1, 16), loc(1, 16), "["),
+    token(TOKEN_INT,         loc(1, 17), loc(1, 17), "1"),
+    symbol(SYMBOL_COMMA,     loc(1, 18), loc(1, 18), ","),
+    token(TOKEN_INT,         loc(1, 20), loc(1, 20), "2"),
+    symbol(SYMBOL_RBRACKET,  loc(1, 21), loc(1, 21), "]"),
+    symbol(SYMBOL_SEMICOLON, loc(1, 22), loc(1, 22), ";"),
+    token(TOKEN_EOF,         loc(1, 23), loc(1, 23), "")
   );
 }
 
@@ -962,57 +1738,57 @@ static void addTestsExpressions(TestSuite* suite) {
 
   in = "(x + y) / 2";
   createTest(suite, in, 8,
-    token(TOKEN_SYMBOL,  loc(1,  1), loc(1,  1), "("),
-    token(TOKEN_NAME,    loc(1,  2), loc(1,  2), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  4), loc(1,  4), "+"),
-    token(TOKEN_NAME,    loc(1,  6), loc(1,  6), "y"),
-    token(TOKEN_SYMBOL,  loc(1,  7), loc(1,  7), ")"),
-    token(TOKEN_SYMBOL,  loc(1,  9), loc(1,  9), "/"),
-    token(TOKEN_INT,     loc(1, 11), loc(1, 11), "2"),
-    token(TOKEN_EOF,     loc(1, 12), loc(1, 12), "")
+    symbol(SYMBOL_LPAREN, loc(1,  1), loc(1,  1), "("),
+    token(TOKEN_NAME,     loc(1,  2), loc(1,  2), "x"),
+    symbol(SYMBOL_PLUS,   loc(1,  4), loc(1,  4), "+"),
+    token(TOKEN_NAME,     loc(1,  6), loc(1,  6), "y"),
+    symbol(SYMBOL_RPAREN, loc(1,  7), loc(1,  7), ")"),
+    symbol(SYMBOL_SLASH,  loc(1,  9), loc(1,  9), "/"),
+    token(TOKEN_INT,      loc(1, 11), loc(1, 11), "2"),
+    token(TOKEN_EOF,      loc(1, 12), loc(1, 12), "")
   );
 
   in = "((x+1) * (y-2)) / 2";
   createTest(suite, in, 16,
-    token(TOKEN_SYMBOL,  loc(1,  1), loc(1,  1), "("),
-    token(TOKEN_SYMBOL,  loc(1,  2), loc(1,  2), "("),
-    token(TOKEN_NAME,    loc(1,  3), loc(1,  3), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  4), loc(1,  4), "+"),
-    token(TOKEN_INT,     loc(1,  5), loc(1,  5), "1"),
-    token(TOKEN_SYMBOL,  loc(1,  6), loc(1,  6), ")"),
-    token(TOKEN_SYMBOL,  loc(1,  8), loc(1,  8), "*"),
-    token(TOKEN_SYMBOL,  loc(1, 10), loc(1, 10), "("),
-    token(TOKEN_NAME,    loc(1, 11), loc(1, 11), "y"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), "-"),
-    token(TOKEN_INT,     loc(1, 13), loc(1, 13), "2"),
-    token(TOKEN_SYMBOL,  loc(1, 14), loc(1, 14), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 15), loc(1, 15), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 17), loc(1, 17), "/"),
-    token(TOKEN_INT,     loc(1, 19), loc(1, 19), "2"),
-    token(TOKEN_EOF,     loc(1, 20), loc(1, 20), "")
+    symbol(SYMBOL_LPAREN, loc(1,  1), loc(1,  1), "("),
+    symbol(SYMBOL_LPAREN, loc(1,  2), loc(1,  2), "("),
+    token(TOKEN_NAME,     loc(1,  3), loc(1,  3), "x"),
+    symbol(SYMBOL_PLUS,   loc(1,  4), loc(1,  4), "+"),
+    token(TOKEN_INT,      loc(1,  5), loc(1,  5), "1"),
+    symbol(SYMBOL_RPAREN, loc(1,  6), loc(1,  6), ")"),
+    symbol(SYMBOL_STAR,   loc(1,  8), loc(1,  8), "*"),
+    symbol(SYMBOL_LPAREN, loc(1, 10), loc(1, 10), "("),
+    token(TOKEN_NAME,     loc(1, 11), loc(1, 11), "y"),
+    symbol(SYMBOL_MINUS,  loc(1, 12), loc(1, 12), "-"),
+    token(TOKEN_INT,      loc(1, 13), loc(1, 13), "2"),
+    symbol(SYMBOL_RPAREN, loc(1, 14), loc(1, 14), ")"),
+    symbol(SYMBOL_RPAREN, loc(1, 15), loc(1, 15), ")"),
+    symbol(SYMBOL_SLASH,  loc(1, 17), loc(1, 17), "/"),
+    token(TOKEN_INT,      loc(1, 19), loc(1, 19), "2"),
+    token(TOKEN_EOF,      loc(1, 20), loc(1, 20), "")
   );
 
   in = "x & ~0b0000_1000";
   createTest(suite, in, 4,
     token(TOKEN_NAME,    loc(1,  1), loc(1,  1), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  3), loc(1,  3), "&"),
-    token(TOKEN_SYMBOL,  loc(1,  5), loc(1,  5), "~"),
+    symbol(SYMBOL_AND,   loc(1,  3), loc(1,  3), "&"),
+    symbol(SYMBOL_TILDE, loc(1,  5), loc(1,  5), "~"),
     token(TOKEN_INT,     loc(1,  6), loc(1, 16), "0b0000_1000"),
     token(TOKEN_EOF,     loc(1, 17), loc(1, 17), "")
   );
 
   in = "x | 0b0000_1000";
   createTest(suite, in, 4,
-    token(TOKEN_NAME,    loc(1,  1), loc(1,  1), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  3), loc(1,  3), "|"),
-    token(TOKEN_INT,     loc(1,  5), loc(1, 15), "0b0000_1000"),
-    token(TOKEN_EOF,     loc(1, 16), loc(1, 16), "")
+    token(TOKEN_NAME, loc(1,  1), loc(1,  1), "x"),
+    symbol(SYMBOL_OR, loc(1,  3), loc(1,  3), "|"),
+    token(TOKEN_INT,  loc(1,  5), loc(1, 15), "0b0000_1000"),
+    token(TOKEN_EOF,  loc(1, 16), loc(1, 16), "")
   );
 
   in = "x ^ 0b0000_1000";
   createTest(suite, in, 4,
     token(TOKEN_NAME,    loc(1,  1), loc(1,  1), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  3), loc(1,  3), "^"),
+    symbol(SYMBOL_CARET, loc(1,  3), loc(1,  3), "^"),
     token(TOKEN_INT,     loc(1,  5), loc(1, 15), "0b0000_1000"),
     token(TOKEN_EOF,     loc(1, 16), loc(1, 16), "")
   );
@@ -1020,9 +1796,9 @@ static void addTestsExpressions(TestSuite* suite) {
   in = "x+-*p";
   createTest(suite, in, 6,
     token(TOKEN_NAME,    loc(1,  1), loc(1,  1), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  2), loc(1,  2), "+"),
-    token(TOKEN_SYMBOL,  loc(1,  3), loc(1,  3), "-"),
-    token(TOKEN_SYMBOL,  loc(1,  4), loc(1,  4), "*"),
+    symbol(SYMBOL_PLUS,  loc(1,  2), loc(1,  2), "+"),
+    symbol(SYMBOL_MINUS, loc(1,  3), loc(1,  3), "-"),
+    symbol(SYMBOL_STAR,  loc(1,  4), loc(1,  4), "*"),
     token(TOKEN_NAME,    loc(1,  5), loc(1,  5), "p"),
     token(TOKEN_EOF,     loc(1,  6), loc(1,  6), "")
   );
@@ -1034,141 +1810,141 @@ static void addTestsStatements(TestSuite* suite) {
 
   in = "if (x == 1) {\\n}";
   createTest(suite, in, 9,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  2), "if"),
-    token(TOKEN_SYMBOL,  loc(1,  4), loc(1,  4), "("),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  5), "x"),
-    token(TOKEN_SYMBOL,  loc(1,  7), loc(1,  8), "=="),
-    token(TOKEN_INT,     loc(1, 10), loc(1, 10), "1"),
-    token(TOKEN_SYMBOL,  loc(1, 11), loc(1, 11), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 13), loc(1, 13), "{"),
-    token(TOKEN_SYMBOL,  loc(2,  1), loc(2,  1), "}"),
-    token(TOKEN_EOF,     loc(2,  2), loc(2,  2), "")
+    keyword(KEYWORD_IF,   loc(1,  1), loc(1,  2), "if"),
+    symbol(SYMBOL_LPAREN, loc(1,  4), loc(1,  4), "("),
+    token(TOKEN_NAME,     loc(1,  5), loc(1,  5), "x"),
+    symbol(SYMBOL_EQUAL,  loc(1,  7), loc(1,  8), "=="),
+    token(TOKEN_INT,      loc(1, 10), loc(1, 10), "1"),
+    symbol(SYMBOL_RPAREN, loc(1, 11), loc(1, 11), ")"),
+    symbol(SYMBOL_LBRACE, loc(1, 13), loc(1, 13), "{"),
+    symbol(SYMBOL_RBRACE, loc(2,  1), loc(2,  1), "}"),
+    token(TOKEN_EOF,      loc(2,  2), loc(2,  2), "")
   );
 
   in = "if (y != 0) {\\n}";
   createTest(suite, in, 9,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  2), "if"),
-    token(TOKEN_SYMBOL,  loc(1,  4), loc(1,  4), "("),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  5), "y"),
-    token(TOKEN_SYMBOL,  loc(1,  7), loc(1,  8), "!="),
-    token(TOKEN_INT,     loc(1, 10), loc(1, 10), "0"),
-    token(TOKEN_SYMBOL,  loc(1, 11), loc(1, 11), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 13), loc(1, 13), "{"),
-    token(TOKEN_SYMBOL,  loc(2,  1), loc(2,  1), "}"),
-    token(TOKEN_EOF,     loc(2,  2), loc(2,  2), "")
+    keyword(KEYWORD_IF,      loc(1,  1), loc(1,  2), "if"),
+    symbol(SYMBOL_LPAREN,    loc(1,  4), loc(1,  4), "("),
+    token(TOKEN_NAME,        loc(1,  5), loc(1,  5), "y"),
+    symbol(SYMBOL_NOT_EQUAL, loc(1,  7), loc(1,  8), "!="),
+    token(TOKEN_INT,         loc(1, 10), loc(1, 10), "0"),
+    symbol(SYMBOL_RPAREN,    loc(1, 11), loc(1, 11), ")"),
+    symbol(SYMBOL_LBRACE,    loc(1, 13), loc(1, 13), "{"),
+    symbol(SYMBOL_RBRACE,    loc(2,  1), loc(2,  1), "}"),
+    token(TOKEN_EOF,         loc(2,  2), loc(2,  2), "")
   );
 
   in = "while (!finished) {\\n}";
   createTest(suite, in, 8,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  5), "while"),
-    token(TOKEN_SYMBOL,  loc(1,  7), loc(1,  7), "("),
-    token(TOKEN_SYMBOL,  loc(1,  8), loc(1,  8), "!"),
-    token(TOKEN_NAME,    loc(1,  9), loc(1, 16), "finished"),
-    token(TOKEN_SYMBOL,  loc(1, 17), loc(1, 17), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 19), loc(1, 19), "{"),
-    token(TOKEN_SYMBOL,  loc(2,  1), loc(2,  1), "}"),
-    token(TOKEN_EOF,     loc(2,  2), loc(2,  2), "")
+    keyword(KEYWORD_WHILE, loc(1,  1), loc(1,  5), "while"),
+    symbol(SYMBOL_LPAREN,  loc(1,  7), loc(1,  7), "("),
+    symbol(SYMBOL_NOT,     loc(1,  8), loc(1,  8), "!"),
+    token(TOKEN_NAME,      loc(1,  9), loc(1, 16), "finished"),
+    symbol(SYMBOL_RPAREN,  loc(1, 17), loc(1, 17), ")"),
+    symbol(SYMBOL_LBRACE,  loc(1, 19), loc(1, 19), "{"),
+    symbol(SYMBOL_RBRACE,  loc(2,  1), loc(2,  1), "}"),
+    token(TOKEN_EOF,       loc(2,  2), loc(2,  2), "")
   );
 
   in = "if (a && b || c) {\\n}";
   createTest(suite, in, 11,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  2), "if"),
-    token(TOKEN_SYMBOL,  loc(1,  4), loc(1,  4), "("),
-    token(TOKEN_NAME,    loc(1,  5), loc(1,  5), "a"),
-    token(TOKEN_SYMBOL,  loc(1,  7), loc(1,  8), "&&"),
-    token(TOKEN_NAME,    loc(1, 10), loc(1, 10), "b"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 13), "||"),
-    token(TOKEN_NAME,    loc(1, 15), loc(1, 15), "c"),
-    token(TOKEN_SYMBOL,  loc(1, 16), loc(1, 16), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 18), loc(1, 18), "{"),
-    token(TOKEN_SYMBOL,  loc(2,  1), loc(2,  1), "}"),
-    token(TOKEN_EOF,     loc(2,  2), loc(2,  2), "")
+    keyword(KEYWORD_IF,        loc(1,  1), loc(1,  2), "if"),
+    symbol(SYMBOL_LPAREN,      loc(1,  4), loc(1,  4), "("),
+    token(TOKEN_NAME,          loc(1,  5), loc(1,  5), "a"),
+    symbol(SYMBOL_LOGICAL_AND, loc(1,  7), loc(1,  8), "&&"),
+    token(TOKEN_NAME,          loc(1, 10), loc(1, 10), "b"),
+    symbol(SYMBOL_LOGICAL_OR,  loc(1, 12), loc(1, 13), "||"),
+    token(TOKEN_NAME,          loc(1, 15), loc(1, 15), "c"),
+    symbol(SYMBOL_RPAREN,      loc(1, 16), loc(1, 16), ")"),
+    symbol(SYMBOL_LBRACE,      loc(1, 18), loc(1, 18), "{"),
+    symbol(SYMBOL_RBRACE,      loc(2,  1), loc(2,  1), "}"),
+    token(TOKEN_EOF,           loc(2,  2), loc(2,  2), "")
   );
 
   in = "for (i := 0; i < 10; i++) {\\n continue; }";
   createTest(suite, in, 19,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  3), "for"),
-    token(TOKEN_SYMBOL,  loc(1,  5), loc(1,  5), "("),
-    token(TOKEN_NAME,    loc(1,  6), loc(1,  6), "i"),
-    token(TOKEN_SYMBOL,  loc(1,  8), loc(1,  8), ":"),
-    token(TOKEN_SYMBOL,  loc(1,  9), loc(1,  9), "="),
-    token(TOKEN_INT,     loc(1, 11), loc(1, 11), "0"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), ";"),
-    token(TOKEN_NAME,    loc(1, 14), loc(1, 14), "i"),
-    token(TOKEN_SYMBOL,  loc(1, 16), loc(1, 16), "<"),
-    token(TOKEN_INT,     loc(1, 18), loc(1, 19), "10"),
-    token(TOKEN_SYMBOL,  loc(1, 20), loc(1, 20), ";"),
-    token(TOKEN_NAME,    loc(1, 22), loc(1, 22), "i"),
-    token(TOKEN_SYMBOL,  loc(1, 23), loc(1, 23), "+"),
-    token(TOKEN_SYMBOL,  loc(1, 24), loc(1, 24), "+"),
-    token(TOKEN_SYMBOL,  loc(1, 25), loc(1, 25), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 27), loc(1, 27), "{"),
-    token(TOKEN_KEYWORD, loc(2,  2), loc(2,  9), "continue"),
-    token(TOKEN_SYMBOL,  loc(2, 10), loc(2, 10), ";"),
-    token(TOKEN_SYMBOL,  loc(2, 12), loc(2, 12), "}"),
-    token(TOKEN_EOF,     loc(2, 13), loc(2, 13), "")
+    keyword(KEYWORD_FOR,      loc(1,  1), loc(1,  3), "for"),
+    symbol(SYMBOL_LPAREN,     loc(1,  5), loc(1,  5), "("),
+    token(TOKEN_NAME,         loc(1,  6), loc(1,  6), "i"),
+    symbol(SYMBOL_COLON,      loc(1,  8), loc(1,  8), ":"),
+    symbol(SYMBOL_ASSIGN,     loc(1,  9), loc(1,  9), "="),
+    token(TOKEN_INT,          loc(1, 11), loc(1, 11), "0"),
+    symbol(SYMBOL_SEMICOLON,  loc(1, 12), loc(1, 12), ";"),
+    token(TOKEN_NAME,         loc(1, 14), loc(1, 14), "i"),
+    symbol(SYMBOL_LESS,       loc(1, 16), loc(1, 16), "<"),
+    token(TOKEN_INT,          loc(1, 18), loc(1, 19), "10"),
+    symbol(SYMBOL_SEMICOLON,  loc(1, 20), loc(1, 20), ";"),
+    token(TOKEN_NAME,         loc(1, 22), loc(1, 22), "i"),
+    symbol(SYMBOL_PLUS,       loc(1, 23), loc(1, 23), "+"),
+    symbol(SYMBOL_PLUS,       loc(1, 24), loc(1, 24), "+"),
+    symbol(SYMBOL_RPAREN,     loc(1, 25), loc(1, 25), ")"),
+    symbol(SYMBOL_LBRACE,     loc(1, 27), loc(1, 27), "{"),
+    keyword(KEYWORD_CONTINUE, loc(2,  2), loc(2,  9), "continue"),
+    symbol(SYMBOL_SEMICOLON,  loc(2, 10), loc(2, 10), ";"),
+    symbol(SYMBOL_RBRACE,     loc(2, 12), loc(2, 12), "}"),
+    token(TOKEN_EOF,          loc(2, 13), loc(2, 13), "")
   );
 
   in = "for (i := 9; i >= 0; i--) {\\n break; }";
   createTest(suite, in, 19,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  3), "for"),
-    token(TOKEN_SYMBOL,  loc(1,  5), loc(1,  5), "("),
-    token(TOKEN_NAME,    loc(1,  6), loc(1,  6), "i"),
-    token(TOKEN_SYMBOL,  loc(1,  8), loc(1,  8), ":"),
-    token(TOKEN_SYMBOL,  loc(1,  9), loc(1,  9), "="),
-    token(TOKEN_INT,     loc(1, 11), loc(1, 11), "9"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), ";"),
-    token(TOKEN_NAME,    loc(1, 14), loc(1, 14), "i"),
-    token(TOKEN_SYMBOL,  loc(1, 16), loc(1, 17), ">="),
-    token(TOKEN_INT,     loc(1, 19), loc(1, 19), "0"),
-    token(TOKEN_SYMBOL,  loc(1, 20), loc(1, 20), ";"),
-    token(TOKEN_NAME,    loc(1, 22), loc(1, 22), "i"),
-    token(TOKEN_SYMBOL,  loc(1, 23), loc(1, 23), "-"),
-    token(TOKEN_SYMBOL,  loc(1, 24), loc(1, 24), "-"),
-    token(TOKEN_SYMBOL,  loc(1, 25), loc(1, 25), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 27), loc(1, 27), "{"),
-    token(TOKEN_KEYWORD, loc(2,  2), loc(2,  6), "break"),
-    token(TOKEN_SYMBOL,  loc(2,  7), loc(2,  7), ";"),
-    token(TOKEN_SYMBOL,  loc(2,  9), loc(2,  9), "}"),
-    token(TOKEN_EOF,     loc(2, 10), loc(2, 10), "")
+    keyword(KEYWORD_FOR,         loc(1,  1), loc(1,  3), "for"),
+    symbol(SYMBOL_LPAREN,        loc(1,  5), loc(1,  5), "("),
+    token(TOKEN_NAME,            loc(1,  6), loc(1,  6), "i"),
+    symbol(SYMBOL_COLON,         loc(1,  8), loc(1,  8), ":"),
+    symbol(SYMBOL_ASSIGN,        loc(1,  9), loc(1,  9), "="),
+    token(TOKEN_INT,             loc(1, 11), loc(1, 11), "9"),
+    symbol(SYMBOL_SEMICOLON,     loc(1, 12), loc(1, 12), ";"),
+    token(TOKEN_NAME,            loc(1, 14), loc(1, 14), "i"),
+    symbol(SYMBOL_GREATER_EQUAL, loc(1, 16), loc(1, 17), ">="),
+    token(TOKEN_INT,             loc(1, 19), loc(1, 19), "0"),
+    symbol(SYMBOL_SEMICOLON,     loc(1, 20), loc(1, 20), ";"),
+    token(TOKEN_NAME,            loc(1, 22), loc(1, 22), "i"),
+    symbol(SYMBOL_MINUS,         loc(1, 23), loc(1, 23), "-"),
+    symbol(SYMBOL_MINUS,         loc(1, 24), loc(1, 24), "-"),
+    symbol(SYMBOL_RPAREN,        loc(1, 25), loc(1, 25), ")"),
+    symbol(SYMBOL_LBRACE,        loc(1, 27), loc(1, 27), "{"),
+    keyword(KEYWORD_BREAK,       loc(2,  2), loc(2,  6), "break"),
+    symbol(SYMBOL_SEMICOLON,     loc(2,  7), loc(2,  7), ";"),
+    symbol(SYMBOL_RBRACE,        loc(2,  9), loc(2,  9), "}"),
+    token(TOKEN_EOF,             loc(2, 10), loc(2, 10), "")
   );
 
   in = "do {\\n print(x);\\n } while (true);";
   createTest(suite, in, 14,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  2), "do"),
-    token(TOKEN_SYMBOL,  loc(1,  4), loc(1,  4), "{"),
-    token(TOKEN_NAME,    loc(2,  2), loc(2,  6), "print"),
-    token(TOKEN_SYMBOL,  loc(2,  7), loc(2,  7), "("),
-    token(TOKEN_NAME,    loc(2,  8), loc(2,  8), "x"),
-    token(TOKEN_SYMBOL,  loc(2,  9), loc(2,  9), ")"),
-    token(TOKEN_SYMBOL,  loc(2, 10), loc(2, 10), ";"),
-    token(TOKEN_SYMBOL,  loc(3,  2), loc(3,  2), "}"),
-    token(TOKEN_KEYWORD, loc(3,  4), loc(3,  8), "while"),
-    token(TOKEN_SYMBOL,  loc(3, 10), loc(3, 10), "("),
-    token(TOKEN_KEYWORD, loc(3, 11), loc(3, 14), "true"),
-    token(TOKEN_SYMBOL,  loc(3, 15), loc(3, 15), ")"),
-    token(TOKEN_SYMBOL,  loc(3, 16), loc(3, 16), ";"),
-    token(TOKEN_EOF,     loc(3, 17), loc(3, 17), "")
+    keyword(KEYWORD_DO,      loc(1,  1), loc(1,  2), "do"),
+    symbol(SYMBOL_LBRACE,    loc(1,  4), loc(1,  4), "{"),
+    token(TOKEN_NAME,        loc(2,  2), loc(2,  6), "print"),
+    symbol(SYMBOL_LPAREN,    loc(2,  7), loc(2,  7), "("),
+    token(TOKEN_NAME,        loc(2,  8), loc(2,  8), "x"),
+    symbol(SYMBOL_RPAREN,    loc(2,  9), loc(2,  9), ")"),
+    symbol(SYMBOL_SEMICOLON, loc(2, 10), loc(2, 10), ";"),
+    symbol(SYMBOL_RBRACE,    loc(3,  2), loc(3,  2), "}"),
+    keyword(KEYWORD_WHILE,   loc(3,  4), loc(3,  8), "while"),
+    symbol(SYMBOL_LPAREN,    loc(3, 10), loc(3, 10), "("),
+    keyword(KEYWORD_TRUE,    loc(3, 11), loc(3, 14), "true"),
+    symbol(SYMBOL_RPAREN,    loc(3, 15), loc(3, 15), ")"),
+    symbol(SYMBOL_SEMICOLON, loc(3, 16), loc(3, 16), ";"),
+    token(TOKEN_EOF,         loc(3, 17), loc(3, 17), "")
   );
 
   in = "switch (x) {\\n case 1 -> { }\\n else -> { }\\n }";
   createTest(suite, in, 16,
-    token(TOKEN_KEYWORD, loc(1,  1), loc(1,  6), "switch"),
-    token(TOKEN_SYMBOL,  loc(1,  8), loc(1,  8), "("),
-    token(TOKEN_NAME,    loc(1,  9), loc(1,  9), "x"),
-    token(TOKEN_SYMBOL,  loc(1, 10), loc(1, 10), ")"),
-    token(TOKEN_SYMBOL,  loc(1, 12), loc(1, 12), "{"),
-    token(TOKEN_KEYWORD, loc(2,  2), loc(2,  5), "case"),
-    token(TOKEN_INT,     loc(2,  7), loc(2,  7), "1"),
-    token(TOKEN_SYMBOL,  loc(2,  9), loc(2, 10), "->"),
-    token(TOKEN_SYMBOL,  loc(2, 12), loc(2, 12), "{"),
-    token(TOKEN_SYMBOL,  loc(2, 14), loc(2, 14), "}"),
-    token(TOKEN_KEYWORD, loc(3,  2), loc(3,  5), "else"),
-    token(TOKEN_SYMBOL,  loc(3,  7), loc(3,  8), "->"),
-    token(TOKEN_SYMBOL,  loc(3, 10), loc(3, 10), "{"),
-    token(TOKEN_SYMBOL,  loc(3, 12), loc(3, 12), "}"),
-    token(TOKEN_SYMBOL,  loc(4,  2), loc(4,  2), "}"),
-    token(TOKEN_EOF,     loc(4,  3), loc(4,  3), "")
+    keyword(KEYWORD_SWITCH, loc(1,  1), loc(1,  6), "switch"),
+    symbol(SYMBOL_LPAREN,   loc(1,  8), loc(1,  8), "("),
+    token(TOKEN_NAME,       loc(1,  9), loc(1,  9), "x"),
+    symbol(SYMBOL_RPAREN,   loc(1, 10), loc(1, 10), ")"),
+    symbol(SYMBOL_LBRACE,   loc(1, 12), loc(1, 12), "{"),
+    keyword(KEYWORD_CASE,   loc(2,  2), loc(2,  5), "case"),
+    token(TOKEN_INT,        loc(2,  7), loc(2,  7), "1"),
+    symbol(SYMBOL_ARROW,    loc(2,  9), loc(2, 10), "->"),
+    symbol(SYMBOL_LBRACE,   loc(2, 12), loc(2, 12), "{"),
+    symbol(SYMBOL_RBRACE,   loc(2, 14), loc(2, 14), "}"),
+    keyword(KEYWORD_ELSE,   loc(3,  2), loc(3,  5), "else"),
+    symbol(SYMBOL_ARROW,    loc(3,  7), loc(3,  8), "->"),
+    symbol(SYMBOL_LBRACE,   loc(3, 10), loc(3, 10), "{"),
+    symbol(SYMBOL_RBRACE,   loc(3, 12), loc(3, 12), "}"),
+    symbol(SYMBOL_RBRACE,   loc(4,  2), loc(4,  2), "}"),
+    token(TOKEN_EOF,        loc(4,  3), loc(4,  3), "")
   );
 }
 
@@ -1176,17 +1952,29 @@ static void addTestsStatements(TestSuite* suite) {
 TestResult lexer_alltests(PrintLevel verbosity) {
   TestSuite suite = newSuite("TestSuite<lexer>", "Test lexer.");
   addTest(&suite, testCreation);
+  addTest(&suite, testLongRuns);
+  addTest(&suite, testIntegerValues);
+  addTest(&suite, testFloatValues);
+  addTest(&suite, testLiteralValues);
+  addTest(&suite, testLongLiterals);
+  addTest(&suite, testErrorRecords);
+  addTest(&suite, testTrivia);
+  addTest(&suite, testLexLine);
   addTest(&suite, testErrorMsgs);
   addTestsEndOfLine(&suite);
   addTestsTokenName(&suite);
   addTestsTokenInt(&suite);
   addTestsTokenHexInt(&suite);
   addTestsTokenBinInt(&suite);
+  addTestsTokenFloat(&suite);
+  addTestsTokenString(&suite);
+  addTestsTokenChar(&suite);
   addTestsWhitespaces(&suite);
   addTestsTokenKeyword(&suite);
   addTestsTokenSeparator(&suite);
   addTestsTokenOperator(&suite);
   addTestsTokenComment(&suite);
+  addTestsIllegalCharacter(&suite);
   addTestsDeclarations(&suite);
   addTestsExpressions(&suite);
   addTestsStatements(&suite);
@@ -0,0 +1,82 @@
+#include "cunit.h"
+#include "util.h"
+
+#include "loader.h"
+
+#include <stdio.h>
+
+
+#define NUM_FILES 16
+
+
+typedef struct Loaded {
+  int    calls[NUM_FILES + 1];
+  Source sources[NUM_FILES + 1];
+} Loaded;
+
+
+static void collectSource(Source* source, size_t index, void* data) {
+  Loaded* loaded = (Loaded*) data;
+  loaded->calls[index]++;
+  loaded->sources[index] = *source;  // takes the ownership
+}
+
+
+static TestResult testLoadNothing() {
+  TestResult result = {};
+
+  {
+    Loaded loaded = {};
+    loadSources(NULL, 0, 4, collectSource, &loaded);
+    TEST(assertEqualInt(loaded.calls[0], 0));
+  }
+
+  return result;
+}
+
+
+static TestResult testLoadFiles() {
+  TestResult result = {};
+  const char* paths[NUM_FILES + 1];
+  char names[NUM_FILES][32];
+  for (int i = 0; i < NUM_FILES; i++) {
+    snprintf(names[i], sizeof(names[i]), "__loader_%d__.tmp", i);
+    char content[32];
+    snprintf(content, sizeof(content), "var x%d := %d;", i, i);
+    writeFile(names[i], content);
+    paths[i] = names[i];
+  }
+  paths[NUM_FILES] = ".__loader__.tmp";  // does not exist
+
+  for (int threads = 0; threads <= 3; threads++) {
+    Loaded loaded = {};
+    loadSources(paths, NUM_FILES + 1, threads, collectSource, &loaded);
+    for (int i = 0; i < NUM_FILES; i++) {
+      char content[32];
+      snprintf(content, sizeof(content), "var x%d := %d;", i, i);
+      TEST(assertEqualInt(loaded.calls[i], 1));
+      TEST(assertEqualInt(loaded.sources[i].status, SOURCE_OK));
+      TEST(assertEqualStr(loaded.sources[i].fileName, names[i]));
+      TEST(assertEqualStr(loaded.sources[i].content, content));
+      deleteSource(&loaded.sources[i]);
+    }
+    TEST(assertEqualInt(loaded.calls[NUM_FILES], 1));
+    TEST(assertEqualInt(loaded.sources[NUM_FILES].status, SOURCE_ERROR));
+    deleteSource(&loaded.sources[NUM_FILES]);
+  }
+
+  for (int i = 0; i < NUM_FILES; i++) {
+    deleteFile(names[i]);
+  }
+  return result;
+}
+
+
+TestResult loader_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<loader>", "Test batch loading of sources.");
+  addTest(&suite, testLoadNothing);
+  addTest(&suite, testLoadFiles);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
@@ -1,15 +1,585 @@
 #include "cunit.h"
+#include "util.h"
 
 #include "number.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+
+static Number num(const char* chars) {
+  return numFromString(stringFromArray(chars));
+}
+
+
+static Number numFromInt128(__int128 value) {
+  Number high = shiftLeft(numFromInt64((int64_t) (value >> 64)), 64);
+  return add(high, numFromUInt64((uint64_t) value));
+}
+
+
+static int bitSize128(__int128 value) {
+  unsigned __int128 bits = (value < 0) ? ~value : value;
+  int size = 0;
+  for (; bits != 0; bits >>= 1) {
+    size++;
+  }
+  return size;
+}
+
 
 static TestResult testCreation() {
   TestResult result = {};
 
   {
-    FAIL("not implemented yet");
+    Number n = numFromInt(42);
+    TEST(assertEqualInt(n.size, 0));
+    TEST(assertFalse(n.negative));
+    TEST(assertTrue(n.value == 42));
+  }
+
+  {
+    Number n = numFromInt(-5);
+    TEST(assertEqualInt(n.size, 0));
+    TEST(assertTrue(n.negative));
+    TEST(assertTrue(n.value == (uint64_t) -5));
+  }
+
+  {
+    Number n = numFromInt64(INT64_MIN);
+    TEST(assertTrue(n.negative));
+    TEST(assertTrue(n.value == 0x8000000000000000));
+    n = numFromUInt64(UINT64_MAX);
+    TEST(assertEqualInt(n.size, 0));
+    TEST(assertFalse(n.negative));
+    TEST(assertTrue(n.value == UINT64_MAX));
+    deleteNum(&n);
+    TEST(assertEqualNumber(n, numFromInt(0)));
+  }
+
+  return result;
+}
+
+
+static TestResult testFromString() {
+  TestResult result = {};
+
+  TEST(assertTrue(numFromString(stringFromArray("0")).value == 0));
+  TEST(assertTrue(numFromString(stringFromArray("1_000")).value == 1000));
+  TEST(assertTrue(numFromString(stringFromArray("0x_FF_ff")).value == 0xFFFF));
+  TEST(assertTrue(numFromString(stringFromArray("0B1010")).value == 10));
+  TEST(assertTrue(numFromString(stringFromArray("18446744073709551615")).value == UINT64_MAX));
+  TEST(assertTrue(numFromString(stringFromRange("123", "123" + 2)).value == 12));
+
+  Number n = num("18446744073709551616");
+  TEST(assertEqualInt(n.size, 2));
+  TEST(assertEqualNumber(n, add(numFromUInt64(UINT64_MAX), numFromInt(1))));
+  TEST(assertEqualNumber(num("0x1_0000_0000_0000_0000_0000_0000_0000_0000"),
+                         shiftLeft(numFromInt(1), 128)));
+  char bin[3 + 128 + 1] = "0b1";
+  memset(&bin[3], '0', 128);
+  bin[3 + 128] = '\0';
+  TEST(assertEqualNumber(num(bin), shiftLeft(numFromInt(1), 128)));
+  TEST(assertEqualNumber(num("340282366920938463463374607431768211455"),  // 2^128 - 1
+                         sub(shiftLeft(numFromInt(1), 128), numFromInt(1))));
+  TEST(assertEqualNumber(num("000000000000000000000000000000000000000042"), numFromInt(42)));
+
+  numFree();
+  return result;
+}
+
+
+static TestResult testBitSize() {
+  TestResult result = {};
+
+  TEST(assertEqualInt(bitSize(numFromInt(0)), 0));
+  TEST(assertEqualInt(bitSize(numFromInt(-1)), 0));
+  TEST(assertEqualInt(bitSize(numFromInt(1)), 1));
+  TEST(assertEqualInt(bitSize(numFromInt(-2)), 1));
+  TEST(assertEqualInt(bitSize(numFromInt(127)), 7));
+  TEST(assertEqualInt(bitSize(numFromInt(-128)), 7));
+  TEST(assertEqualInt(bitSize(numFromInt(255)), 8));
+  TEST(assertEqualInt(bitSize(numFromInt(-256)), 8));
+  TEST(assertEqualInt(bitSize(numFromInt64(INT64_MIN)), 63));
+  TEST(assertEqualInt(bitSize(numFromUInt64(UINT64_MAX)), 64));
+  TEST(assertEqualInt(bitSize(neg(numFromUInt64(UINT64_MAX))), 64));
+  TEST(assertEqualInt(bitSize(shiftLeft(numFromInt(1), 64)), 65));
+  TEST(assertEqualInt(bitSize(neg(shiftLeft(numFromInt(1), 64))), 64));  // still inline
+  TEST(assertEqualInt(bitSize(shiftLeft(numFromInt(1), 127)), 128));
+  TEST(assertEqualInt(bitSize(shiftLeft(numFromInt(-1), 1000)), 1000));
+
+  numFree();
+  return result;
+}
+
+
+static TestResult testInlineBounds() {
+  TestResult result = {};
+
+  Number max = numFromUInt64(UINT64_MAX);                      // 2^64 - 1
+  Number min = sub(numFromInt(0), shiftLeft(numFromInt(1), 64));  // -2^64
+
+  TEST(assertEqualInt(min.size, 0));
+  TEST(assertTrue(min.negative));
+  TEST(assertTrue(min.value == 0));
+
+  Number n = add(max, numFromInt(1));
+  TEST(assertEqualInt(n.size, 2));
+  TEST(assertFalse(n.negative));
+  TEST(assertEqualNumber(sub(n, numFromInt(1)), max));
+  TEST(assertEqualInt(sub(n, numFromInt(1)).size, 0));
+
+  n = sub(min, numFromInt(1));
+  TEST(assertEqualInt(n.size, 2));
+  TEST(assertTrue(n.negative));
+  TEST(assertEqualNumber(add(n, numFromInt(1)), min));
+
+  TEST(assertEqualInt(neg(min).size, 2));
+  TEST(assertEqualNumber(neg(neg(min)), min));
+  TEST(assertEqualNumber(add(max, min), numFromInt(-1)));
+  TEST(assertEqualNumber(sub(max, max), numFromInt(0)));
+  TEST(assertEqualNumber(add(numFromInt(-3), numFromInt(5)), numFromInt(2)));
+  TEST(assertEqualNumber(sub(numFromInt(3), numFromInt(5)), numFromInt(-2)));
+  TEST(assertEqualNumber(neg(numFromInt(7)), numFromInt(-7)));
+
+  TEST(assertTrue(compare(min, max) < 0));
+  TEST(assertTrue(compare(numFromInt(-1), numFromInt(0)) < 0));
+  TEST(assertTrue(compare(add(max, max), max) > 0));
+  TEST(assertTrue(compare(sub(min, max), min) < 0));
+  TEST(assertEqualInt(compare(add(max, max), add(max, max)), 0));
+
+  numFree();
+  return result;
+}
+
+
+static TestResult testMul() {
+  TestResult result = {};
+
+  TEST(assertEqualNumber(mul(numFromInt(-6), numFromInt(7)), numFromInt(-42)));
+  TEST(assertEqualNumber(mul(numFromInt(0), num("123456789012345678901234567890")),
+                         numFromInt(0)));
+  TEST(assertEqualNumber(mul(numFromUInt64(UINT64_MAX), numFromInt(1)),
+                         numFromUInt64(UINT64_MAX)));
+  TEST(assertEqualNumber(mul(numFromInt64(INT64_MIN), numFromInt(-1)),
+                         numFromUInt64(0x8000000000000000)));
+  TEST(assertEqualNumber(mul(numFromUInt64(UINT64_MAX), numFromUInt64(UINT64_MAX)),
+                         num("340282366920938463426481119284349108225")));
+  TEST(assertEqualNumber(mul(num("123456789012345678901234567890"),
+                             neg(num("987654321098765432109876543210"))),
+                         neg(num("121932631137021795226185032733622923332237463801111263526900"))));
+
+  Number n = numFromInt(1);
+  for (int i = 0; i < 64; i++) {
+    n = mul(n, numFromInt(-10));
+  }
+  TEST(assertEqualNumber(n, num("1" "0000000000" "0000000000" "0000000000" "0000000000"
+                                    "0000000000" "0000000000" "0000")));
+
+  numFree();
+  return result;
+}
+
+
+static TestResult testShift() {
+  TestResult result = {};
+
+  TEST(assertEqualNumber(shiftLeft(numFromInt(3), 4), numFromInt(48)));
+  TEST(assertEqualNumber(shiftLeft(numFromInt(-3), 4), numFromInt(-48)));
+  TEST(assertEqualNumber(shiftLeft(numFromInt(1), 63), numFromUInt64(0x8000000000000000)));
+  TEST(assertEqualNumber(shiftLeft(numFromInt(-1), 64), neg(num("18446744073709551616"))));
+  TEST(assertEqualNumber(shiftLeft(numFromInt(5), 0), numFromInt(5)));
+
+  TEST(assertEqualNumber(shiftRight(numFromInt(48), 4), numFromInt(3)));
+  TEST(assertEqualNumber(shiftRight(numFromInt(-7), 1), numFromInt(-4)));  // towards -infinity
+  TEST(assertEqualNumber(shiftRight(numFromInt(-7), 100), numFromInt(-1)));
+  TEST(assertEqualNumber(shiftRight(numFromInt(7), 64), numFromInt(0)));
+  TEST(assertEqualNumber(shiftRight(numFromUInt64(UINT64_MAX), 63), numFromInt(1)));
+  TEST(assertEqualNumber(shiftRight(shiftLeft(numFromInt(-1), 64), 64), numFromInt(-1)));
+
+  Number big = num("0x1234_5678_9ABC_DEF0_1122_3344_5566_7788_99AA_BBCC_DDEE_FF00");
+  TEST(assertEqualNumber(shiftRight(big, 128), num("0x1234_5678_9ABC_DEF0")));
+  TEST(assertEqualNumber(shiftRight(big, 124), num("0x1234_5678_9ABC_DEF0_1")));
+  TEST(assertEqualNumber(shiftRight(shiftLeft(big, 77), 77), big));
+  TEST(assertEqualNumber(shiftRight(big, 1000), numFromInt(0)));
+  TEST(assertEqualNumber(shiftRight(neg(big), 1000), numFromInt(-1)));
+
+  numFree();
+  return result;
+}
+
+
+/**
+ * Cross-checks the operations with the compiler's 128 bit integers. The operands have up to 63
+ * bits, thus the products and left shifts fit as well.
+ */
+static TestResult testRandomOperations() {
+  TestResult result = {};
+
+  uint64_t state = 0x2545F4914F6CDD1Dull;
+  int mismatches = 0;
+  for (int i = 0; i < 20000; i++) {
+    __int128 values[2];
+    for (int k = 0; k < 2; k++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      int bits = (int) (state % 63);
+      values[k] = (__int128) (int64_t) state >> (63 - bits);
+    }
+    __int128 x = values[0];
+    __int128 y = values[1] * ((__int128) 1 << (state % 64));
+    Number a = numFromInt128(x);
+    Number b = numFromInt128(y);
+    unsigned int s = (unsigned int) (state % 70);
+
+    mismatches += compare(add(a, b), numFromInt128(x + y)) != 0;
+    mismatches += compare(sub(a, b), numFromInt128(x - y)) != 0;
+    mismatches += compare(neg(b), numFromInt128(-y)) != 0;
+    mismatches += compare(mul(a, numFromInt128(values[1])), numFromInt128(x * values[1])) != 0;
+    mismatches += compare(shiftLeft(a, s % 64), numFromInt128(x * ((__int128) 1 << s % 64))) != 0;
+    mismatches += compare(shiftRight(b, s), numFromInt128(y >> s)) != 0;
+    if (values[1] != 0) {
+      mismatches += compare(divide(b, numFromInt128(values[1])), numFromInt128(y / values[1])) != 0;
+      mismatches += compare(modulo(a, numFromInt128(values[1])), numFromInt128(x % values[1])) != 0;
+      mismatches += compare(divide(a, b), numFromInt128(x / y)) != 0;
+    }
+    if (x != 0) {
+      mismatches += compare(modulo(b, a), numFromInt128(y % x)) != 0;
+    }
+    mismatches += compare(a, b) != (x > y) - (x < y);
+    mismatches += bitSize(b) != bitSize128(y);
+  }
+  TEST(assertEqualInt(mismatches, 0));
+
+  numFree();
+  return result;
+}
+
+
+static TestResult testDivide() {
+  TestResult result = {};
+
+  Number two64 = shiftLeft(numFromInt(1), 64);
+
+  TEST(assertEqualNumber(divide(numFromInt(7), numFromInt(2)), numFromInt(3)));
+  TEST(assertEqualNumber(modulo(numFromInt(7), numFromInt(2)), numFromInt(1)));
+  TEST(assertEqualNumber(divide(numFromInt(-7), numFromInt(2)), numFromInt(-3)));
+  TEST(assertEqualNumber(modulo(numFromInt(-7), numFromInt(2)), numFromInt(-1)));
+  TEST(assertEqualNumber(divide(numFromInt(7), numFromInt(-2)), numFromInt(-3)));
+  TEST(assertEqualNumber(modulo(numFromInt(7), numFromInt(-2)), numFromInt(1)));
+  TEST(assertEqualNumber(divide(numFromInt64(INT64_MIN), numFromInt(-1)),
+                         shiftLeft(numFromInt(1), 63)));
+  TEST(assertEqualNumber(divide(numFromUInt64(UINT64_MAX), numFromInt(-1)),
+                         neg(numFromUInt64(UINT64_MAX))));
+  TEST(assertEqualNumber(divide(mul(two64, two64), two64), two64));
+  TEST(assertEqualNumber(modulo(add(mul(two64, two64), numFromInt(5)), two64), numFromInt(5)));
+  TEST(assertEqualNumber(divide(numFromInt(5), mul(two64, two64)), numFromInt(0)));
+  TEST(assertEqualNumber(modulo(numFromInt(-5), two64), numFromInt(-5)));
+  TEST(assertEqualNumber(divide(num("1000000000000000000000000000000"), num("1000000000000")),
+                         num("1000000000000000000")));
+
+  // a == b * q + r with |r| < |b| and r having the sign of a for many limbs
+  uint64_t state = 0x853C49E6748FEA9Bull;
+  int mismatches = 0;
+  for (int i = 0; i < 500; i++) {
+    Number n[2];
+    for (int k = 0; k < 2; k++) {
+      n[k] = numFromInt(1);
+      for (int j = (i + 7 * k) % 9; j >= 0; j--) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        n[k] = add(mul(n[k], numFromUInt64(state)), numFromInt((int) (state >> 48)));
+      }
+    }
+    Number a = (i % 2 == 0) ? n[0] : neg(n[0]);
+    Number b = (i % 3 == 0) ? n[1] : neg(n[1]);
+    Number q = divide(a, b);
+    Number r = modulo(a, b);
+    Number absR = r.negative ? neg(r) : r;
+    Number absB = b.negative ? neg(b) : b;
+    mismatches += compare(add(mul(b, q), r), a) != 0;
+    mismatches += compare(absR, absB) >= 0;
+    mismatches += r.negative && !a.negative;
+  }
+  TEST(assertEqualInt(mismatches, 0));
+
+  numFree();
+  return result;
+}
+
+
+static TestResult testFixedWidth() {
+  TestResult result = {};
+
+  NumType i1 = { .bits=1, .isSigned=true };
+  NumType i128 = { .bits=128, .isSigned=true };
+  NumType u128 = { .bits=128, .isSigned=false };
+  Number two64 = shiftLeft(numFromInt(1), 64);
+  bool overflow = false;
+
+  TEST(assertTrue(fitsType(numFromInt(127), NUM_I8)));
+  TEST(assertFalse(fitsType(numFromInt(128), NUM_I8)));
+  TEST(assertTrue(fitsType(numFromInt(-128), NUM_I8)));
+  TEST(assertTrue(fitsType(numFromInt(255), NUM_U8)));
+  TEST(assertFalse(fitsType(numFromInt(-1), NUM_U8)));
+  TEST(assertFalse(fitsType(two64, NUM_U64)));
+  TEST(assertTrue(fitsType(two64, i128)));
+
+  TEST(assertEqualNumber(minOfType(NUM_I8), numFromInt(-128)));
+  TEST(assertEqualNumber(maxOfType(NUM_I8), numFromInt(127)));
+  TEST(assertEqualNumber(minOfType(NUM_U16), numFromInt(0)));
+  TEST(assertEqualNumber(maxOfType(NUM_U16), numFromInt(65535)));
+  TEST(assertEqualNumber(minOfType(NUM_I64), numFromInt64(INT64_MIN)));
+  TEST(assertEqualNumber(maxOfType(NUM_U64), numFromUInt64(UINT64_MAX)));
+  TEST(assertEqualNumber(minOfType(i1), numFromInt(-1)));
+  TEST(assertEqualNumber(maxOfType(i1), numFromInt(0)));
+  TEST(assertEqualNumber(minOfType(i128), neg(shiftLeft(numFromInt(1), 127))));
+  TEST(assertEqualNumber(maxOfType(u128), sub(mul(two64, two64), numFromInt(1))));
+
+  TEST(assertEqualNumber(toFixed(numFromInt(100), NUM_I8, OVERFLOW_WRAP, &overflow),
+                         numFromInt(100)));
+  TEST(assertFalse(overflow));
+  TEST(assertEqualNumber(toFixed(numFromInt(300), NUM_U8, OVERFLOW_WRAP, &overflow),
+                         numFromInt(44)));
+  TEST(assertTrue(overflow));
+  TEST(assertEqualNumber(toFixed(numFromInt(200), NUM_I8, OVERFLOW_WRAP, NULL), numFromInt(-56)));
+  TEST(assertEqualNumber(toFixed(numFromInt(-1), NUM_U8, OVERFLOW_WRAP, NULL), numFromInt(255)));
+  TEST(assertEqualNumber(toFixed(neg(two64), NUM_I64, OVERFLOW_WRAP, NULL), numFromInt(0)));
+  TEST(assertEqualNumber(toFixed(numFromInt(-1), u128, OVERFLOW_WRAP, NULL), maxOfType(u128)));
+  TEST(assertEqualNumber(toFixed(numFromInt(300), NUM_U8, OVERFLOW_SATURATE, NULL),
+                         numFromInt(255)));
+  TEST(assertEqualNumber(toFixed(numFromInt(-5), NUM_U8, OVERFLOW_SATURATE, NULL), numFromInt(0)));
+  TEST(assertEqualNumber(toFixed(numFromInt(-200), NUM_I8, OVERFLOW_SATURATE, NULL),
+                         numFromInt(-128)));
+  TEST(assertEqualNumber(toFixed(numFromInt(300), NUM_U8, OVERFLOW_TRAP, &overflow),
+                         numFromInt(300)));
+  TEST(assertTrue(overflow));
+
+  TEST(assertEqualNumber(addFixed(numFromInt(127), numFromInt(1), NUM_I8, OVERFLOW_WRAP,
+                                  &overflow), numFromInt(-128)));
+  TEST(assertTrue(overflow));
+  TEST(assertEqualNumber(addFixed(numFromInt(127), numFromInt(1), NUM_I8, OVERFLOW_SATURATE,
+                                  NULL), numFromInt(127)));
+  TEST(assertEqualNumber(addFixed(numFromInt(127), numFromInt(1), NUM_I8, OVERFLOW_TRAP, NULL),
+                         numFromInt(128)));
+  TEST(assertEqualNumber(addFixed(numFromInt(100), numFromInt(27), NUM_I8, OVERFLOW_TRAP,
+                                  &overflow), numFromInt(127)));
+  TEST(assertFalse(overflow));
+  TEST(assertEqualNumber(subFixed(numFromInt(0), numFromInt(1), NUM_U32, OVERFLOW_WRAP, NULL),
+                         numFromUInt64(UINT32_MAX)));
+  TEST(assertEqualNumber(negFixed(numFromInt(-128), NUM_I8, OVERFLOW_WRAP, &overflow),
+                         numFromInt(-128)));
+  TEST(assertTrue(overflow));
+  TEST(assertEqualNumber(negFixed(numFromInt64(INT64_MIN), NUM_I64, OVERFLOW_SATURATE, NULL),
+                         numFromInt64(INT64_MAX)));
+  TEST(assertEqualNumber(mulFixed(numFromUInt64(UINT64_MAX), numFromInt(2), NUM_U64,
+                                  OVERFLOW_WRAP, NULL), numFromUInt64(UINT64_MAX - 1)));
+  TEST(assertEqualNumber(mulFixed(numFromInt64(INT64_MAX), numFromInt(2), NUM_I64,
+                                  OVERFLOW_SATURATE, NULL), numFromInt64(INT64_MAX)));
+  TEST(assertEqualNumber(mulFixed(numFromInt64(INT64_MAX), numFromInt(-2), NUM_I64,
+                                  OVERFLOW_SATURATE, NULL), numFromInt64(INT64_MIN)));
+  TEST(assertEqualNumber(mulFixed(numFromUInt64(UINT64_MAX), numFromInt(2), NUM_U64,
+                                  OVERFLOW_TRAP, NULL), sub(shiftLeft(two64, 1), numFromInt(2))));
+  TEST(assertEqualNumber(addFixed(maxOfType(u128), numFromInt(1), u128, OVERFLOW_WRAP,
+                                  &overflow), numFromInt(0)));
+  TEST(assertTrue(overflow));
+
+  TEST(assertEqualNumber(shiftLeftFixed(numFromInt(1), 7, NUM_I8, OVERFLOW_WRAP, &overflow),
+                         numFromInt(-128)));
+  TEST(assertTrue(overflow));
+  TEST(assertEqualNumber(shiftLeftFixed(numFromInt(1), 7, NUM_U8, OVERFLOW_WRAP, &overflow),
+                         numFromInt(128)));
+  TEST(assertFalse(overflow));
+  TEST(assertEqualNumber(shiftLeftFixed(numFromInt(1), 8, NUM_U8, OVERFLOW_WRAP, &overflow),
+                         numFromInt(0)));
+  TEST(assertTrue(overflow));
+  TEST(assertEqualNumber(shiftLeftFixed(numFromInt(0), 1000, NUM_U8, OVERFLOW_SATURATE,
+                                        &overflow), numFromInt(0)));
+  TEST(assertFalse(overflow));
+  TEST(assertEqualNumber(shiftLeftFixed(numFromInt(-1), 200, NUM_I8, OVERFLOW_SATURATE, NULL),
+                         numFromInt(-128)));
+  TEST(assertEqualNumber(shiftLeftFixed(numFromInt(3), 126, i128, OVERFLOW_WRAP, NULL),
+                         neg(shiftLeft(numFromInt(1), 126))));
+  TEST(assertEqualNumber(shiftLeftFixed(numFromInt(3), 63, NUM_U64, OVERFLOW_TRAP, NULL),
+                         shiftLeft(numFromInt(3), 63)));
+
+  numFree();
+  return result;
+}
+
+
+/**
+ * The native operations of narrow types must give the same results as the exact operations,
+ * whose results are then converted to the type.
+ */
+static TestResult testRandomFixedWidth() {
+  TestResult result = {};
+
+  const unsigned int widths[] = { 1, 7, 8, 16, 31, 32, 63, 64 };
+  uint64_t state = 0xD1B54A32D192ED03ull;
+  int mismatches = 0;
+  for (int i = 0; i < 20000; i++) {
+    NumType type = { .bits=widths[i % 8], .isSigned=(i / 8) % 2 == 0 };
+    Overflow mode = (Overflow) ((i / 16) % 3);
+    Number operands[2];
+    for (int k = 0; k < 2; k++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      Number value = numFromInt64((int64_t) state >> (state % 64));
+      operands[k] = toFixed(value, type, OVERFLOW_WRAP, NULL);
+    }
+    Number a = operands[0];
+    Number b = operands[1];
+    unsigned int s = (unsigned int) (state % 70);
+
+    bool overflow = false;
+    bool expOverflow = false;
+    Number exp = toFixed(add(a, b), type, mode, &expOverflow);
+    mismatches += compare(addFixed(a, b, type, mode, &overflow), exp) != 0;
+    mismatches += overflow != expOverflow;
+    exp = toFixed(sub(a, b), type, mode, &expOverflow);
+    mismatches += compare(subFixed(a, b, type, mode, &overflow), exp) != 0;
+    mismatches += overflow != expOverflow;
+    exp = toFixed(neg(a), type, mode, &expOverflow);
+    mismatches += compare(negFixed(a, type, mode, &overflow), exp) != 0;
+    mismatches += overflow != expOverflow;
+    exp = toFixed(mul(a, b), type, mode, &expOverflow);
+    mismatches += compare(mulFixed(a, b, type, mode, &overflow), exp) != 0;
+    mismatches += overflow != expOverflow;
+    exp = toFixed(shiftLeft(a, s), type, mode, &expOverflow);
+    mismatches += compare(shiftLeftFixed(a, s, type, mode, &overflow), exp) != 0;
+    mismatches += overflow != expOverflow;
+  }
+  TEST(assertEqualInt(mismatches, 0));
+
+  numFree();
+  return result;
+}
+
+
+/**
+ * Converts the number with each format and checks the length returned without a buffer.
+ */
+/**
+ * Gives `toDecString()` the signature of the other formats, its scratch is allocated here.
+ */
+static size_t toDecScratch(Number num, char* chars, size_t size, bool grouped) {
+  uint64_t* scratch = (uint64_t*) malloc(NUM_DEC_SCRATCH(num) * sizeof(uint64_t));
+  size_t length = toDecString(num, chars, size, grouped, scratch);
+  free(scratch);
+  return length;
+}
+
+
+#define assertEqualFormat(format, n, grouped, exp) \
+  __assertEqualFormat(__FILE__, __LINE__, format, #format, n, grouped, exp)
+static bool __assertEqualFormat(const char* file, int line,
+                                size_t (*format)(Number, char*, size_t, bool), const char* name,
+                                Number n, bool grouped, const char* exp) {
+  char chars[NUM_STRING_SIZE];
+  size_t length = format(n, chars, sizeof(chars), grouped);
+  if (length != format(n, NULL, 0, grouped)) {
+    printVerbose(__PROMPT, file, line);
+    printVerbose(RED "ERROR: " RST);
+    printVerbose("%s() returns another length without a buffer\n", name);
+    return false;
+  }
+  return __assertEqualStr(file, line, stringFromRange(chars, chars + length), exp);
+}
+
+
+static TestResult testToString() {
+  TestResult result = {};
+
+  Number big = add(numFromUInt64(UINT64_MAX), numFromInt(1));
+  Number min = neg(big);
+
+  TEST(assertEqualFormat(toDecScratch, numFromInt(0), false, "0"));
+  TEST(assertEqualFormat(toDecScratch, numFromInt(7), true, "7"));
+  TEST(assertEqualFormat(toDecScratch, numFromInt(-42), false, "-42"));
+  TEST(assertEqualFormat(toDecScratch, numFromInt(100), false, "100"));
+  TEST(assertEqualFormat(toDecScratch, numFromInt(-1000), true, "-1_000"));
+  TEST(assertEqualFormat(toDecScratch, numFromInt(123456), true, "123_456"));
+  TEST(assertEqualFormat(toDecScratch, numFromUInt64(UINT64_MAX), false, "18446744073709551615"));
+  TEST(assertEqualFormat(toDecScratch, numFromInt64(INT64_MIN), false, "-9223372036854775808"));
+  TEST(assertEqualFormat(toDecScratch, min, false, "-18446744073709551616"));
+  TEST(assertEqualFormat(toDecScratch, big, true, "18_446_744_073_709_551_616"));
+  TEST(assertEqualFormat(toDecScratch, mul(big, big), false,
+                         "340282366920938463463374607431768211456"));
+  TEST(assertEqualFormat(toDecScratch, mul(numFromUInt64(10000000000000000000u),
+                                          numFromUInt64(10000000000000000000u)), false,
+                         "100000000000000000000000000000000000000"));
+
+  TEST(assertEqualFormat(toHexString, numFromInt(0), false, "0x0"));
+  TEST(assertEqualFormat(toHexString, numFromInt(255), false, "0xFF"));
+  TEST(assertEqualFormat(toHexString, numFromInt(-255), false, "-0xFF"));
+  TEST(assertEqualFormat(toHexString, numFromInt(0x1FFFF), true, "0x1_FFFF"));
+  TEST(assertEqualFormat(toHexString, numFromUInt64(0xDEADBEEFCAFEBABE), true,
+                         "0xDEAD_BEEF_CAFE_BABE"));
+  TEST(assertEqualFormat(toHexString, min, false, "-0x10000000000000000"));
+  TEST(assertEqualFormat(toHexString, shiftLeft(numFromInt(0xAB), 120), false,
+                         "0xAB000000000000000000000000000000"));
+
+  TEST(assertEqualFormat(toBinString, numFromInt(0), false, "0b0"));
+  TEST(assertEqualFormat(toBinString, numFromInt(5), false, "0b101"));
+  TEST(assertEqualFormat(toBinString, numFromInt(-256), true, "-0b1_00000000"));
+  TEST(assertEqualFormat(toBinString, numFromInt(0xA5F0), true, "0b10100101_11110000"));
+  TEST(assertEqualFormat(toBinString, min, false,
+                         "-0b10000000000000000000000000000000000000000000000000000000000000000"));
+  TEST(assertEqualFormat(toBinString, min, true,
+                         "-0b1_00000000_00000000_00000000_00000000"
+                         "_00000000_00000000_00000000_00000000"));
+
+  {
+    char chars[4] = "abc";
+    TEST(assertEqualSize(toDecString(numFromInt(-1234), chars, sizeof(chars), false, NULL), 5));
+    TEST(assertTrue(strcmp(chars, "abc") == 0));  // too small, nothing written
+    TEST(assertEqualSize(toDecString(numFromInt(-12), chars, sizeof(chars), false, NULL), 3));
+    TEST(assertTrue(strcmp(chars, "-12") == 0));
+  }
+
+  numFree();
+  return result;
+}
+
+
+/**
+ * Converts large random numbers to literals and back by `numFromString()`.
+ */
+static TestResult testToStringRoundTrip() {
+  TestResult result = {};
+
+  size_t (*formats[])(Number, char*, size_t, bool) = { toDecScratch, toHexString, toBinString };
+  uint64_t state = 0x9E3779B97F4A7C15ull;
+  int mismatches = 0;
+  for (int i = 0; i < 600; i++) {
+    Number n = numFromInt(1);
+    for (int k = i % 20; k >= 0; k--) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      n = add(mul(n, numFromUInt64(state)), numFromInt((int) (state >> 40)));
+    }
+    if (i % 3 == 0) {
+      n = neg(n);
+    }
+
+    bool grouped = (i % 2 == 0);
+    size_t length = formats[i % 3](n, NULL, 0, grouped);
+    char* chars = (char*) malloc(length + 1);
+    formats[i % 3](n, chars, length + 1, grouped);
+    bool negative = (chars[0] == '-');
+    Number back = numFromString(stringFromRange(chars + negative, chars + length));
+    mismatches += compare(negative ? neg(back) : back, n) != 0;
+    mismatches += (strlen(chars) != length);
+    free(chars);
   }
+  TEST(assertEqualInt(mismatches, 0));
 
+  numFree();
   return result;
 }
 
@@ -17,6 +587,17 @@ static TestResult testCreation() {
 TestResult number_alltests(PrintLevel verbosity) {
   TestSuite suite = newSuite("TestSuite<number>", "Test numbers.");
   addTest(&suite, testCreation);
+  addTest(&suite, testFromString);
+  addTest(&suite, testBitSize);
+  addTest(&suite, testInlineBounds);
+  addTest(&suite, testMul);
+  addTest(&suite, testShift);
+  addTest(&suite, testRandomOperations);
+  addTest(&suite, testDivide);
+  addTest(&suite, testFixedWidth);
+  addTest(&suite, testRandomFixedWidth);
+  addTest(&suite, testToString);
+  addTest(&suite, testToStringRoundTrip);
   TestResult result = run(&suite, verbosity);
   deleteSuite(&suite);
   return result;
@@ -0,0 +1,201 @@
+#include "cunit.h"
+#include "util.h"
+
+#include "parlexer.h"
+#include "lexer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define SAME_ARRAYS(a, b) \
+        (sbufLength(a) == sbufLength(b) && \
+         (sbufLength(a) == 0 || memcmp(a, b, sbufLength(a) * sizeof(*(a))) == 0))
+
+
+static bool sameValues(const TokenArray* tokens, const TokenArray* expected) {
+  if (sbufLength(tokens->values) != sbufLength(expected->values)) {
+    return false;
+  }
+  for (size_t i = 0; i < sbufLength(tokens->values); i++) {
+    if (tokens->values[i].index != expected->values[i].index ||
+        tokens->values[i].value != expected->values[i].value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static bool sameErrors(const TokenArray* tokens, const TokenArray* expected) {
+  if (sbufLength(tokens->errors) != sbufLength(expected->errors)) {
+    return false;
+  }
+  for (size_t i = 0; i < sbufLength(tokens->errors); i++) {
+    if (tokens->errors[i].kind != expected->errors[i].kind ||
+        tokens->errors[i].offset != expected->errors[i].offset ||
+        tokens->errors[i].length != expected->errors[i].length ||
+        tokens->errors[i].caret != expected->errors[i].caret) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+ * Lexes the input in parallel with several numbers of threads and compares the tokens with the
+ * ones of `lexSource()`.
+ */
+static TestResult lexAndCompare(const char* input) {
+  TestResult result = {};
+  Source src = sourceFromString(input);
+  TokenArray expected = lexSource(&src);
+
+  int threads[] = { 1, 2, 3, 4, 7, 16 };
+  for (int i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+    TokenArray tokens = lexParallel(&src, threads[i]);
+    TEST(assertSame(tokens.source, &src));
+    TEST(assertEqualSize(tokenCount(&tokens), tokenCount(&expected)));
+    TEST(assertTrue(SAME_ARRAYS(tokens.kinds, expected.kinds)));
+    TEST(assertTrue(SAME_ARRAYS(tokens.subkinds, expected.subkinds)));
+    TEST(assertTrue(SAME_ARRAYS(tokens.offsets, expected.offsets)));
+    TEST(assertTrue(SAME_ARRAYS(tokens.lengths, expected.lengths)));
+    TEST(assertTrue(sameValues(&tokens, &expected)));
+    TEST(assertTrue(sameErrors(&tokens, &expected)));
+    deleteTokenArray(&tokens);
+  }
+
+  deleteTokenArray(&expected);
+  deleteSource(&src);
+  return result;
+}
+
+
+/**
+ * Appends lines until the input has at least `size` characters. The lines are picked round robin,
+ * such that the chunk boundaries fall onto all kinds of lines.
+ */
+static char* generate(SBUF(char) input, const char* const* lines, int count, size_t size) {
+  for (int i = 0; sbufLength(input) < size; i++) {
+    const char* line = lines[i % count];
+    size_t length = strlen(line);
+    sbufFit(input, length);
+    memcpy(sbufEnd(input), line, length);
+    sbufSetLength(input, sbufLength(input) + length);
+  }
+  return input;
+}
+
+
+static char* terminate(SBUF(char) input) {
+  sbufPush(input, '\0');
+  return input;
+}
+
+
+static TestResult testSmallSource() {
+  TestResult result = {};
+
+  {
+    TestResult r = lexAndCompare("x + 42 $ /* unclosed");
+    result = unite(result, r);
+  }
+
+  {
+    TestResult r = lexAndCompare("");
+    result = unite(result, r);
+  }
+
+  return result;
+}
+
+
+static TestResult testLargeSource() {
+  TestResult result = {};
+
+  const char* lines[] = {
+    "var x := 0x1F;  // a comment with a star */ in it\n",
+    "func f(a: int) -> int {\n",
+    "  return a * 123_456_789 + 0b1010 / c;\n",
+    "}\n",
+    "/* a multi-line comment\n",
+    "   with / slashes * and stars\n",
+    "   which ends here */ if (x) { y = 1x; }\n",
+    "a */ b;\n",
+    "  $ 0x 99999999999999999999 # \n",
+    "\n",
+    "/**/ /*/ still a comment */ z\n",
+    "  s = \"a /* b \\x41\\n\" + '\\'' + \"*/ unclosed\n",
+  };
+
+  {
+    SBUF(char) input = generate(NULL, lines, sizeof(lines) / sizeof(lines[0]), 1 << 20);
+    input = terminate(input);
+    TestResult r = lexAndCompare(input);
+    result = unite(result, r);
+    sbufFree(input);
+  }
+
+  {
+    SBUF(char) input = generate(NULL, lines, sizeof(lines) / sizeof(lines[0]), 1 << 20);
+    input = terminate(generate(input, (const char*[]){ "/* unclosed\n" }, 1, (1 << 20) + 1));
+    TestResult r = lexAndCompare(input);
+    result = unite(result, r);
+    sbufFree(input);
+  }
+
+  return result;
+}
+
+
+static TestResult testLongComments() {
+  TestResult result = {};
+
+  const char* code[] = { "x := y + 1;\n", "*/ */\n" };
+  const char* comment[] = { "/* a comment spanning several chunks\n" };
+  const char* text[] = { "   more comment text, no closing here\n" };
+
+  {
+    SBUF(char) input = generate(NULL, code, 1, 100000);
+    input = generate(input, comment, 1, sbufLength(input) + 1);
+    input = generate(input, text, 1, sbufLength(input) + 400000);
+    input = generate(input, code, 2, sbufLength(input) + 300000);
+    input = terminate(input);
+    TestResult r = lexAndCompare(input);
+    result = unite(result, r);
+    sbufFree(input);
+  }
+
+  {
+    SBUF(char) input = generate(NULL, code, 1, 100000);
+    input = generate(input, comment, 1, sbufLength(input) + 1);
+    input = terminate(generate(input, text, 1, sbufLength(input) + 900000));
+    TestResult r = lexAndCompare(input);
+    result = unite(result, r);
+    sbufFree(input);
+  }
+
+  {
+    // no newline at all, thus there is only a single chunk
+    SBUF(char) input = generate(NULL, (const char*[]){ "a + b " }, 1, 500000);
+    input = terminate(input);
+    TestResult r = lexAndCompare(input);
+    result = unite(result, r);
+    sbufFree(input);
+  }
+
+  return result;
+}
+
+
+TestResult parlexer_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<parlexer>", "Test parallel lexing.");
+  addTest(&suite, testSmallSource);
+  addTest(&suite, testLargeSource);
+  addTest(&suite, testLongComments);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
@@ -4,6 +4,7 @@
 #include "parser.h"
 
 #include "error.h"
+#include "lexer.h"
 #include "strintern.h"
 
 
@@ -70,6 +71,14 @@ static TestResult testParseEmptyString() {
     deleteSource(&src);
   }
 
+  {
+    Source src = sourceFromString("// comment");  // the parser never sees comments
+    ASTNode* node = parse(&src);
+    TEST(assertASTNode(node, AST_NONE));
+    deleteNode(node);
+    deleteSource(&src);
+  }
+
   return result;
 }
 
@@ -109,14 +118,6 @@ static TestResult testParseErrors() {
     deleteSource(&src);
   }
 
-  {
-    Source src = sourceFromString("// comment");
-    ASTNode* node = parse(&src);
-    TEST(assertASTNode(node, AST_ERROR));
-    deleteNode(node);
-    deleteSource(&src);
-  }
-
   return result;
 }
 
@@ -153,7 +154,7 @@ static TestResult testParseExprInt() {
     Source src = sourceFromString("123");
     ASTNode* node = parse(&src);
     ABORT(assertASTExpr(node, EXPR_INT));
-    TEST(assertEqualNumber(node->expr.value, num("123")));
+    TEST(assertEqualNumber(constAt(node->expr.constant), num("123")));
     deleteNode(node);
     deleteSource(&src);
   }
@@ -162,7 +163,7 @@ static TestResult testParseExprInt() {
     Source src = sourceFromString("0b__1111_0000");
     ASTNode* node = parse(&src);
     ABORT(assertASTExpr(node, EXPR_INT));
-    TEST(assertEqualNumber(node->expr.value, num("0b__1111_0000")));
+    TEST(assertEqualNumber(constAt(node->expr.constant), num("0b__1111_0000")));
     deleteNode(node);
     deleteSource(&src);
   }
@@ -171,7 +172,33 @@ static TestResult testParseExprInt() {
     Source src = sourceFromString("0x_1234_ABCD");
     ASTNode* node = parse(&src);
     ABORT(assertASTExpr(node, EXPR_INT));
-    TEST(assertEqualNumber(node->expr.value, num("0x_1234_ABCD")));
+    TEST(assertEqualNumber(constAt(node->expr.constant), num("0x_1234_ABCD")));
+    TEST(assertEqualNumber(constAt(node->expr.constant), numFromUInt64(0x1234ABCD)));
+    deleteNode(node);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testParseExprFloat() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("3.25e2");
+    ASTNode* node = parse(&src);
+    ABORT(assertASTExpr(node, EXPR_FLOAT));
+    TEST(assertTrue(node->expr.floatValue == 325.0));
+    deleteNode(node);
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("0x1.8p1");
+    ASTNode* node = parse(&src);
+    ABORT(assertASTExpr(node, EXPR_FLOAT));
+    TEST(assertTrue(node->expr.floatValue == 3.0));
     deleteNode(node);
     deleteSource(&src);
   }
@@ -423,16 +450,132 @@ static TestResult testParseExprBinopAssociativity() {
 }
 
 
+static TestResult testParseComments() {
+  TestResult result = {};
+
+  const char* inputs[] = { "x +/*c*/ y", "/* a */ x // b\n + // c\n y // d" };
+  for (int i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    Source src = sourceFromString(inputs[i]);
+    ASTNode* node = parse(&src);
+    ABORT(assertASTExpr(node, EXPR_BINOP));
+    TEST(assertEqualStr(node->expr.op, "+"));
+    TEST(assertASTExpr(node->expr.lhs, EXPR_NAME));
+    TEST(assertASTExpr(node->expr.rhs, EXPR_NAME));
+    deleteNode(node);
+
+    TokenArray tokens = lexSource(&src);  // the array keeps the comments
+    node = parseTokens(&tokens);
+    ABORT(assertASTExpr(node, EXPR_BINOP));
+    TEST(assertASTExpr(node->expr.rhs, EXPR_NAME));
+    deleteNode(node);
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testParsePipelined() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("a - -1 * /* c */ b");
+    ASTNode* node = parsePipelined(&src);
+    ABORT(assertASTExpr(node, EXPR_BINOP));
+    TEST(assertEqualStr(node->expr.op, "*"));
+    ABORT(assertASTExpr(node->expr.lhs, EXPR_BINOP));
+    TEST(assertEqualStr(node->expr.lhs->expr.op, "-"));
+    TEST(assertASTExpr(node->expr.lhs->expr.rhs, EXPR_UNOP));
+    TEST(assertASTExpr(node->expr.rhs, EXPR_NAME));
+    deleteNode(node);
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("");
+    ASTNode* node = parsePipelined(&src);
+    TEST(assertASTNode(node, AST_NONE));
+    deleteNode(node);
+    deleteSource(&src);
+  }
+
+  {
+    // the parser stops at the error long before the lexer thread is done
+    string input = stringFromPrint("1x %0*d", 100000, 0);
+    for (int i = 3; i < input.len; i += 2) {
+      ((char*) input.chars)[i] = ' ';
+    }
+    Source src = sourceFromString(input.chars);
+    ASTNode* node = parsePipelined(&src);
+    ABORT(assertASTNode(node, AST_ERROR));
+    ASTNode* expected = parse(&src);
+    ABORT(assertEqualSize(sbufLength(node->messages), sbufLength(expected->messages)));
+    TEST(assertTrue(strequal(node->messages[0], expected->messages[0])));
+    deleteNode(expected);
+    deleteNode(node);
+    deleteSource(&src);
+    strFree(&input);
+  }
+
+  return result;
+}
+
+
+static TestResult testParseTokens() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("a - -1 * b");
+    TokenArray tokens = lexSource(&src);
+    ASTNode* node = parseTokens(&tokens);
+    ABORT(assertASTExpr(node, EXPR_BINOP));
+    TEST(assertEqualStr(node->expr.op, "*"));
+    ABORT(assertASTExpr(node->expr.lhs, EXPR_BINOP));
+    TEST(assertEqualStr(node->expr.lhs->expr.op, "-"));
+    TEST(assertASTExpr(node->expr.lhs->expr.rhs, EXPR_UNOP));
+    TEST(assertASTExpr(node->expr.rhs, EXPR_NAME));
+    deleteNode(node);
+
+    node = parseTokens(&tokens);  // the tokens can be parsed again
+    TEST(assertASTExpr(node, EXPR_BINOP));
+    deleteNode(node);
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("1x");
+    TokenArray tokens = lexSource(&src);
+    ASTNode* node = parseTokens(&tokens);
+    ABORT(assertEqualInt(node->kind, AST_ERROR));
+    ABORT(assertEqualSize(sbufLength(node->messages), 1));
+    Error error = errorFromLexError(&src, tokens.errors[0]);
+    TEST(assertTrue(strequal(node->messages[0], error.message)));
+    deleteError(&error);
+    deleteNode(node);
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
 TestResult parser_alltests(PrintLevel verbosity) {
   TestSuite suite = newSuite("TestSuite<parser>", "Test parser.");
   addTest(&suite, testParseEmptyString);
   addTest(&suite, testParseErrors);
   addTest(&suite, testParseExprName);
   addTest(&suite, testParseExprInt);
+  addTest(&suite, testParseExprFloat);
   addTest(&suite, testParseExprUnary);
 //  addTest(&suite, testParseExprParen);
   addTest(&suite, testParseExprArithmeticBinop);
   addTest(&suite, testParseExprBinopAssociativity);
+  addTest(&suite, testParseComments);
+  addTest(&suite, testParsePipelined);
+  addTest(&suite, testParseTokens);
   TestResult result = run(&suite, verbosity);
   deleteSuite(&suite);
   strinternFree();
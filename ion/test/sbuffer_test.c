@@ -257,6 +257,39 @@ static TestResult testPushElements() {
 }
 
 
+static TestResult testRemoveElements() {
+  TestResult result = {};
+
+  {
+    SBUF(int) buffer = NULL;
+    sbufClear(buffer);
+    sbufSetLength(buffer, 0);
+    TEST(assertNull(buffer));
+  }
+
+  {
+    SBUF(int) buffer = NULL;
+    sbufPush(buffer, 42);
+    sbufPush(buffer, 43);
+    sbufPop(buffer);
+    TEST(assertEqualSize(sbufLength(buffer), 1));
+    TEST(assertEqualInt(buffer[0], 42));
+    sbufClear(buffer);
+    TEST(assertEqualSize(sbufLength(buffer), 0));
+    TEST(assertEqualSize(sbufCapacity(buffer), 3));
+    sbufFit(buffer, 2);
+    buffer[0] = 7;
+    buffer[1] = 8;
+    sbufSetLength(buffer, 2);
+    TEST(assertEqualSize(sbufLength(buffer), 2));
+    TEST(assertEqualInt(buffer[1], 8));
+    sbufFree(buffer);
+  }
+
+  return result;
+}
+
+
 static TestResult testIteration() {
   TestResult result = {};
 
@@ -345,6 +378,7 @@ TestResult sbuffer_alltests(PrintLevel verbosity) {
   addTest(&suite, testGrowthOfNonEmptyBuffer);
   addTest(&suite, testFitBuffer);
   addTest(&suite, testPushElements);
+  addTest(&suite, testRemoveElements);
   addTest(&suite, testIteration);
   addTest(&suite, testFreeBuffer);
   TestResult result = run(&suite, verbosity);
@@ -146,12 +146,193 @@ static TestResult testGetLine() {
 }
 
 
+static TestResult testLineIndex() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("");
+    ABORT(assertEqualSize(sbufLength(src.lines), 1));
+    TEST(assertEqualInt(src.lines[0], 0));
+    deleteSource(&src);
+    TEST(assertNull(src.lines));
+  }
+
+  {
+    Source src = sourceFromString("foo\nbar\n\nbaz");
+    ABORT(assertEqualSize(sbufLength(src.lines), 4));
+    TEST(assertEqualInt(src.lines[0], 0));
+    TEST(assertEqualInt(src.lines[1], 4));
+    TEST(assertEqualInt(src.lines[2], 8));
+    TEST(assertEqualInt(src.lines[3], 9));
+    deleteSource(&src);
+  }
+
+  {
+    // long enough to be processed in blocks
+    Source src = sourceFromString("0123456789abcde\n0123456789\nabcdefghijklmnopqrstuvwxyz\n");
+    ABORT(assertEqualSize(sbufLength(src.lines), 4));
+    TEST(assertEqualInt(src.lines[1], 16));
+    TEST(assertEqualInt(src.lines[2], 27));
+    TEST(assertEqualInt(src.lines[3], 54));
+    TEST(assertEqualStr(getLine(&src, 2), "0123456789\n"));
+    TEST(assertEqualStr(getLine(&src, 3), "abcdefghijklmnopqrstuvwxyz\n"));
+    TEST(assertEqualStr(getLine(&src, 4), ""));
+    TEST(assertEqualStr(getLine(&src, 5), ""));
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testGetLocation() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("line one\nline two\n\nx");
+    Location loc = getLocation(&src, 0);
+    TEST(assertEqualInt(loc.line, 1));
+    TEST(assertEqualInt(loc.pos, 1));
+    loc = getLocation(&src, 8);  // the newline belongs to its line
+    TEST(assertEqualInt(loc.line, 1));
+    TEST(assertEqualInt(loc.pos, 9));
+    loc = getLocation(&src, 12);
+    TEST(assertEqualInt(loc.line, 2));
+    TEST(assertEqualInt(loc.pos, 4));
+    loc = getLocation(&src, 18);
+    TEST(assertEqualInt(loc.line, 3));
+    TEST(assertEqualInt(loc.pos, 1));
+    loc = getLocation(&src, 19);
+    TEST(assertEqualInt(loc.line, 4));
+    TEST(assertEqualInt(loc.pos, 1));
+    loc = getLocation(&src, 20);  // right after the last character
+    TEST(assertEqualInt(loc.line, 4));
+    TEST(assertEqualInt(loc.pos, 2));
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testValidation() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("x := \"gr\xC3\xBC\xC3\x9F \xE2\x82\xAC \xF0\x9F\x98\x80\"");
+    TEST(assertEqualInt(src.status, SOURCE_OK));
+    TEST(assertEqualStr(src.content, "x := \"gr\xC3\xBC\xC3\x9F \xE2\x82\xAC \xF0\x9F\x98\x80\""));
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("abc\n  \xFF");
+    TEST(assertEqualInt(src.status, SOURCE_ERROR));
+    TEST(assertEqualStr(src.content, "ERROR: invalid UTF-8 at 2:3"));
+    TEST(assertNull(src.lines));
+    deleteSource(&src);
+  }
+
+  {
+    const char* invalid[] = {
+      "\x80",              // continuation byte without start
+      "\xC3",              // truncated sequence
+      "\xC3x",             // missing continuation byte
+      "\xC0\xAF",          // overlong encoding of '/'
+      "\xE0\x80\xAF",      // overlong encoding of '/'
+      "\xED\xA0\x80",      // surrogate U+D800
+      "\xF4\x90\x80\x80",  // beyond U+10FFFF
+      "\xF5\x80\x80\x80",  // invalid start byte
+      "0123456789abcdef0123456789\xFE",
+    };
+    for (int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+      Source src = sourceFromString(invalid[i]);
+      TEST(assertEqualInt(src.status, SOURCE_ERROR));
+      deleteSource(&src);
+    }
+  }
+
+  return result;
+}
+
+
+static TestResult testNulCharacter() {
+  TestResult result = {};
+
+  struct { const char* content; size_t length; const char* message; } cases[] = {
+    { "x := 1;\n  \0 y := 2;", 19, "ERROR: NUL character at 2:3" },
+    { "0123456789abcdef0123456789\0" "123456789", 37, "ERROR: NUL character at 1:27" },
+  };
+  for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    FILE* file = fopen(FILENAME, "wb");  // WRITE_FILE() stops at the NUL character
+    ABORT(assertNotNull(file));
+    fwrite(cases[i].content, 1, cases[i].length, file);
+    fclose(file);
+    Source src = sourceFromFile(FILENAME);
+    TEST(assertEqualInt(src.status, SOURCE_ERROR));
+    TEST(assertEqualStr(src.content, cases[i].message));
+    TEST(assertNull(src.lines));
+    deleteSource(&src);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
+static TestResult testNormalization() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("a\r\nb");
+    TEST(assertEqualStr(src.content, "a\r\nb"));
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromStringWith("a\r\nb\rc\r\n", SOURCE_NORMALIZE_CRLF);
+    TEST(assertEqualStr(src.content, "a\nb\rc\n"));
+    ABORT(assertEqualSize(sbufLength(src.lines), 3));
+    TEST(assertEqualInt(src.lines[1], 2));
+    TEST(assertEqualInt(src.lines[2], 6));
+    deleteSource(&src);
+  }
+
+  {
+    // content after the first CRLF must be moved, also in blocks
+    Source src = sourceFromStringWith("line\r\n0123456789abcdef0123456789\r\n\xC3\xA4",
+                                      SOURCE_NORMALIZE_CRLF);
+    TEST(assertEqualStr(src.content, "line\n0123456789abcdef0123456789\n\xC3\xA4"));
+    TEST(assertEqualStr(getLine(&src, 2), "0123456789abcdef0123456789\n"));
+    TEST(assertEqualStr(getLine(&src, 3), "\xC3\xA4"));
+    deleteSource(&src);
+  }
+
+  WRITE_FILE("x\r\ny");
+
+  {
+    Source src = sourceFromFileWith(FILENAME, SOURCE_NORMALIZE_CRLF);
+    TEST(assertEqualInt(src.status, SOURCE_OK));
+    TEST(assertEqualStr(src.content, "x\ny"));
+    deleteSource(&src);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
 TestResult source_alltests(PrintLevel verbosity) {
   TestSuite suite = newSuite("TestSuite<source>", "Test sources.");
   addTest(&suite, testCreationFromString);
   addTest(&suite, testCreationFromFile);
   addTest(&suite, testDeletion);
   addTest(&suite, testGetLine);
+  addTest(&suite, testLineIndex);
+  addTest(&suite, testGetLocation);
+  addTest(&suite, testValidation);
+  addTest(&suite, testNulCharacter);
+  addTest(&suite, testNormalization);
   TestResult result = run(&suite, verbosity);
   deleteSuite(&suite);
   return result;
@@ -0,0 +1,215 @@
+#include "cunit.h"
+#define FILENAME "__stream__.tmp"
+#include "util.h"
+
+#include "stream.h"
+#include "lexer.h"
+
+
+static TestResult testCreation() {
+  TestResult result = {};
+  WRITE_FILE("lorem ipsum dolor");
+
+  {
+    SourceStream stream = streamFromFile(FILENAME, 4);
+    TEST(assertEqualInt(stream.window.status, SOURCE_OK));
+    TEST(assertEqualStr(stream.window.fileName, FILENAME));
+    TEST(assertEqualStr(stream.window.content, ""));
+    TEST(assertEqualInt(stream.window.firstLine, 1));
+    TEST(assertEqualSize(stream.chunkSize, 4));
+    TEST(assertFalse(stream.eof));
+    deleteStream(&stream);
+    TEST(assertEqualInt(stream.window.status, SOURCE_NONE));
+    TEST(assertEqualStr(stream.window.content, ""));
+  }
+
+  {
+    const char* name = "." FILENAME;
+    SourceStream stream = streamFromFile(name, 4);
+    TEST(assertEqualInt(stream.window.status, SOURCE_ERROR));
+    TEST(assertEqualStr(stream.window.fileName, name));
+    TEST(assertEqualStr(stream.window.content, "ERROR: could not open the file"));
+    TEST(assertTrue(stream.eof));
+    deleteStream(&stream);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
+static TestResult testRefill() {
+  TestResult result = {};
+  WRITE_FILE("ab\ncd\nef");
+
+  {
+    SourceStream stream = streamFromFile(FILENAME, 4);
+    TEST(assertEqualSize(streamRefill(&stream, 0), 0));
+    TEST(assertEqualStr(stream.window.content, "ab\nc"));
+    TEST(assertFalse(stream.eof));
+
+    // "c" is still in use, thus the window is cut at the start of its line
+    TEST(assertEqualSize(streamRefill(&stream, 3), 3));
+    TEST(assertEqualStr(stream.window.content, "cd\nef"));
+    TEST(assertEqualInt(stream.window.firstLine, 2));
+    TEST(assertEqualSize(stream.offset, 3));
+    TEST(assertFalse(stream.eof));
+    TEST(assertEqualStr(getLine(&stream.window, 1), ""));
+    TEST(assertEqualStr(getLine(&stream.window, 2), "cd\n"));
+    TEST(assertEqualStr(getLine(&stream.window, 3), "ef"));
+
+    // no more data, but the consumed lines are still dropped
+    TEST(assertEqualSize(streamRefill(&stream, 4), 3));
+    TEST(assertEqualStr(stream.window.content, "ef"));
+    TEST(assertEqualInt(stream.window.firstLine, 3));
+    TEST(assertTrue(stream.eof));
+    TEST(assertEqualSize(streamRefill(&stream, 2), 0));
+    TEST(assertEqualStr(stream.window.content, "ef"));
+    deleteStream(&stream);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
+static TestResult testLexing() {
+  TestResult result = {};
+  const char* input = "var x := 0x_FF;  // comment\n"
+                      "func f : (a: int) -> int {\n"
+                      "  /* multi-line\n"
+                      "     comment */\n"
+                      "  s := \"a\\tb\" + '\\x41';\n"
+                      "  return a+x;\n"
+                      "}\n";
+  WRITE_FILE(input);
+
+  // tokens must not depend on the chunk size, even if a chunk ends within a token
+  for (size_t chunkSize = 1; chunkSize <= 17; chunkSize += 4) {
+    Source src = sourceFromString(input);
+    Lexer expLexer = lexerFromSource(&src);
+    SourceStream stream = streamFromFile(FILENAME, chunkSize);
+    Lexer lexer = lexerFromStream(&stream);
+
+    Token exp;
+    do {
+      exp = nextToken(&expLexer);
+      Token token = nextToken(&lexer);
+      TEST(assertEqualInt(token.kind, exp.kind));
+      TEST(assertEqualInt(tokenStart(token).line, tokenStart(exp).line));
+      TEST(assertEqualInt(tokenStart(token).pos, tokenStart(exp).pos));
+      TEST(assertEqualInt(tokenEnd(token).line, tokenEnd(exp).line));
+      TEST(assertEqualInt(tokenEnd(token).pos, tokenEnd(exp).pos));
+      TEST(assertTrue(strequal(token.chars, exp.chars)));
+    } while (exp.kind != TOKEN_EOF);
+
+    // the window never holds much more than a chunk and the longest line (28 characters)
+    TEST(assertTrue(stream.capacity <= 2*(chunkSize + 1 + 28)));
+    deleteStream(&stream);
+    deleteSource(&src);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
+static TestResult testLexingErrors() {
+  TestResult result = {};
+  WRITE_FILE("x\ny\n  $");
+
+  {
+    SourceStream stream = streamFromFile(FILENAME, 2);
+    Lexer lexer = lexerFromStream(&stream);
+    nextToken(&lexer);
+    nextToken(&lexer);
+    Token token = nextToken(&lexer);
+    ABORT(assertEqualInt(token.kind, TOKEN_ERROR));
+    TEST(assertEqualInt(tokenStart(token).line, 3));
+    TEST(assertEqualInt(tokenStart(token).pos, 3));
+    Error error = errorFromToken(token);
+    TEST(assertEqualStr(error.message,
+                        FILENAME ":3:3: \e[31mError:\e[39m illegal character '$'\n"
+                        "  $\n  \e[32m^\e[39m\n"));
+    deleteError(&error);
+    deleteLexer(&lexer);
+    deleteStream(&stream);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
+static bool writeBytes(const char* bytes, size_t length) {
+  FILE* file = fopen(FILENAME, "wb");  // WRITE_FILE() stops at a NUL character
+  if (file == NULL) {
+    return false;
+  }
+  bool ok = fwrite(bytes, 1, length, file) == length;
+  return (fclose(file) == 0) && ok;
+}
+
+
+static TestResult testRejectedInput() {
+  TestResult result = {};
+
+  struct { const char* input; size_t length; int tokens; const char* message; } cases[] = {
+    { "a + b\0 c + d\n", 14, 3, "ERROR: NUL character at 1:6" },
+    { "ab\n\xC3(x", 6, 1, "ERROR: invalid UTF-8 at 2:1" },  // crosses the chunk boundary
+    { "ab \xE2\x82", 5, 1, "ERROR: invalid UTF-8 at 1:4" },  // cut by the end of the input
+  };
+  for (int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    ABORT(assertTrue(writeBytes(cases[i].input, cases[i].length)));
+    SourceStream stream = streamFromFile(FILENAME, 4);
+    Lexer lexer = lexerFromStream(&stream);
+    int count = 0;
+    for (Token token = nextToken(&lexer); token.kind != TOKEN_EOF; token = nextToken(&lexer)) {
+      TEST(assertTrue(token.kind != TOKEN_ERROR));
+      count++;
+    }
+    TEST(assertEqualInt(count, cases[i].tokens));
+    TEST(assertEqualInt(stream.window.status, SOURCE_ERROR));
+    TEST(assertEqualStr(stream.message, cases[i].message));
+    TEST(assertTrue(stream.eof));
+    deleteLexer(&lexer);
+    deleteStream(&stream);
+  }
+
+  // characters cut by any chunk size are completed by the next chunk
+  const char input[] = "x = \"\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80\";\n";
+  ABORT(assertTrue(writeBytes(input, sizeof(input) - 1)));
+  for (size_t chunkSize = 1; chunkSize <= 8; chunkSize++) {
+    SourceStream stream = streamFromFile(FILENAME, chunkSize);
+    Lexer lexer = lexerFromStream(&stream);
+    nextToken(&lexer);
+    nextToken(&lexer);
+    Token token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_STRING));
+    TEST(assertEqualStr(token.chars, "\"\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80\""));
+    token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_SYMBOL));
+    token = nextToken(&lexer);
+    TEST(assertEqualInt(token.kind, TOKEN_EOF));
+    TEST(assertEqualInt(stream.window.status, SOURCE_OK));
+    TEST(assertEqualStr(stream.message, ""));
+    deleteLexer(&lexer);
+    deleteStream(&stream);
+  }
+
+  DELETE_FILE();
+  return result;
+}
+
+
+TestResult stream_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<stream>", "Test source streams.");
+  addTest(&suite, testCreation);
+  addTest(&suite, testRefill);
+  addTest(&suite, testLexing);
+  addTest(&suite, testLexingErrors);
+  addTest(&suite, testRejectedInput);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
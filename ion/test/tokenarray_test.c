@@ -0,0 +1,325 @@
+#include "cunit.h"
+#include "util.h"
+
+#include "tokenarray.h"
+#include "lexer.h"
+
+#include <stdlib.h>
+
+
+static TestResult testLexSource() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("x + 42");
+    TokenArray tokens = lexSource(&src);
+    TEST(assertSame(tokens.source, &src));
+    ABORT(assertEqualSize(tokenCount(&tokens), 4));
+    TEST(assertEqualInt(tokens.kinds[0], TOKEN_NAME));
+    TEST(assertEqualInt(tokens.kinds[1], TOKEN_SYMBOL));
+    TEST(assertEqualInt(tokens.subkinds[1], SYMBOL_PLUS));
+    TEST(assertEqualInt(tokens.kinds[2], TOKEN_INT));
+    TEST(assertEqualInt(tokens.offsets[2], 4));
+    TEST(assertEqualInt(tokens.lengths[2], 2));
+    ABORT(assertEqualSize(sbufLength(tokens.values), 1));
+    TEST(assertEqualInt(tokens.values[0].index, 2));
+    TEST(assertTrue(tokens.values[0].value == 42));
+    TEST(assertTrue(tokenAt(&tokens, 2).value == 42));
+    TEST(assertEqualInt(tokens.kinds[3], TOKEN_EOF));
+    TEST(assertEqualInt(tokens.offsets[3], 6));
+    TEST(assertEqualInt(tokens.lengths[3], 0));
+    TEST(assertNull(tokens.errors));
+    deleteTokenArray(&tokens);
+    TEST(assertNull(tokens.kinds));
+    TEST(assertNull(tokens.offsets));
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("");
+    TokenArray tokens = lexSource(&src);
+    ABORT(assertEqualSize(tokenCount(&tokens), 1));
+    TEST(assertEqualInt(tokens.kinds[0], TOKEN_EOF));
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testSameAsLexer() {
+  TestResult result = {};
+
+  const char* input = "var x := 0x1F;\n"
+                      "func f(a: int) -> int {  // comment\n"
+                      "  return a $ 1x + 0b;\n"
+                      "}\n"
+                      "/* multi-line\n"
+                      "   comment */ if  while\n"
+                      "/* unclosed";
+  Source src = sourceFromString(input);
+  TokenArray tokens = lexSource(&src);
+  Lexer lexer = lexerFromSource(&src);
+
+  for (size_t i = 0; i < tokenCount(&tokens); i++) {
+    Token exp = nextToken(&lexer);
+    Token token = tokenAt(&tokens, i);
+    TEST(assertEqualInt(token.kind, exp.kind));
+    TEST(assertEqualInt(token.keyword, exp.keyword));
+    TEST(assertTrue(token.value == exp.value));  // or the caret of an error
+    TEST(assertSame(token.source, &src));
+    TEST(assertEqualInt(tokenStart(token).line, tokenStart(exp).line));
+    TEST(assertEqualInt(tokenStart(token).pos, tokenStart(exp).pos));
+    TEST(assertEqualInt(tokenEnd(token).line, tokenEnd(exp).line));
+    TEST(assertEqualInt(tokenEnd(token).pos, tokenEnd(exp).pos));
+    TEST(assertTrue(strequal(token.chars, exp.chars)));
+    if (exp.kind == TOKEN_ERROR) {
+      Error error = errorFromToken(token);
+      Error expError = errorFromToken(exp);
+      TEST(assertTrue(strequal(error.message, expError.message)));
+      deleteError(&error);
+      deleteError(&expError);
+    }
+  }
+  TEST(assertEqualInt(nextToken(&lexer).kind, TOKEN_EOF));
+  ABORT(assertEqualSize(sbufLength(tokens.errors), 4));
+  TEST(assertEqualSize(sbufLength(lexer.errors), 4));
+  for (int i = 0; i < 4; i++) {
+    TEST(assertEqualInt(tokens.errors[i].kind, lexer.errors[i].kind));
+    TEST(assertEqualInt(tokens.errors[i].offset, lexer.errors[i].offset));
+  }
+  deleteLexer(&lexer);
+
+  deleteTokenArray(&tokens);
+  deleteSource(&src);
+  return result;
+}
+
+
+static TestResult testIterator() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("a b");
+    TokenArray tokens = lexSource(&src);
+    TokenIterator it = iteratorFromTokens(&tokens);
+    TEST(assertEqualStr(iteratorNext(&it).chars, "a"));
+    TEST(assertEqualStr(iteratorNext(&it).chars, "b"));
+    TEST(assertEqualInt(iteratorNext(&it).kind, TOKEN_EOF));
+    TEST(assertEqualInt(iteratorNext(&it).kind, TOKEN_EOF));  // EOF is repeated
+    TEST(assertEqualSize(it.index, 2));
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("x := 1 + 0x; \"s\" 'c' y 2.5 12a");
+    TokenArray tokens = lexSource(&src);
+    TokenIterator it = iteratorFromTokens(&tokens);
+    int mismatches = 0;
+    for (size_t i = 0; i < tokenCount(&tokens); i++) {
+      Token token = iteratorNext(&it);
+      Token exp = tokenAt(&tokens, i);
+      mismatches += token.kind != exp.kind || token.value != exp.value ||
+                    !strequal(token.chars, exp.chars);
+    }
+    TEST(assertEqualInt(mismatches, 0));
+    TEST(assertEqualSize(it.value, sbufLength(tokens.values)));  // all values were passed
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static bool sameTokens(const TokenArray* tokens, const TokenArray* expected) {
+  if (tokenCount(tokens) != tokenCount(expected) ||
+      sbufLength(tokens->values) != sbufLength(expected->values) ||
+      sbufLength(tokens->errors) != sbufLength(expected->errors)) {
+    return false;
+  }
+  for (size_t i = 0; i < tokenCount(tokens); i++) {
+    if (tokens->kinds[i] != expected->kinds[i] || tokens->subkinds[i] != expected->subkinds[i] ||
+        tokens->offsets[i] != expected->offsets[i] || tokens->lengths[i] != expected->lengths[i]) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < sbufLength(tokens->values); i++) {
+    if (tokens->values[i].index != expected->values[i].index ||
+        tokens->values[i].value != expected->values[i].value) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < sbufLength(tokens->errors); i++) {
+    if (tokens->errors[i].kind != expected->errors[i].kind ||
+        tokens->errors[i].offset != expected->errors[i].offset ||
+        tokens->errors[i].length != expected->errors[i].length ||
+        tokens->errors[i].caret != expected->errors[i].caret) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+ * Applies the edit to the content and relexes the tokens, which then must be the same as the ones
+ * of the edited content. The tokens take over the new source.
+ */
+static TokenRange applyEdit(TokenArray* tokens, Source* src, TextEdit edit, const char* text,
+                            bool* same) {
+  const char* chars = src->content.chars;
+  string content = stringFromPrint("%.*s%s%s", (int) edit.offset, chars, text,
+                                   &chars[edit.offset + edit.removed]);
+  Source edited = sourceFromString(content.chars);
+  strFree(&content);
+
+  TokenRange range = relexSource(tokens, &edited, edit);
+  TokenArray expected = lexSource(&edited);
+  *same = sameTokens(tokens, &expected);
+  deleteTokenArray(&expected);
+
+  deleteSource(src);
+  *src = edited;
+  tokens->source = src;
+  return range;
+}
+
+
+static TestResult testRelexSource() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("a + b * c");
+    TokenArray tokens = lexSource(&src);
+    bool same = false;
+
+    TokenRange range = applyEdit(&tokens, &src, (TextEdit){ 2, 1, 1 }, "-", &same);
+    TEST(assertTrue(same));
+    TEST(assertEqualSize(range.first, 1));
+    TEST(assertEqualSize(range.removed, 1));
+    TEST(assertEqualSize(range.inserted, 1));
+
+    range = applyEdit(&tokens, &src, (TextEdit){ 1, 0, 2 }, "bc", &same);  // "abc - b * c"
+    TEST(assertTrue(same));
+    TEST(assertEqualSize(range.first, 0));
+    TEST(assertEqualSize(range.removed, 1));
+    TEST(assertEqualSize(range.inserted, 1));
+    TEST(assertEqualInt(tokens.offsets[2], 6));
+
+    range = applyEdit(&tokens, &src, (TextEdit){ 3, 6, 0 }, "", &same);  // "abc c"
+    TEST(assertTrue(same));
+    TEST(assertEqualSize(range.first, 0));
+    TEST(assertEqualSize(range.removed, 4));
+    TEST(assertEqualSize(range.inserted, 1));
+    TEST(assertEqualSize(tokenCount(&tokens), 3));
+
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  {
+    // typing a comment turns the rest into a comment and back
+    Source src = sourceFromString("var x := 0x1F;\nx = x + 1;  // add\n$ y := 1x;\nz = 0b2;\n");
+    TokenArray tokens = lexSource(&src);
+    bool same = false;
+    struct { TextEdit edit; const char* text; } edits[] = {
+      { { 15, 0, 1 }, "/" },
+      { { 16, 0, 1 }, "*" },
+      { { 17, 0, 1 }, " " },
+      { { 30, 0, 2 }, "*/" },
+      { { 30, 2, 0 }, "" },
+      { { 15, 3, 0 }, "" },
+      { { 8,  6, 5 }, "12_34" },
+      { { 0,  0, 1 }, "$" },
+      { { 0,  1, 0 }, "" },
+      { { 44, 0, 4 }, "\n/**" },
+      { { 5,  0, 1 }, "1" },
+    };
+    for (int i = 0; i < sizeof(edits) / sizeof(edits[0]); i++) {
+      applyEdit(&tokens, &src, edits[i].edit, edits[i].text, &same);
+      TEST(assertTrue(same));
+    }
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  {
+    // numbers look up to three characters ahead, e.g. "1e+x" is an error "1e" and "+x"
+    Source src = sourceFromString("a = 1.x; b = 1e+x;");
+    TokenArray tokens = lexSource(&src);
+    bool same = false;
+
+    TokenRange range = applyEdit(&tokens, &src, (TextEdit){ 6, 1, 1 }, "5", &same);  // "1.5"
+    TEST(assertTrue(same));
+    TEST(assertEqualSize(range.first, 2));
+    TEST(assertEqualSize(range.removed, 3));
+    TEST(assertEqualSize(range.inserted, 1));
+
+    applyEdit(&tokens, &src, (TextEdit){ 16, 1, 1 }, "5", &same);  // "1e+5"
+    TEST(assertTrue(same));
+    applyEdit(&tokens, &src, (TextEdit){ 16, 1, 1 }, "y", &same);  // "1e+y"
+    TEST(assertTrue(same));
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testOversizedSource() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("x");
+    size_t length = src.content.len;
+    src.content.len = TOKEN_ARRAY_MAX_CONTENT + 1;  // never read, the size alone is checked
+    TokenArray tokens = lexSource(&src);
+    ABORT(assertEqualSize(tokenCount(&tokens), 2));
+    TEST(assertEqualInt(tokens.kinds[0], TOKEN_ERROR));
+    TEST(assertEqualInt(tokens.subkinds[0], LEX_ERROR_SOURCE_SIZE));
+    TEST(assertEqualInt(tokens.offsets[0], 0));
+    TEST(assertEqualInt(tokens.kinds[1], TOKEN_EOF));
+    ABORT(assertEqualSize(sbufLength(tokens.errors), 1));
+    TEST(assertEqualInt(tokens.errors[0].kind, LEX_ERROR_SOURCE_SIZE));
+    TEST(assertEqualSize(tokens.errors[0].offset, 0));
+    src.content.len = length;
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  {
+    Source src = sourceFromString("a + b");
+    TokenArray tokens = lexSource(&src);
+    size_t length = src.content.len;
+    src.content.len = TOKEN_ARRAY_MAX_CONTENT + 1;  // as if the edit inserted 2 GiB
+    TokenRange range = relexSource(&tokens, &src, (TextEdit){ 5, 0, TOKEN_ARRAY_MAX_CONTENT - 4 });
+    TEST(assertEqualSize(range.first, 0));
+    TEST(assertEqualSize(range.removed, 4));
+    TEST(assertEqualSize(range.inserted, 2));
+    ABORT(assertEqualSize(tokenCount(&tokens), 2));
+    TEST(assertEqualInt(tokens.subkinds[0], LEX_ERROR_SOURCE_SIZE));
+    TEST(assertEqualSize(sbufLength(tokens.errors), 1));
+    src.content.len = length;
+    deleteTokenArray(&tokens);
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+TestResult tokenarray_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<tokenarray>", "Test token arrays.");
+  addTest(&suite, testLexSource);
+  addTest(&suite, testSameAsLexer);
+  addTest(&suite, testIterator);
+  addTest(&suite, testRelexSource);
+  addTest(&suite, testOversizedSource);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
@@ -0,0 +1,161 @@
+#include "cunit.h"
+#include "util.h"
+
+#include "tokenqueue.h"
+#include "lexer.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Pushes the tokens of the queue's source until the `TOKEN_EOF` or the queue is closed. Returns
+ * the number of pushed tokens.
+ */
+static void* produceTokens(void* arg) {
+  TokenQueue* queue = (TokenQueue*) arg;
+  Lexer lexer = lexerFromSource(queue->source);
+  size_t count = 0;
+  while (true) {
+    Token token = nextToken(&lexer);
+    if (!queuePush(queue, token)) {
+      break;
+    }
+    count++;
+    if (token.kind == TOKEN_EOF) {
+      break;
+    }
+  }
+  deleteLexer(&lexer);
+  return (void*) count;
+}
+
+
+static char* repeat(const char* line, size_t times) {
+  size_t length = strlen(line);
+  char* chars = (char*) malloc(length * times + 1);
+  for (size_t i = 0; i < times; i++) {
+    memcpy(&chars[i * length], line, length);
+  }
+  chars[length * times] = '\0';
+  return chars;
+}
+
+
+static TestResult testPushPop() {
+  TestResult result = {};
+
+  {
+    Source src = sourceFromString("if x + 42 $");
+    TokenQueue queue = createTokenQueue(&src);
+    Lexer lexer = lexerFromSource(&src);
+    for (int i = 0; i < 6; i++) {
+      TEST(assertTrue(queuePush(&queue, nextToken(&lexer))));
+    }
+
+    Token token = queuePop(&queue);
+    TEST(assertEqualInt(token.kind, TOKEN_KEYWORD));
+    TEST(assertEqualInt(token.keyword, KEYWORD_IF));
+    TEST(assertSame(token.source, &src));
+    token = queuePop(&queue);
+    TEST(assertEqualInt(token.kind, TOKEN_NAME));
+    TEST(assertEqualStr(token.chars, "x"));
+    token = queuePop(&queue);
+    TEST(assertEqualInt(token.kind, TOKEN_SYMBOL));
+    TEST(assertEqualInt(token.symbol, SYMBOL_PLUS));
+    token = queuePop(&queue);
+    TEST(assertEqualInt(token.kind, TOKEN_INT));
+    TEST(assertTrue(token.value == 42));
+    TEST(assertEqualInt(tokenStart(token).pos, 8));
+    token = queuePop(&queue);
+    TEST(assertEqualInt(token.kind, TOKEN_ERROR));
+    TEST(assertEqualInt(token.error, LEX_ERROR_ILLEGAL_CHAR));
+    TEST(assertEqualStr(token.chars, "$"));
+    TEST(assertEqualInt(queuePop(&queue).kind, TOKEN_EOF));
+    TEST(assertEqualInt(queuePop(&queue).kind, TOKEN_EOF));  // EOF is repeated
+
+    deleteLexer(&lexer);
+    deleteTokenQueue(&queue);
+    TEST(assertNull(queue.slots));
+    deleteSource(&src);
+  }
+
+  return result;
+}
+
+
+static TestResult testConcurrent() {
+  TestResult result = {};
+
+  {
+    char* input = repeat("var x := 0x1F + y * 12;  // comment\n$ if (a) { b = 1x; }\n", 5000);
+    Source src = sourceFromString(input);
+    TokenQueue queue = createTokenQueue(&src);
+    pthread_t producer;
+    ABORT(assertEqualInt(pthread_create(&producer, NULL, produceTokens, &queue), 0));
+
+    Lexer lexer = lexerFromSource(&src);
+    size_t count = 0;
+    size_t mismatches = 0;
+    Token token;
+    do {
+      Token exp = nextToken(&lexer);
+      token = queuePop(&queue);
+      mismatches += (token.kind != exp.kind || token.keyword != exp.keyword ||
+                     token.value != exp.value || token.chars.chars != exp.chars.chars ||
+                     token.chars.len != exp.chars.len);
+      count++;
+    } while (token.kind != TOKEN_EOF);
+
+    void* pushed = NULL;
+    pthread_join(producer, &pushed);
+    TEST(assertEqualSize(mismatches, 0));
+    TEST(assertEqualSize((size_t) pushed, count));
+    TEST(assertTrue(count > 2 * TOKEN_QUEUE_SIZE));
+    deleteLexer(&lexer);
+    deleteTokenQueue(&queue);
+    deleteSource(&src);
+    free(input);
+  }
+
+  return result;
+}
+
+
+static TestResult testClose() {
+  TestResult result = {};
+
+  {
+    char* input = repeat("a b c d ", 5000);
+    Source src = sourceFromString(input);
+    TokenQueue queue = createTokenQueue(&src);
+    pthread_t producer;
+    ABORT(assertEqualInt(pthread_create(&producer, NULL, produceTokens, &queue), 0));
+
+    for (int i = 0; i < 100; i++) {
+      queuePop(&queue);
+    }
+    closeTokenQueue(&queue);  // the producer is blocked by the full ring
+    void* pushed = NULL;
+    pthread_join(producer, &pushed);
+    TEST(assertTrue((size_t) pushed >= TOKEN_QUEUE_SIZE));
+    TEST(assertTrue((size_t) pushed < 20000));
+    deleteTokenQueue(&queue);
+    deleteSource(&src);
+    free(input);
+  }
+
+  return result;
+}
+
+
+TestResult tokenqueue_alltests(PrintLevel verbosity) {
+  TestSuite suite = newSuite("TestSuite<tokenqueue>", "Test token queue.");
+  addTest(&suite, testPushPop);
+  addTest(&suite, testConcurrent);
+  addTest(&suite, testClose);
+  TestResult result = run(&suite, verbosity);
+  deleteSuite(&suite);
+  return result;
+}
@@ -182,13 +182,19 @@ static bool __assertEqualStr(const char* file, int line, string s, const char* c
 static bool __assertEqualNumber(const char* file, int line, Number num, Number exp) {
   printVerbose(__PROMPT, file, line);
 
-  if (num.value == exp.value) {
+  if (compare(num, exp) == 0) {
     printVerbose(GRN "OK\n" RST);
     return true;
+  } else if (num.size == 0 && exp.size == 0) {
+    unsigned long long x = num.negative ? -num.value : num.value;  // the magnitude
+    unsigned long long y = exp.negative ? -exp.value : exp.value;
+    printVerbose(RED "ERROR: " RST);
+    printVerbose("expected Number [%s%llu] == [%s%llu]\n",
+                 num.negative ? "-" : "", x, exp.negative ? "-" : "", y);
+    return false;
   } else {
     printVerbose(RED "ERROR: " RST);
-    printVerbose("expected Number [%d] == [%d] (%s)\n",
-                 num.value, exp.value, "not implemented");
+    printVerbose("expected Number with %u limbs == Number with %u limbs\n", num.size, exp.size);
     return false;
   }
 }